@@ -0,0 +1,280 @@
+#include "LevelGenerator.hpp"
+#include "../Sim/RaceFarm.hpp"
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <thread>
+
+namespace {
+
+const float WorldSize = 24.0f;
+const float Pi = 3.14159265f;
+
+// Tiradas propias en vez de std::uniform_*_distribution: esas cambian entre
+// implementaciones de la std y el mismo seed tiene que dar el mismo mapa en todos lados
+struct GenRng {
+    std::mt19937 engine;
+    explicit GenRng(uint32_t seed) : engine(seed) {}
+
+    float unit() { return (float)(engine() >> 8) * (1.0f / 16777216.0f); }
+    float range(float a, float b) { return a + (b - a) * unit(); }
+    int rangeInt(int a, int b) { return a + (int)(engine() % (uint32_t)(b - a + 1)); }
+    bool chance(float p) { return unit() < p; }
+};
+
+struct Rect {
+    float minX, minY, maxX, maxY;
+
+    bool overlaps(const Rect& o) const {
+        return minX < o.maxX && o.minX < maxX && minY < o.maxY && o.minY < maxY;
+    }
+    Rect grown(float margin) const { return {minX - margin, minY - margin, maxX + margin, maxY + margin}; }
+    Rect merged(const Rect& o) const {
+        return {std::min(minX, o.minX), std::min(minY, o.minY), std::max(maxX, o.maxX), std::max(maxY, o.maxY)};
+    }
+};
+
+// AABB de una caja rotada centrada en (x, y)
+Rect boundsOf(float x, float y, float w, float h, float rotation) {
+    float c = std::abs(std::cos(rotation));
+    float s = std::abs(std::sin(rotation));
+    float hx = 0.5f * (w * c + h * s);
+    float hy = 0.5f * (w * s + h * c);
+    return {x - hx, y - hy, x + hx, y + hy};
+}
+
+// Todo el espacio que la pared puede llegar a ocupar (tamaño final, recorrido entero)
+Rect footprintOf(const MapWall& w) {
+    float width = w.width, height = w.height;
+    if (w.isExpandable && w.maxSize > 0.0f) {
+        if (w.expansionAxis == 0 || w.expansionAxis == 2) width = std::max(width, w.maxSize);
+        if (w.expansionAxis == 1 || w.expansionAxis == 2) height = std::max(height, w.maxSize);
+    }
+    Rect r = boundsOf(w.x, w.y, width, height, w.rotation);
+    if (w.isMoving) {
+        r = r.merged(boundsOf(w.pointA[0], w.pointA[1], width, height, w.rotation));
+        r = r.merged(boundsOf(w.pointB[0], w.pointB[1], width, height, w.rotation));
+    }
+    return r;
+}
+
+bool insideWorld(const Rect& r) {
+    const float border = 0.6f;
+    return r.minX > border && r.minY > border && r.maxX < WorldSize - border && r.maxY < WorldSize - border;
+}
+
+MapWall makeBorder(float x, float y, float w, float h, int soundID) {
+    MapWall wall;
+    wall.x = x; wall.y = y;
+    wall.width = w; wall.height = h;
+    wall.soundID = soundID; // 1-4: mismos colores/sonidos que los bordes del editor
+    return wall;
+}
+
+// Una pared candidata con su tipo especial ya tirado
+MapWall rollWall(GenRng& rng, const GenConstraints& c) {
+    MapWall w;
+    w.x = rng.range(1.5f, WorldSize - 1.5f);
+    w.y = rng.range(1.5f, WorldSize - 1.5f);
+    w.colorIndex = rng.rangeInt(0, 8);
+    w.soundID = w.colorIndex + 1;
+
+    // Base: una tabla larga y finita, horizontal, vertical o torcida
+    float length = rng.range(c.minWallLength, c.maxWallLength);
+    float thickness = rng.range(0.5f, 1.0f);
+    bool vertical = rng.chance(0.5f);
+    w.width = vertical ? thickness : length;
+    w.height = vertical ? length : thickness;
+    if (rng.chance(c.rotatedChance)) w.rotation = rng.range(-0.8f, 0.8f);
+
+    float roll = rng.unit();
+    if ((roll -= c.spikeChance) < 0.0f) {
+        // Pincho: el color lo pone la carga (siempre rojo). Apunta para uno de los 4 lados.
+        w.shapeType = 1;
+        w.isDeadly = true;
+        w.soundID = 0;
+        w.colorIndex = -1;
+        w.width = rng.range(1.0f, 2.0f);
+        w.height = rng.range(1.0f, 1.8f);
+        w.rotation = rng.rangeInt(0, 3) * (Pi / 2.0f) + rng.range(-0.2f, 0.2f);
+    }
+    else if ((roll -= c.expandingChance) < 0.0f) {
+        // Expansiva: nace chica y crece sin rotar (el chequeo de contacto es por ejes)
+        w.isExpandable = true;
+        w.rotation = 0.0f;
+        w.width = rng.range(0.5f, 1.5f);
+        w.height = rng.range(0.5f, 1.5f);
+        w.expansionAxis = rng.rangeInt(0, 2);
+        w.expansionDelay = rng.range(1.0f, 6.0f);
+        w.expansionSpeed = rng.range(0.2f, 0.8f);
+        w.maxSize = rng.range(4.0f, 10.0f);
+        w.stopOnContact = rng.chance(0.5f);
+    }
+    else if ((roll -= c.movingChance) < 0.0f) {
+        // Plataforma: va y viene entre A (donde nace) y B
+        w.isMoving = true;
+        w.rotation = 0.0f;
+        w.pointA[0] = w.x;
+        w.pointA[1] = w.y;
+        w.pointB[0] = std::clamp(w.x + rng.range(-6.0f, 6.0f), 1.5f, WorldSize - 1.5f);
+        w.pointB[1] = std::clamp(w.y + rng.range(-6.0f, 6.0f), 1.5f, WorldSize - 1.5f);
+        w.moveSpeed = rng.range(1.5f, 4.0f);
+        w.reverseOnContact = rng.chance(0.5f);
+        w.freeBounce = rng.chance(0.2f);
+    }
+    else if ((roll -= c.destructibleChance) < 0.0f) {
+        w.isDestructible = true;
+        w.maxHits = rng.rangeInt(2, 6);
+        w.currentHits = w.maxHits;
+        w.useTextForHP = rng.chance(0.5f);
+    }
+    return w;
+}
+
+} // namespace
+
+MapData generateLevel(uint32_t seed, const GenConstraints& c) {
+    GenRng rng(seed);
+    MapData map;
+
+    map.hasConfig = true;
+    map.targetSpeed = c.targetSpeed;
+    map.racerSize = 1.0f;
+    map.restitution = 1.0f;
+    map.enableChaos = c.enableChaos;
+    map.stopOnFirstWin = true;
+
+    // Los bordes van en el mapa: cargar uno borra todas las paredes, incluidas las del constructor
+    const float S = WorldSize;
+    map.walls.push_back(makeBorder(S / 2.0f, S, S + 0.5f, 0.5f, 1));    // Piso
+    map.walls.push_back(makeBorder(S / 2.0f, 0.0f, S + 0.5f, 0.5f, 2)); // Techo
+    map.walls.push_back(makeBorder(0.0f, S / 2.0f, 0.5f, S + 0.5f, 3)); // Izq
+    map.walls.push_back(makeBorder(S, S / 2.0f, 0.5f, S + 0.5f, 4));    // Der
+
+    // Los racers arrancan en fila a media altura (resetRacers): esa franja queda libre
+    std::vector<Rect> reserved;
+    reserved.push_back({0.5f, S / 2.0f - 2.0f, S - 0.5f, S / 2.0f + 2.0f});
+
+    // Meta arriba o abajo, lejos de la largada
+    map.hasWinZone = true;
+    map.winZoneGlow = true;
+    map.winZoneSize[0] = rng.range(c.minWinZoneSize, c.maxWinZoneSize);
+    map.winZoneSize[1] = map.winZoneSize[0] * rng.range(0.4f, 0.8f);
+    float zoneY = rng.range(2.0f, S / 2.0f - 5.0f);
+    map.winZonePos[0] = rng.range(2.5f, S - 2.5f);
+    map.winZonePos[1] = rng.chance(0.5f) ? zoneY : S - zoneY;
+    reserved.push_back(boundsOf(map.winZonePos[0], map.winZonePos[1],
+                                map.winZoneSize[0], map.winZoneSize[1], 0.0f).grown(1.0f));
+
+    const int wallCount = rng.rangeInt(c.minWalls, std::max(c.minWalls, c.maxWalls));
+    std::vector<Rect> placed;
+    for (int i = 0; i < wallCount; ++i) {
+        // Si no entra después de unos intentos, el mapa sale con una pared menos
+        for (int attempt = 0; attempt < 30; ++attempt) {
+            MapWall w = rollWall(rng, c);
+            Rect footprint = footprintOf(w);
+            if (!insideWorld(footprint)) continue;
+
+            bool blocked = false;
+            for (const Rect& r : reserved) blocked = blocked || footprint.overlaps(r);
+            // Nada encimado: el footprint ya incluye lo que crece y el recorrido de las móviles
+            for (const Rect& r : placed) blocked = blocked || footprint.grown(0.3f).overlaps(r);
+            if (blocked) continue;
+
+            placed.push_back(footprint);
+            map.walls.push_back(w);
+            break;
+        }
+    }
+
+    const int knifeCount = rng.rangeInt(0, std::max(0, c.maxKnives));
+    for (int i = 0; i < knifeCount; ++i) {
+        for (int attempt = 0; attempt < 30; ++attempt) {
+            MapKnife k{rng.range(2.0f, S - 2.0f), rng.range(2.0f, S - 2.0f)};
+            Rect hitbox = boundsOf(k.x, k.y, 1.0f, 1.0f, 0.0f).grown(0.5f);
+
+            bool blocked = false;
+            for (const Rect& r : reserved) blocked = blocked || hitbox.overlaps(r);
+            for (const Rect& r : placed) blocked = blocked || hitbox.overlaps(r);
+            if (blocked) continue;
+
+            map.knives.push_back(k);
+            break;
+        }
+    }
+    return map;
+}
+
+LevelStats evaluateLevel(const MapData& map, const GenConstraints& c) {
+    LevelStats stats;
+
+    HeadlessConfig config = c.race;
+    config.maxSeconds = c.timeBudget + 1.0f; // El gameOver llega finishDelay después de tocar la meta
+
+    // Sin caos la semilla de física casi no cambia nada: una carrera alcanza
+    const int races = c.enableChaos ? std::max(1, c.validationSeeds) : 1;
+    float timeSum = 0.0f;
+
+    for (int i = 0; i < races; ++i) {
+        PhysicsWorld physics(WorldRenderSize, WorldRenderSize, nullptr);
+        physics.setSeed(77 + (uint32_t)i); // La primera es la del editor
+        RaceResult result = runHeadlessRace(physics, map, "generated", config);
+
+        float firstArrival = -1.0f;
+        for (const auto& r : result.racers) {
+            if (r.finished && (firstArrival < 0.0f || r.finishTime < firstArrival)) firstArrival = r.finishTime;
+        }
+
+        stats.races++;
+        stats.deaths += (int)result.deaths.size();
+        if (firstArrival >= 0.0f && firstArrival <= c.timeBudget) {
+            stats.wins++;
+            timeSum += firstArrival;
+            if (stats.bestTime < 0.0f || firstArrival < stats.bestTime) stats.bestTime = firstArrival;
+        }
+    }
+
+    if (stats.wins > 0) stats.meanTime = timeSum / stats.wins;
+    return stats;
+}
+
+bool acceptsLevel(const LevelStats& stats, const GenConstraints& c) {
+    int needed = std::min(std::max(1, c.minWinningSeeds), stats.races);
+    return stats.races > 0 && stats.wins >= needed && stats.bestTime >= c.minFinishTime;
+}
+
+std::vector<GeneratedLevel> generateLevels(size_t count, uint32_t baseSeed, const GenConstraints& c,
+                                           unsigned threads, size_t maxAttempts) {
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    if (maxAttempts == 0) maxAttempts = std::max<size_t>(count * 50, 64);
+
+    std::vector<GeneratedLevel> accepted;
+    accepted.reserve(count);
+
+    // Por tandas: cada tanda se valida entera en paralelo y se acepta en orden de semilla,
+    // así el resultado no depende de cuántos hilos hubo ni de cuál terminó primero
+    const size_t batchSize = (size_t)threads * 4;
+    std::vector<GeneratedLevel> batch;
+    std::vector<char> passed;
+
+    size_t attempt = 0;
+    while (accepted.size() < count && attempt < maxAttempts) {
+        size_t n = std::min(batchSize, maxAttempts - attempt);
+        batch.assign(n, GeneratedLevel());
+        passed.assign(n, 0);
+
+        parallelFor(n, threads, [&](size_t i) {
+            GeneratedLevel& level = batch[i];
+            level.seed = baseSeed + (uint32_t)(attempt + i);
+            level.map = generateLevel(level.seed, c);
+            level.stats = evaluateLevel(level.map, c);
+            passed[i] = acceptsLevel(level.stats, c);
+        });
+
+        for (size_t i = 0; i < n && accepted.size() < count; ++i) {
+            if (passed[i]) accepted.push_back(std::move(batch[i]));
+        }
+        attempt += n;
+    }
+    return accepted;
+}
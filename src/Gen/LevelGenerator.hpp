@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "../Physics/MapFile.hpp"
+#include "../Sim/HeadlessRace.hpp"
+
+// --- GENERADOR DE NIVELES ---
+// Semilla + restricciones -> MapData (paredes, pinchos, expansivas, móviles,
+// destructibles, cuchillos y meta). Después cada candidato se corre en headless con
+// varias semillas de física y se tira si nadie llega a la meta dentro del presupuesto.
+// La generación en sí es pura (mismo seed = mismo mapa); la validación usa los núcleos.
+
+struct GenConstraints {
+    // El mundo es el del editor: 24 m de lado (PhysicsWorld fija el ancho, WorldRenderSize lo hace cuadrado)
+    int minWalls = 6;  // Sin contar los 4 bordes
+    int maxWalls = 14;
+    float minWallLength = 2.0f;
+    float maxWallLength = 9.0f;
+    float rotatedChance = 0.35f; // El resto va a 0° o 90°
+
+    // Probabilidad por pared (se tiran en este orden; una pared es de un solo tipo especial)
+    float spikeChance = 0.12f;
+    float expandingChance = 0.10f;
+    float movingChance = 0.10f;
+    float destructibleChance = 0.15f;
+
+    int maxKnives = 2;
+    float minWinZoneSize = 2.5f;
+    float maxWinZoneSize = 4.5f;
+
+    float targetSpeed = 8.0f;
+    bool enableChaos = false;
+
+    // --- VALIDACIÓN ---
+    int validationSeeds = 4;      // Carreras por candidato (semillas de física distintas)
+    int minWinningSeeds = 1;      // Cuántas tienen que terminar con alguien en la meta
+    float timeBudget = 60.0f;     // Segundos simulados para llegar
+    float minFinishTime = 4.0f;   // Más rápido que esto = mapa trivial
+    HeadlessConfig race;          // timeStep / iteraciones (maxSeconds lo pisa timeBudget)
+};
+
+struct LevelStats {
+    int races = 0;
+    int wins = 0;             // Carreras donde alguien tocó la meta a tiempo
+    float bestTime = -1.0f;   // Llegada más rápida entre todas las carreras
+    float meanTime = -1.0f;   // Promedio de la primera llegada (solo carreras ganadas)
+    int deaths = 0;
+};
+
+struct GeneratedLevel {
+    uint32_t seed = 0;
+    MapData map;
+    LevelStats stats;
+};
+
+// Un candidato, sin validar. Determinista: no depende del hilo ni de nada global.
+MapData generateLevel(uint32_t seed, const GenConstraints& constraints);
+
+// Corre las carreras de validación (en el hilo que llama)
+LevelStats evaluateLevel(const MapData& map, const GenConstraints& constraints);
+bool acceptsLevel(const LevelStats& stats, const GenConstraints& constraints);
+
+// Prueba semillas baseSeed, baseSeed+1, ... en paralelo hasta juntar 'count' niveles
+// aceptados (o gastar maxAttempts). Devuelve en orden de semilla: misma entrada, misma salida.
+std::vector<GeneratedLevel> generateLevels(size_t count, uint32_t baseSeed, const GenConstraints& constraints,
+                                           unsigned threads = 0, size_t maxAttempts = 0);
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+
+inline sf::Color lerpColor(const sf::Color& a, const sf::Color& b, float t) {
+    if (t < 0.0f) t = 0.0f;
+    if (t > 1.0f) t = 1.0f;
+    return sf::Color(
+        (sf::Uint8)(a.r + (b.r - a.r) * t),
+        (sf::Uint8)(a.g + (b.g - a.g) * t),
+        (sf::Uint8)(a.b + (b.b - a.b) * t),
+        (sf::Uint8)(a.a + (b.a - a.a) * t)
+    );
+}
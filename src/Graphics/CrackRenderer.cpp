@@ -0,0 +1,113 @@
+#include "CrackRenderer.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+
+namespace {
+
+void appendCrackSegment(sf::VertexArray& va, float x1, float y1, float x2, float y2, float thickness) {
+    float dx = x2 - x1;
+    float dy = y2 - y1;
+    float length = std::sqrt(dx*dx + dy*dy);
+    if (length < 0.5f) return; // Filtro para evitar "basuritas"
+
+    // Rectángulo largo x grosor centrado sobre el tramo
+    float nx = -dy / length * (thickness / 2.0f);
+    float ny = dx / length * (thickness / 2.0f);
+
+    sf::Color crackColor(10, 10, 10, 220);
+    va.append(sf::Vertex(sf::Vector2f(x1 + nx, y1 + ny), crackColor));
+    va.append(sf::Vertex(sf::Vector2f(x2 + nx, y2 + ny), crackColor));
+    va.append(sf::Vertex(sf::Vector2f(x2 - nx, y2 - ny), crackColor));
+    va.append(sf::Vertex(sf::Vector2f(x1 - nx, y1 - ny), crackColor));
+}
+
+}
+
+void buildCrackLines(std::vector<sf::Vector2f>& out, int damage, uint32_t seed) {
+    out.clear();
+
+    // Si la pared tiene 200 de vida, limitamos las grietas para no tapar todo el color
+    int numCracks = std::min(damage, 200);
+    if (numCracks <= 0) return;
+
+    std::mt19937 rng(seed);
+    auto randInt = [&](int n) { return std::uniform_int_distribution<int>(0, std::max(1, n) - 1)(rng); };
+    std::uniform_real_distribution<float> randUnit(-0.5f, 0.5f);
+
+    for (int k = 0; k < numCracks; k++) {
+        // Nacen distribuidas aleatoriamente por TODA la pared
+        float currentX = randUnit(rng);
+        float currentY = randUnit(rng);
+
+        // Dirección general hacia donde viaja la grieta
+        float baseAngle = randInt(360) * 3.14159f / 180.0f;
+
+        // La grieta avanza en 2 a 4 tramos unidos
+        int segments = 2 + randInt(3);
+        for (int s = 0; s < segments; s++) {
+            // Zigzag suave (aprox +/- 45 grados de desviación)
+            float angle = baseAngle + (randInt(100) - 50) * 0.015f;
+
+            // Largo relativo a cada lado: así pueden correr a lo largo de las paredes anchas
+            float segLen = 0.05f + randInt(100) * 0.002f;
+
+            // Clavamos a los bordes exactos para que no asomen fuera de la luz
+            float nextX = std::clamp(currentX + std::cos(angle) * segLen, -0.5f, 0.5f);
+            float nextY = std::clamp(currentY + std::sin(angle) * segLen, -0.5f, 0.5f);
+
+            out.emplace_back(currentX, currentY);
+            out.emplace_back(nextX, nextY);
+
+            currentX = nextX;
+            currentY = nextY;
+        }
+    }
+}
+
+void buildCrackQuads(sf::VertexArray& out, const std::vector<sf::Vector2f>& lines,
+                     float wPx, float hPx, float thickness) {
+    out.clear();
+    for (size_t i = 0; i + 1 < lines.size(); i += 2) {
+        appendCrackSegment(out, lines[i].x * wPx, lines[i].y * hPx,
+                           lines[i + 1].x * wPx, lines[i + 1].y * hPx, thickness);
+    }
+}
+
+void CrackRenderer::draw(sf::RenderTarget& target, WallHandle handle, const CustomWall& wall, float scale) {
+    if (!wall.isDestructible || wall.currentHits >= wall.maxHits) return;
+
+    if (entries.size() <= handle.index) entries.resize(handle.index + 1);
+    Entry& entry = entries[handle.index];
+
+    // Sorteo nuevo solo si cambió la pared del slot, el daño o la forma
+    int damage = wall.maxHits - wall.currentHits;
+    if (entry.generation != handle.generation || entry.damage != damage || entry.shapeType != wall.shapeType) {
+        // Misma semilla por pared en cada regeneración (y en toda corrida: sale del handle)
+        uint32_t seed = handle.index * 2654435761u ^ handle.generation * 40503u;
+        buildCrackLines(entry.lines, damage, seed);
+        entry.generation = handle.generation;
+        entry.damage = damage;
+        entry.shapeType = wall.shapeType;
+        entry.quadSize = sf::Vector2f(-1.0f, -1.0f); // Hay que re-expandir
+    }
+
+    // Al tamaño real: solo aritmética, y solo si cambió el tamaño
+    sf::Vector2f size(wall.width * scale, wall.height * scale);
+    // Grosor fino y constante (unos 2-3 px reales en pantalla)
+    float thickness = std::max(4.0f, 0.036f * scale);
+    if (entry.quadSize.x != size.x || entry.quadSize.y != size.y || entry.quadThickness != thickness) {
+        buildCrackQuads(entry.quads, entry.lines, size.x, size.y, thickness);
+        entry.quadSize = size;
+        entry.quadThickness = thickness;
+    }
+
+    if (entry.quads.getVertexCount() == 0) return;
+
+    b2Vec2 pos = wall.body->GetPosition();
+    sf::RenderStates states;
+    states.transform.translate(pos.x * scale, pos.y * scale);
+    states.transform.rotate(wall.body->GetAngle() * 180.0f / 3.14159f);
+    target.draw(entry.quads, states);
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <cstdint>
+#include <vector>
+#include "../Physics/PhysicsWorld.hpp"
+
+// --- GRIETAS DE PAREDES DESTRUCTIBLES ---
+// El cache vive acá, no en la pared: la física no sabe nada de vértices y las fotos
+// (snapshots) no copian geometría. Va por handle (un lugar por slot, la generación
+// dice si sigue siendo la misma pared).
+// Las grietas se sortean una sola vez por nivel de daño en el rectángulo unitario
+// y se llevan al tamaño real al dibujar: una pared que se expande no vuelve a sortear,
+// solo re-escala los tramos (el grosor queda en píxeles, no se deforma).
+// Usa su propio RNG sembrado por handle: no toca el rand() global.
+
+class CrackRenderer {
+public:
+    // No hace nada si la pared no es destructible o está sana
+    void draw(sf::RenderTarget& target, WallHandle handle, const CustomWall& wall, float scale);
+    void clear() { entries.clear(); }
+
+private:
+    struct Entry {
+        uint32_t generation = 0;
+        int damage = -1;
+        int shapeType = -1;
+        std::vector<sf::Vector2f> lines; // Unitario (-0.5..0.5), de a pares: un tramo por par
+        sf::Vector2f quadSize{-1.0f, -1.0f};
+        float quadThickness = -1.0f;
+        sf::VertexArray quads{sf::Quads}; // Los tramos ya en píxeles (local a la pared)
+    };
+
+    std::vector<Entry> entries; // Por índice de slot
+};
+
+// Solo la geometría, sueltas para medirlas sin GL.
+// Tramos de 'damage' grietas en el rectángulo unitario (misma semilla = mismas grietas;
+// con más daño se suman nuevas y las viejas quedan donde estaban).
+void buildCrackLines(std::vector<sf::Vector2f>& out, int damage, uint32_t seed);
+// Tramos unitarios -> quads en píxeles locales (wPx x hPx, centrados en la pared)
+void buildCrackQuads(sf::VertexArray& out, const std::vector<sf::Vector2f>& lines,
+                     float wPx, float hPx, float thickness);
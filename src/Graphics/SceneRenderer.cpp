@@ -0,0 +1,771 @@
+#include "SceneRenderer.hpp"
+#include "CrackRenderer.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+
+namespace {
+
+// --- BLOOM DUAL FILTER ---
+// Cadena de mips: se baja a la mitad nivel por nivel y después se vuelve a subir
+// sumando cada nivel con el de arriba. Cada nivel duplica el radio del glow por
+// un cuarto del costo del anterior: 5 niveles abren más que 8 pasadas del blur
+// separable de antes y entre todos no llegan a lo que costaba UNA pasada a media resolución.
+
+// Primer nivel: caja 2x2 exacta (los 4 taps caen en centros de texel, no depende del
+// suavizado del gameBuffer) y umbral por tap.
+const char* bloomPrefilterFrag = R"(
+    uniform sampler2D source;
+    uniform vec2 halfTexel; // Medio texel de la fuente
+    uniform float threshold;
+
+    vec4 bright(vec2 uv) {
+        vec4 color = texture2D(source, uv);
+
+        // NORMALIZACIÓN DE NEÓN:
+        // Usamos el canal más alto del pixel en lugar de la luminancia del ojo humano.
+        // Así un Azul puro (0,0,1) y un Verde puro (0,1,0) tienen un brillo = 1.0.
+        float maxBrightness = max(color.r, max(color.g, color.b));
+        return (maxBrightness > threshold) ? color : vec4(0.0, 0.0, 0.0, 1.0);
+    }
+
+    void main() {
+        vec2 uv = gl_TexCoord[0].xy;
+        vec4 sum = bright(uv + vec2(-halfTexel.x, -halfTexel.y));
+        sum += bright(uv + vec2(halfTexel.x, -halfTexel.y));
+        sum += bright(uv + vec2(-halfTexel.x, halfTexel.y));
+        sum += bright(uv + vec2(halfTexel.x, halfTexel.y));
+        gl_FragColor = sum * 0.25;
+    }
+)";
+
+// Bajada: centro + 4 diagonales, todos con filtrado bilineal (huella de 4x4 texels)
+const char* bloomDownFrag = R"(
+    uniform sampler2D source;
+    uniform vec2 texel; // Un texel de la fuente
+    void main() {
+        vec2 uv = gl_TexCoord[0].xy;
+        vec4 sum = texture2D(source, uv) * 4.0;
+        sum += texture2D(source, uv - texel);
+        sum += texture2D(source, uv + texel);
+        sum += texture2D(source, uv + vec2(texel.x, -texel.y));
+        sum += texture2D(source, uv - vec2(texel.x, -texel.y));
+        gl_FragColor = sum / 8.0;
+    }
+)";
+
+// Subida: tienda de 8 taps sobre el nivel chico; se suma (BlendAdd) al nivel de arriba
+const char* bloomUpFrag = R"(
+    uniform sampler2D source;
+    uniform vec2 halfTexel; // Medio texel de la fuente (el nivel más chico)
+    void main() {
+        vec2 uv = gl_TexCoord[0].xy;
+        vec2 h = halfTexel;
+        vec4 sum = texture2D(source, uv + vec2(-h.x * 2.0, 0.0));
+        sum += texture2D(source, uv + vec2(-h.x, h.y)) * 2.0;
+        sum += texture2D(source, uv + vec2(0.0, h.y * 2.0));
+        sum += texture2D(source, uv + vec2(h.x, h.y)) * 2.0;
+        sum += texture2D(source, uv + vec2(h.x * 2.0, 0.0));
+        sum += texture2D(source, uv + vec2(h.x, -h.y)) * 2.0;
+        sum += texture2D(source, uv + vec2(0.0, -h.y * 2.0));
+        sum += texture2D(source, uv + vec2(-h.x, -h.y)) * 2.0;
+        gl_FragColor = vec4((sum / 12.0).rgb, 1.0);
+    }
+)";
+
+const char* blendFrag = R"(
+    uniform sampler2D baseTexture;
+    uniform sampler2D bloomTexture;
+    uniform float multiplier;
+    void main() {
+        vec4 base = texture2D(baseTexture, gl_TexCoord[0].xy);
+        vec4 bloom = texture2D(bloomTexture, gl_TexCoord[0].xy);
+        // Fusión Aditiva: Luz + Luz
+        gl_FragColor = base + (bloom * multiplier);
+    }
+)";
+
+// --- POLVO EN EL VERTEX SHADER ---
+// Cada mota es un quad con los 4 vértices iguales salvo la esquina. Empaquetado:
+//   position  = X base, Y inicial
+//   texCoords = (amplitud, velocidad de subida); el signo de cada uno es la esquina
+//   color     = r: fase (0..255 = 0..2pi), g: frecuencia * 10, b: tamaño, a: alpha
+// Es la misma cuenta que se hacía en CPU mota por mota.
+const char* dustVert = R"(
+    uniform float time;      // globalTime: el vaivén
+    uniform float dustTime;  // Solo avanza con updateDust: la subida
+    uniform vec2 area;       // Ancho y alto lógicos
+
+    void main() {
+        vec4 bytes = floor(gl_Color * 255.0 + 0.5);
+        float phaseOffset = bytes.r / 256.0 * 6.2831853;
+        float phaseSpeed = bytes.g / 10.0;
+        float size = bytes.b;
+        vec2 corner = sign(gl_MultiTexCoord0.xy);
+        float amplitude = abs(gl_MultiTexCoord0.x);
+        float speed = abs(gl_MultiTexCoord0.y);
+
+        // Sube hasta 50 px arriba del borde y reaparece 50 px abajo, en otra X
+        float span = area.y + 100.0;
+        float travel = gl_Vertex.y + 50.0 - speed * dustTime;
+        float lap = floor(travel / span);
+        float y = travel - lap * span - 50.0;
+        float baseX = gl_Vertex.x;
+        if (lap < 0.0) baseX = floor(fract(sin(gl_Vertex.x * 12.9898 + lap * 78.233) * 43758.5453) * area.x);
+
+        // Cálculo del vaivén horizontal
+        float x = baseX + sin(time * phaseSpeed + phaseOffset) * amplitude;
+
+        gl_Position = gl_ModelViewProjectionMatrix * vec4(x + corner.x * size, y + corner.y * size, 0.0, 1.0);
+        gl_FrontColor = vec4(180.0 / 255.0, 230.0 / 255.0, 1.0, gl_Color.a);
+    }
+)";
+
+const char* dustFrag = R"(
+    void main() {
+        gl_FragColor = gl_Color;
+    }
+)";
+
+// La grilla responde a la resolución (la real de render, no la lógica: así las líneas
+// quedan nítidas también en la previsualización). Paso en float: 18 celdas justas a cualquier tamaño.
+sf::Texture createGridTexture(int width, int height) {
+    sf::RenderTexture rt;
+    rt.create(width, height);
+    rt.clear(sf::Color::Transparent); // <--- MAGIA ACÁ: Fondo transparente
+    sf::RectangleShape line;
+    line.setFillColor(sf::Color(10, 10, 10));
+
+    float lineThick = (width / 1080.0f) * 2.0f;
+    float stepSize = width / 18.0f;
+
+    line.setSize(sf::Vector2f(lineThick, (float)height));
+    for (int k = 0; k * stepSize < width; ++k) {
+        line.setPosition(k * stepSize, 0.0f); rt.draw(line);
+    }
+    line.setSize(sf::Vector2f((float)width, lineThick));
+    for (int k = 0; k * stepSize < height; ++k) {
+        line.setPosition(0.0f, k * stepSize); rt.draw(line);
+    }
+    rt.display();
+    return rt.getTexture();
+}
+
+}
+
+const sf::Color SceneRenderer::racerColors[4] = {
+    sf::Color(0, 255, 255),
+    sf::Color(255, 0, 255),
+    sf::Color(57, 255, 20),
+    sf::Color(255, 215, 0)
+};
+
+SceneRenderer::SceneRenderer(unsigned int width, unsigned int height)
+    : width(width), height(height), renderWidth(width), renderHeight(height) {
+    for (int i = 0; i < 4; ++i) trails.setColor(i, racerColors[i]);
+
+    setDustCount(DefaultDustCount);
+}
+
+void SceneRenderer::setDustCount(size_t count) {
+    // --- SETUP DE POLVO ATMOSFÉRICO REFINADO ---
+    dustVertices.resize(count * 4);
+
+    // RNG propio con semilla fija: el polvo sale igual en toda corrida (y para la misma
+    // cantidad, igual cada vez) sin tocar el rand() global ni depender de quién lo usó antes
+    dustRng.seed(DustSeed);
+    auto randInt = [this](int n) { return std::uniform_int_distribution<int>(0, n - 1)(dustRng); };
+    const sf::Vector2f corners[4] = { {-1.0f, -1.0f}, {1.0f, -1.0f}, {1.0f, 1.0f}, {-1.0f, 1.0f} };
+    for (size_t i = 0; i < count; ++i) {
+        sf::Vector2f basePos((float)randInt((int)width), (float)randInt((int)height));
+
+        // Más velocidad vertical: de 20 a 60 px/s (antes era 5-30)
+        float speedUp = (float)randInt(40) + 20.0f;
+
+        sf::Uint8 phaseOffset = (sf::Uint8)randInt(256);
+
+        // Vaivén más rápido: frecuencia de oscilación aumentada (1.5 a 3.9, en décimas)
+        sf::Uint8 phaseSpeed = (sf::Uint8)(randInt(25) + 15);
+
+        // Amplitud mucho mayor: recorren más espacio horizontal (30 a 110 px)
+        float amplitude = (float)randInt(80) + 30.0f;
+
+        sf::Uint8 size = (sf::Uint8)(randInt(3) + 2);
+
+        // Mantenemos un alpha bajísimo para que sea un detalle sutil
+        sf::Uint8 alpha = 15 + randInt(25);
+
+        for (int k = 0; k < 4; ++k) {
+            sf::Vertex& v = dustVertices[i * 4 + k];
+            v.position = basePos;
+            v.texCoords = sf::Vector2f(corners[k].x * amplitude, corners[k].y * speedUp);
+            v.color = sf::Color(phaseOffset, phaseSpeed, size, alpha);
+        }
+    }
+
+    if (useDustVbo) uploadDust(); // Antes de init() no hay contexto: sube init()
+}
+
+void SceneRenderer::uploadDust() {
+    if (dustVertices.empty()) return;
+    // Sin VBO seguimos dibujando directo desde la copia en CPU (con el mismo shader)
+    if (!dustVbo.create(dustVertices.size()) || !dustVbo.update(dustVertices.data())) useDustVbo = false;
+}
+
+bool SceneRenderer::init() {
+    if (!createBuffers()) return false;
+
+    // --- SETUP DE BLOOM ---
+    if (!sf::Shader::isAvailable()) {
+        std::cerr << "Pah, tu GPU no banca shaders. Olvidate del neón." << std::endl;
+        return false;
+    }
+
+    uiFont.loadFromFile("../fonts/jetbrains_mono.ttf");
+
+    // Si tenés una carpeta assets, meté el PNG ahí con el nombre "knife.png"
+    hasKnifeTex = knifeTex.loadFromFile("../assets/knife.png");
+    if (hasKnifeTex) {
+        knifeTex.setSmooth(true);
+        std::cout << ">>> Asset de cuchillo (499x499) cargado joya." << std::endl;
+    } else {
+        std::cout << ">>> No se encontro knife.png, usando hoja por defecto." << std::endl;
+    }
+
+    bloomPrefilterShader.loadFromMemory(bloomPrefilterFrag, sf::Shader::Fragment);
+    bloomDownShader.loadFromMemory(bloomDownFrag, sf::Shader::Fragment);
+    bloomUpShader.loadFromMemory(bloomUpFrag, sf::Shader::Fragment);
+    blendShader.loadFromMemory(blendFrag, sf::Shader::Fragment);
+
+    if (!dustShader.loadFromMemory(dustVert, dustFrag)) {
+        std::cerr << "Pah, no compilo el shader del polvo." << std::endl;
+        return false;
+    }
+    useParticleVbo = sf::VertexBuffer::isAvailable();
+    particleVbo.setPrimitiveType(sf::Quads);
+    particleVbo.setUsage(sf::VertexBuffer::Stream);
+
+    useDustVbo = sf::VertexBuffer::isAvailable();
+    dustVbo.setPrimitiveType(sf::Quads);
+    dustVbo.setUsage(sf::VertexBuffer::Static);
+    if (useDustVbo) uploadDust();
+
+    return trails.init();
+}
+
+bool SceneRenderer::createBuffers() {
+    if (!gameBuffer.create(renderWidth, renderHeight)) {
+        std::cerr << "Pah, te quedaste sin VRAM bo. Falló el RenderTexture." << std::endl;
+        return false;
+    }
+    // Todo se dibuja en píxeles lógicos (los de captura): la vista los lleva a la
+    // resolución real, así grosores, LEDs, partículas y textos escalan solos
+    gameBuffer.setView(sf::View(sf::FloatRect(0.0f, 0.0f, (float)width, (float)height)));
+
+    // Nivel 0 a media resolución y cada uno la mitad del anterior.
+    // Suavizados: los taps de bajada/subida viven del filtrado bilineal.
+    for (int i = 0; i < BloomMaxLevels; ++i) {
+        unsigned int w = std::max(1u, (renderWidth / 2) >> i);
+        unsigned int h = std::max(1u, (renderHeight / 2) >> i);
+        if (!bloomChain[i].create(w, h)) {
+            std::cerr << "Pah, no hubo VRAM para el nivel " << i << " del bloom." << std::endl;
+            return false;
+        }
+        bloomChain[i].setSmooth(true);
+    }
+    finalBuffer.create(renderWidth, renderHeight); // A escala 1 es el 4K final que grabamos
+
+    gridTexture = createGridTexture(renderWidth, renderHeight);
+    background.setTexture(gridTexture, true);
+    background.setScale((float)width / renderWidth, (float)height / renderHeight);
+
+    if (!staticLayer.create(renderWidth, renderHeight)) {
+        std::cerr << "Pah, no hubo VRAM para la capa estatica." << std::endl;
+        return false;
+    }
+    staticSprite.setTexture(staticLayer.getTexture(), true);
+    staticSprite.setScale((float)width / renderWidth, (float)height / renderHeight);
+    staticLayerValid = false; // Textura nueva = vacía: se arma entera en el próximo render
+    return true;
+}
+
+void SceneRenderer::refreshStaticLayer() {
+    if (!staticLayerValid) {
+        // Lo sucio que haya quedado ya entra en el redibujado completo
+        wallRenderer.takeStaticDirty(staticRegions);
+        redrawStaticRegion(sf::FloatRect(0.0f, 0.0f, (float)width, (float)height));
+        staticLayerValid = true;
+    } else if (wallRenderer.takeStaticDirty(staticRegions)) {
+        for (const auto& region : staticRegions) redrawStaticRegion(region);
+    } else {
+        return;
+    }
+    staticLayer.display();
+}
+
+void SceneRenderer::redrawStaticRegion(const sf::FloatRect& region) {
+    // Alineada a píxeles reales: la vista con viewport recorta justo ahí y nada
+    // de afuera se pinta dos veces
+    float toRealX = (float)renderWidth / width;
+    float toRealY = (float)renderHeight / height;
+    int left = std::max(0, (int)std::floor(region.left * toRealX));
+    int top = std::max(0, (int)std::floor(region.top * toRealY));
+    int right = std::min((int)renderWidth, (int)std::ceil((region.left + region.width) * toRealX));
+    int bottom = std::min((int)renderHeight, (int)std::ceil((region.top + region.height) * toRealY));
+    if (right <= left || bottom <= top) return;
+
+    sf::FloatRect clip(left / toRealX, top / toRealY, (right - left) / toRealX, (bottom - top) / toRealY);
+    sf::View view(clip);
+    view.setViewport(sf::FloatRect((float)left / renderWidth, (float)top / renderHeight,
+                                   (float)(right - left) / renderWidth, (float)(bottom - top) / renderHeight));
+    staticLayer.setView(view);
+
+    // Limpiar la región (BlendNone: el transparente pisa en vez de mezclarse)
+    sf::RectangleShape eraser(sf::Vector2f(clip.width, clip.height));
+    eraser.setPosition(clip.left, clip.top);
+    eraser.setFillColor(sf::Color::Transparent);
+    staticLayer.draw(eraser, sf::BlendNone);
+
+    staticLayer.draw(background);
+    wallRenderer.drawStatic(staticLayer, clip);
+}
+
+bool SceneRenderer::setRenderScale(float scale) {
+    scale = std::clamp(scale, 0.1f, 1.0f);
+    renderScale = scale;
+    unsigned int newWidth = std::max(1u, (unsigned int)std::lround(width * scale));
+    unsigned int newHeight = std::max(1u, (unsigned int)std::lround(height * scale));
+    if (newWidth == renderWidth && newHeight == renderHeight) return true;
+
+    renderWidth = newWidth;
+    renderHeight = newHeight;
+    return createBuffers();
+}
+
+void SceneRenderer::updateTrails(const PhysicsWorld& physics) {
+    const auto& bodies = physics.getDynamicBodies();
+    // Cada tramo se estira un poquito para tapar la junta con el vecino
+    float overlap = physics.currentRacerSize * physics.SCALE * 0.08f;
+    for (size_t i = 0; i < bodies.size(); ++i) {
+        if (i >= trails.size()) break;
+        b2Vec2 pos = bodies[i]->GetPosition();
+        sf::Vector2f p(pos.x * physics.SCALE, pos.y * physics.SCALE);
+        float speed = bodies[i]->GetLinearVelocity().Length();
+
+        // >>> ESTELAS MÁS CORTAS ACÁ <<<
+        size_t maxPoints = (size_t)(speed * 1.5f) + 5;
+        trails.push(i, p, maxPoints, overlap);
+    }
+}
+
+void SceneRenderer::clearTrails() {
+    trails.clear();
+}
+
+void SceneRenderer::updateDust(float dt) {
+    dustTime += dt; // La subida y el reaparecer abajo los hace el shader
+}
+
+const sf::Texture& SceneRenderer::render(PhysicsWorld& physics, float globalTime) {
+    // 1. Limpiar con el color de vacío
+    gameBuffer.clear(sf::Color(30, 30, 30));
+
+    // 2. Polvo atmosférico (lo anima el vertex shader: acá es un draw)
+    drawDust(globalTime);
+
+    // 3. Grilla + paredes quietas: la capa retenida, en un solo draw.
+    // Primero el update de paredes, que es el que dice qué región de la capa quedó vieja.
+    {
+        ProfileScope timer(profiler, ProfileStage::DrawWalls);
+        wallRenderer.update(physics.getCustomWalls(), physics.SCALE, globalTime);
+        refreshStaticLayer();
+        // La capa ya viene premultiplicada (se armó sobre transparente)
+        gameBuffer.draw(staticSprite, sf::BlendMode(sf::BlendMode::One, sf::BlendMode::OneMinusSrcAlpha));
+    }
+
+    // 4. Paredes animadas, grietas y vida
+    {
+        ProfileScope timer(profiler, ProfileStage::DrawWalls);
+        drawWalls(physics);
+    }
+    drawKnives(physics);
+    drawWinZone(physics, globalTime);
+    drawGraves(physics);
+    {
+        ProfileScope timer(profiler, ProfileStage::DrawTrails);
+        drawTrails(physics);
+    }
+    drawRacers(physics);
+
+    // --- DRAW PARTÍCULAS ---
+    // Los quads ya vienen armados del kernel de updateParticles: se sube solo el
+    // tramo vivo al VertexBuffer (una vez por frame) y es un solo draw
+    if (!physics.getParticles().empty()) {
+        ProfileScope timer(profiler, ProfileStage::DrawParticles);
+        drawParticles(physics.getParticles());
+    }
+
+    gameBuffer.display();
+
+    if (enableBloom) return applyBloom();
+    return gameBuffer.getTexture();
+}
+
+void SceneRenderer::drawParticles(const ParticlePool& pool) {
+    const auto& quads = pool.quads();
+
+    // Del tamaño del pool entero: crece solo si le suben el tope
+    size_t needed = pool.capacity() * 4;
+    if (useParticleVbo && particleVbo.getVertexCount() < needed && !particleVbo.create(needed)) {
+        useParticleVbo = false; // Sin VBO seguimos dibujando directo desde el pool
+    }
+
+    if (useParticleVbo && particleVbo.update(quads.data(), quads.size(), 0)) {
+        gameBuffer.draw(particleVbo, 0, quads.size());
+    } else {
+        gameBuffer.draw(quads.data(), quads.size(), sf::Quads);
+    }
+}
+
+void SceneRenderer::drawDust(float globalTime) {
+    if (dustVertices.empty()) return;
+
+    dustShader.setUniform("time", globalTime);
+    dustShader.setUniform("dustTime", dustTime);
+    dustShader.setUniform("area", sf::Glsl::Vec2((float)width, (float)height));
+
+    sf::RenderStates dustStates;
+    dustStates.blendMode = sf::BlendAdd; // Para que el bloom las "atrape" un poquito
+    dustStates.shader = &dustShader;
+    if (useDustVbo) gameBuffer.draw(dustVbo, dustStates);
+    else gameBuffer.draw(dustVertices.data(), dustVertices.size(), sf::Quads, dustStates);
+}
+
+void SceneRenderer::drawWalls(PhysicsWorld& physics) {
+    // Relleno + neón de las animadas en tandas (el update ya corrió en render();
+    // las quietas están en la capa estática). Cada destructible corta la tanda y
+    // dibuja sus grietas y vida ahí mismo: una pared que está encima la sigue tapando.
+    auto& walls = physics.getCustomWalls();
+    size_t runStart = 0;
+    for (size_t i = 0; i < walls.size(); ++i) {
+        if (!walls[i].isDestructible) continue;
+        wallRenderer.drawRange(gameBuffer, runStart, i + 1 - runStart);
+        runStart = i + 1;
+        drawWallOverlay(walls.handleAt(i), walls[i], physics.SCALE);
+    }
+    wallRenderer.drawRange(gameBuffer, runStart, walls.size() - runStart);
+}
+
+void SceneRenderer::drawWallOverlay(WallHandle handle, const CustomWall& wall, float scale) {
+    b2Vec2 pos = wall.body->GetPosition();
+    float wPx = wall.width * scale;
+    float hPx = wall.height * scale;
+
+    // 1. GRIETAS (cacheadas por handle, se sortean solo al recibir daño)
+    cracks.draw(gameBuffer, handle, wall, scale);
+
+    // 2. INDICADORES: TEXTO O LEDS
+    if (wall.useTextForHP) {
+        sf::Text hitText;
+        hitText.setFont(uiFont);
+        hitText.setString(std::to_string(wall.currentHits));
+
+        // ESCALA A PRUEBA DE BALAS: Máximo el 60% del lado más chico
+        float minDim = std::min(wPx, hPx);
+        unsigned int calcSize = (unsigned int)(minDim * 0.6f);
+        if (calcSize < 12) calcSize = 12; // Mínimo de seguridad
+        hitText.setCharacterSize(calcSize);
+
+        hitText.setFillColor(sf::Color(255, 255, 255, 140));
+
+        sf::FloatRect textRect = hitText.getLocalBounds();
+        hitText.setOrigin(textRect.left + textRect.width / 2.0f, textRect.top + textRect.height / 2.0f);
+
+        hitText.setPosition(pos.x * scale, pos.y * scale);
+
+        // Si es un pilar vertical, rotamos el número para que encaje mejor
+        float extraRotation = (hPx > wPx * 1.5f) ? 90.0f : 0.0f;
+        hitText.setRotation(wall.body->GetAngle() * 180.0f / 3.14159f + extraRotation);
+
+        gameBuffer.draw(hitText);
+
+    } else {
+        // --- MODO LEDS PROCEDURALES ---
+        float ledBaseSize = 0.30f * scale;
+        float spacing = 0.12f * scale;
+
+        bool vertical = (wPx < hPx);
+        float mainLength = vertical ? hPx : wPx;
+
+        float totalWidth = (wall.maxHits * ledBaseSize) + ((wall.maxHits - 1) * spacing);
+
+        float scaleDown = 1.0f;
+        if (totalWidth > mainLength * 0.85f) {
+            scaleDown = (mainLength * 0.85f) / totalWidth;
+        }
+
+        float ledSize = ledBaseSize * scaleDown;
+        float currentSpacing = spacing * scaleDown;
+        float adjustedTotalWidth = (wall.maxHits * ledSize) + ((wall.maxHits - 1) * currentSpacing);
+
+        float startX = vertical ? 0.0f : (-adjustedTotalWidth / 2.0f + ledSize / 2.0f);
+        float startY = vertical ? (-adjustedTotalWidth / 2.0f + ledSize / 2.0f) : 0.0f;
+
+        sf::Transform t;
+        t.translate(pos.x * scale, pos.y * scale);
+        t.rotate(wall.body->GetAngle() * 180.0f / 3.14159f);
+
+        for (int k = 0; k < wall.maxHits; k++) {
+            sf::RectangleShape led(sf::Vector2f(ledSize, ledSize));
+            led.setOrigin(ledSize / 2.0f, ledSize / 2.0f);
+
+            float lx = vertical ? startX : (startX + k * (ledSize + currentSpacing));
+            float ly = vertical ? (startY + k * (ledSize + currentSpacing)) : startY;
+
+            led.setPosition(t.transformPoint(lx, ly));
+            led.setRotation(wall.body->GetAngle() * 180.0f / 3.14159f);
+
+            if (k < wall.currentHits) {
+                led.setFillColor(sf::Color(100, 255, 100, 220));
+            } else {
+                led.setFillColor(sf::Color(255, 50, 50, 100));
+            }
+            gameBuffer.draw(led);
+        }
+    }
+}
+
+void SceneRenderer::drawKnives(PhysicsWorld& physics) {
+    const auto& bodies = physics.getDynamicBodies();
+
+    for (const auto& knife : physics.getKnives()) {
+        sf::Vector2f drawPos;
+        float drawRot;
+        float kScale = 1.5f * physics.SCALE; // Tamaño visual base (1 metro en el juego)
+
+        if (!knife.isPickedUp) {
+            // Si está tirado, está en su posición.
+            // Rotación en 0 (no da vueltas solo) a menos que vos se la setees.
+            drawPos = sf::Vector2f(knife.body->GetPosition().x * physics.SCALE, knife.body->GetPosition().y * physics.SCALE);
+            drawRot = knife.body->GetAngle() * 180.0f / 3.14159f;
+        } else {
+            // Si alguien lo tiene, lo pegamos al costado/frente del racer
+            int oIdx = knife.ownerIndex;
+            if (oIdx >= 0 && oIdx < (int)bodies.size()) {
+                b2Body* ownerBody = bodies[oIdx];
+                b2Vec2 oPos = ownerBody->GetPosition();
+                float oAngle = ownerBody->GetAngle();
+
+                // Offset matemático para que parezca que lo lleva en la "mano"
+                float rSize = physics.currentRacerSize / 2.0f;
+                b2Vec2 offset(std::cos(oAngle) * (rSize + 0.3f), std::sin(oAngle) * (rSize + 0.3f));
+
+                drawPos = sf::Vector2f((oPos.x + offset.x) * physics.SCALE, (oPos.y + offset.y) * physics.SCALE);
+                drawRot = oAngle * 180.0f / 3.14159f; // Apunta a donde va el racer
+            } else {
+                continue; // Por seguridad
+            }
+        }
+
+        // DIBUJO: Asset vs Fallback
+        if (hasKnifeTex) {
+            sf::Sprite s(knifeTex);
+            // Ponemos el origen en el centro del 499x499
+            s.setOrigin(knifeTex.getSize().x / 2.0f, knifeTex.getSize().y / 2.0f);
+
+            // Escala mágica: Si la imagen es de 499px, queremos que mida kScale (ej: 30px)
+            float scaleFactor = kScale / knifeTex.getSize().x;
+            s.setScale(-scaleFactor, scaleFactor);
+
+            s.setPosition(drawPos);
+            s.setRotation(drawRot);
+            gameBuffer.draw(s);
+        } else {
+            // Fallback: Tu hoja roja
+            sf::ConvexShape tri;
+            tri.setPointCount(3);
+            float triSize = kScale * 0.6f;
+            tri.setPoint(0, sf::Vector2f(0.0f, -triSize));
+            tri.setPoint(1, sf::Vector2f(triSize/2.0f, triSize/2.0f));
+            tri.setPoint(2, sf::Vector2f(-triSize/2.0f, triSize/2.0f));
+
+            tri.setPosition(drawPos);
+            // Le sumamos 90 grados para que la punta del triángulo mire hacia donde viaja
+            tri.setRotation(drawRot + 90.0f);
+            tri.setFillColor(sf::Color(220, 220, 220));
+            tri.setOutlineColor(sf::Color::Red);
+            tri.setOutlineThickness(2.0f);
+
+            gameBuffer.draw(tri);
+        }
+    }
+}
+
+void SceneRenderer::drawWinZone(PhysicsWorld& physics, float globalTime) {
+    b2Body* zone = physics.getWinZoneBody();
+    if (!zone) return;
+
+    b2Vec2 pos = zone->GetPosition();
+    sf::RectangleShape zoneRect;
+    float w = physics.winZoneSize[0] * physics.SCALE;
+    float h = physics.winZoneSize[1] * physics.SCALE;
+
+    // --- LÓGICA DE GLOW GUARDABLE ---
+    float alpha = 100.0f; // Alpha estático por defecto
+    if (physics.winZoneGlow) {
+        float pulse = (std::sin(globalTime * 1.5f) + 1.0f) * 0.5f;
+        alpha = 50.0f + pulse * 100.0f; // Pulso activo
+    }
+
+    zoneRect.setSize(sf::Vector2f(w, h));
+    zoneRect.setOrigin(w/2.0f, h/2.0f);
+    zoneRect.setPosition(pos.x * physics.SCALE, pos.y * physics.SCALE);
+    zoneRect.setFillColor(sf::Color(255, 215, 0, (sf::Uint8)alpha));
+    zoneRect.setOutlineColor(sf::Color::Yellow);
+    zoneRect.setOutlineThickness(0.1f * physics.SCALE);
+    gameBuffer.draw(zoneRect);
+}
+
+void SceneRenderer::drawGraves(PhysicsWorld& physics) {
+    const auto& statuses = physics.getRacerStatus();
+    float tombSize = 0.8f * physics.SCALE;  // 1.0 metros en escala visual
+    float crossThick = 0.15f * physics.SCALE; // Grosor de la cruz
+    float outlineThick = 0.08f * physics.SCALE;
+
+    for (size_t i = 0; i < statuses.size(); ++i) {
+        const auto& status = statuses[i];
+        if (status.isAlive) continue;
+
+        float px = status.deathPos.x * physics.SCALE;
+        float py = status.deathPos.y * physics.SCALE;
+
+        sf::Color deathColor = (i < 4) ? racerColors[i] : sf::Color::White;
+
+        sf::RectangleShape grave;
+        grave.setSize(sf::Vector2f(tombSize, tombSize));
+        grave.setOrigin(tombSize / 2.0f, tombSize / 2.0f);
+        grave.setPosition(px, py);
+        grave.setFillColor(sf::Color(20, 20, 20, 240));
+        grave.setOutlineColor(deathColor);
+        grave.setOutlineThickness(outlineThick);
+        gameBuffer.draw(grave);
+
+        float crossLen = tombSize * 0.8f;
+
+        sf::RectangleShape bar1(sf::Vector2f(crossLen, crossThick));
+        sf::RectangleShape bar2(sf::Vector2f(crossLen, crossThick));
+
+        bar1.setOrigin(crossLen / 2.0f, crossThick / 2.0f);
+        bar2.setOrigin(crossLen / 2.0f, crossThick / 2.0f);
+
+        bar1.setPosition(px, py);
+        bar2.setPosition(px, py);
+
+        bar1.setRotation(45.0f);
+        bar2.setRotation(-45.0f);
+
+        bar1.setFillColor(deathColor);
+        bar2.setFillColor(deathColor);
+
+        gameBuffer.draw(bar1);
+        gameBuffer.draw(bar2);
+    }
+}
+
+void SceneRenderer::drawTrails(PhysicsWorld& physics) {
+    // Ancho constante, clavado al tamaño del racer
+    trails.draw(gameBuffer, physics.currentRacerSize * physics.SCALE);
+}
+
+void SceneRenderer::drawRacers(PhysicsWorld& physics) {
+    const auto& bodies = physics.getDynamicBodies();
+    const auto& currentStatuses = physics.getRacerStatus();
+
+    for (size_t i = 0; i < bodies.size(); ++i) {
+        if (i < currentStatuses.size() && !currentStatuses[i].isAlive) continue;
+        b2Body* body = bodies[i];
+        b2Vec2 pos = body->GetPosition();
+        float angle = body->GetAngle();
+        float drawSize = physics.currentRacerSize * physics.SCALE;
+        sf::RectangleShape rect;
+        rect.setSize(sf::Vector2f(drawSize, drawSize));
+        rect.setOrigin(drawSize / 2.0f, drawSize / 2.0f);
+        rect.setPosition(pos.x * physics.SCALE, pos.y * physics.SCALE);
+        rect.setRotation(angle * 180.0f / 3.14159f);
+        if (i < 4) rect.setOutlineColor(racerColors[i]);
+        else rect.setOutlineColor(sf::Color::White);
+        rect.setFillColor(sf::Color::White);
+        rect.setOutlineThickness(-0.1f * physics.SCALE);
+        gameBuffer.draw(rect);
+    }
+}
+
+const sf::Texture& SceneRenderer::applyBloom() {
+    const int levels = std::clamp(bloomLevels, 1, BloomMaxLevels);
+    auto texelOf = [](const sf::Texture& tex) {
+        sf::Vector2u size = tex.getSize();
+        return sf::Vector2f(1.0f / size.x, 1.0f / size.y);
+    };
+    // Sprite que cubre justo el RenderTexture destino
+    auto fitSprite = [](const sf::Texture& tex, const sf::RenderTexture& target) {
+        sf::Sprite sprite(tex);
+        sprite.setScale((float)target.getSize().x / tex.getSize().x, (float)target.getSize().y / tex.getSize().y);
+        return sprite;
+    };
+
+    // 1. EXTRAER BRILLO (y bajar a media resolución en la misma pasada)
+    {
+        ProfileScope timer(profiler, ProfileStage::BloomBrightness);
+        const sf::Texture& source = gameBuffer.getTexture();
+        bloomPrefilterShader.setUniform("source", sf::Shader::CurrentTexture);
+        bloomPrefilterShader.setUniform("halfTexel", texelOf(source) * 0.5f);
+        bloomPrefilterShader.setUniform("threshold", bloomThreshold);
+        bloomChain[0].clear(sf::Color::Black);
+        bloomChain[0].draw(fitSprite(source, bloomChain[0]), &bloomPrefilterShader);
+        bloomChain[0].display();
+    }
+
+    // 2. CADENA DE MIPS
+    {
+        ProfileScope timer(profiler, ProfileStage::BloomBlur);
+
+        // Bajada: cada nivel sale del anterior
+        for (int i = 1; i < levels; ++i) {
+            const sf::Texture& source = bloomChain[i - 1].getTexture();
+            bloomDownShader.setUniform("source", sf::Shader::CurrentTexture);
+            bloomDownShader.setUniform("texel", texelOf(source));
+            bloomChain[i].clear(sf::Color::Black);
+            bloomChain[i].draw(fitSprite(source, bloomChain[i]), &bloomDownShader);
+            bloomChain[i].display();
+        }
+
+        // Subida: el nivel chico se agranda y se SUMA encima del de arriba
+        sf::RenderStates addStates(sf::BlendAdd);
+        addStates.shader = &bloomUpShader;
+        for (int i = levels - 2; i >= 0; --i) {
+            const sf::Texture& source = bloomChain[i + 1].getTexture();
+            bloomUpShader.setUniform("source", sf::Shader::CurrentTexture);
+            bloomUpShader.setUniform("halfTexel", texelOf(source) * 0.5f);
+            bloomChain[i].draw(fitSprite(source, bloomChain[i]), addStates);
+            bloomChain[i].display();
+        }
+    }
+
+    // 3. FUSIÓN ADITIVA
+    // El nivel 0 quedó con la suma de todos: se promedia para que "Intensity" no
+    // dependa de cuántos niveles haya
+    ProfileScope timer(profiler, ProfileStage::BloomBlend);
+    blendShader.setUniform("baseTexture", sf::Shader::CurrentTexture);
+    blendShader.setUniform("bloomTexture", bloomChain[0].getTexture());
+    blendShader.setUniform("multiplier", bloomMultiplier / levels);
+
+    finalBuffer.clear();
+    sf::Sprite finalBaseSprite(gameBuffer.getTexture());
+    finalBuffer.draw(finalBaseSprite, &blendShader);
+    finalBuffer.display();
+
+    return finalBuffer.getTexture();
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <random>
+#include <vector>
+#include "../Physics/PhysicsWorld.hpp"
+#include "WallRenderer.hpp"
+#include "CrackRenderer.hpp"
+#include "TrailRenderer.hpp"
+#include "../Utils/Profiler.hpp"
+
+// --- RENDER DE LA ESCENA COMPLETA ---
+// Todo lo que va al video: polvo, grilla + paredes quietas (capa retenida), paredes
+// animadas, cuchillos, meta, tumbas, estelas, racers, partículas y el bloom. Antes vivía entero adentro del while de main();
+// ahora lo usan igual el editor (con ventana + ImGui) y el render offline (sin ventana),
+// así los dos sacan exactamente los mismos píxeles.
+
+class SceneRenderer {
+public:
+    SceneRenderer(unsigned int width, unsigned int height);
+
+    // Crea los RenderTextures, compila los shaders y carga fuente/assets.
+    // false si no hay VRAM o la GPU no banca shaders (ya avisa por consola).
+    bool init();
+
+    // Estelas: se alimentan después de cada step de física
+    void updateTrails(const PhysicsWorld& physics);
+    void clearTrails();
+
+    // Polvo atmosférico: solo se mueve cuando corre el tiempo
+    void updateDust(float dt);
+
+    // Cantidad de motas. Regenera el buffer estático: es para el panel, no para cada frame.
+    void setDustCount(size_t count);
+    size_t getDustCount() const { return dustVertices.size() / 4; }
+    static constexpr size_t DefaultDustCount = 70;
+
+    // Dibuja el frame entero y devuelve la textura final (con o sin bloom)
+    const sf::Texture& render(PhysicsWorld& physics, float globalTime);
+
+    // Resolución real de render = la de captura (la del constructor) * scale.
+    // Las coordenadas siguen siendo las de captura; la textura devuelta por render() sale más chica.
+    // Cambiarla recrea los buffers: pensado para saltar entre preview y grabación, no por frame.
+    bool setRenderScale(float scale);
+    float getRenderScale() const { return renderScale; }
+
+    // Post-proceso (lo toca el panel de ImGui)
+    bool enableBloom = true;
+    float bloomThreshold = 0.9f;  // A partir de qué brillo empieza a generar glow
+    float bloomMultiplier = 0.5f; // Intensidad del neón
+    int bloomLevels = 5;          // Niveles de la cadena de mips (más = glow más ancho)
+    static constexpr int BloomMaxLevels = 6;
+
+    Profiler* profiler = nullptr; // Timers de paredes, estelas, partículas y bloom
+
+    static const sf::Color racerColors[4];
+
+private:
+    void drawDust(float globalTime);
+    void drawWalls(PhysicsWorld& physics);
+    void drawWallOverlay(WallHandle handle, const CustomWall& wall, float scale); // Grietas + vida de una destructible
+    void drawKnives(PhysicsWorld& physics);
+    void drawWinZone(PhysicsWorld& physics, float globalTime);
+    void drawGraves(PhysicsWorld& physics);
+    void drawTrails(PhysicsWorld& physics);
+    void drawRacers(PhysicsWorld& physics);
+    void drawParticles(const ParticlePool& pool);
+    const sf::Texture& applyBloom();
+    bool createBuffers();
+    void refreshStaticLayer();
+    void redrawStaticRegion(const sf::FloatRect& region);
+
+    unsigned int width;  // Lógico (captura)
+    unsigned int height;
+    unsigned int renderWidth; // Real (width * renderScale)
+    unsigned int renderHeight;
+    float renderScale = 1.0f;
+
+    sf::RenderTexture gameBuffer;
+    // Cadena del bloom: media resolución y cada nivel la mitad del anterior
+    sf::RenderTexture bloomChain[BloomMaxLevels];
+    sf::RenderTexture finalBuffer;
+    sf::Shader bloomPrefilterShader, bloomDownShader, bloomUpShader, blendShader;
+
+    sf::Font uiFont;
+    sf::Texture knifeTex;
+    bool hasKnifeTex = false;
+    sf::Texture gridTexture;
+    sf::Sprite background;
+
+    // Capa estática: grilla + paredes quietas, retenida entre frames (alfa premultiplicado).
+    // Se redibujan solo las regiones que avisa el WallRenderer; entera al recrear buffers.
+    sf::RenderTexture staticLayer;
+    sf::Sprite staticSprite;
+    bool staticLayerValid = false;
+    std::vector<sf::FloatRect> staticRegions;
+
+    WallRenderer wallRenderer;
+    CrackRenderer cracks;
+    sf::VertexBuffer particleVbo; // Stream, del tamaño del pool: se pisa el tramo vivo cada frame
+    bool useParticleVbo = false;
+    TrailRenderer trails;
+    // --- POLVO ATMOSFÉRICO ---
+    // Un quad por mota con sus parámetros empaquetados en los vértices, subido una
+    // sola vez a un VertexBuffer estático. El vertex shader calcula la subida y el
+    // vaivén con el tiempo: dibujar 70 o 20000 motas no le cuesta nada a la CPU.
+    void uploadDust();
+    std::vector<sf::Vertex> dustVertices; // Copia en CPU (y fallback si no hay VBO)
+    sf::VertexBuffer dustVbo;
+    bool useDustVbo = false;
+    sf::Shader dustShader;
+    float dustTime = 0.0f; // Reloj de la subida: avanza solo con updateDust
+    std::mt19937 dustRng;  // Solo para sembrar las motas (ver setDustCount)
+    static constexpr uint32_t DustSeed = 7331;
+};
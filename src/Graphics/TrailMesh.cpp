@@ -0,0 +1,74 @@
+#include "TrailMesh.hpp"
+#include <cmath>
+
+namespace {
+
+sf::Vertex trailVertex(sf::Vector2f pos, sf::Vector2f normal, uint32_t sequence, bool positiveSide) {
+    sf::Color packed((sf::Uint8)(sequence & 0xFF), (sf::Uint8)((sequence >> 8) & 0xFF),
+                     (sf::Uint8)((sequence >> 16) & 0xFF), positiveSide ? 255 : 0);
+    return sf::Vertex(pos, packed, normal);
+}
+
+}
+
+TrailRing::TrailRing()
+    : verts(MaxSegments * VertsPerSegment)
+{
+}
+
+int TrailRing::push(sf::Vector2f point, float overlap) {
+    sf::Vector2f older = lastPoint;
+    bool hasSegment = (count > 0);
+
+    head++;
+    lastPoint = point;
+    count++;
+    if (!hasSegment) return -1;
+
+    // Ring lleno: el segmento nuevo pisa al más viejo
+    if (count - 1 > MaxSegments) count = MaxSegments + 1;
+
+    int slot = (int)(head % MaxSegments);
+    sf::Vertex* out = &verts[(size_t)slot * VertsPerSegment];
+
+    sf::Vector2f dir = older - point;
+    float len = std::sqrt(dir.x*dir.x + dir.y*dir.y);
+    if (len < 0.001f) {
+        // Racer quieto: el tramo existe (cuenta para la edad) pero no tiene área
+        for (size_t v = 0; v < VertsPerSegment; ++v) out[v] = trailVertex(point, {0.0f, 0.0f}, head, v % 3 == 0);
+        return slot;
+    }
+
+    sf::Vector2f normal(-dir.y/len, dir.x/len);
+
+    // SOLAPAMIENTO SUTIL (Overlap)
+    sf::Vector2f stretch = (dir / len) * overlap;
+    sf::Vector2f newerExt = point - stretch;
+    sf::Vector2f olderExt = older + stretch;
+
+    // Mismo orden que los quads viejos: punta nueva (+, -), punta vieja (-, +)
+    out[0] = trailVertex(newerExt, normal, head, true);
+    out[1] = trailVertex(newerExt, normal, head, false);
+    out[2] = trailVertex(olderExt, normal, head - 1, false);
+    out[3] = trailVertex(olderExt, normal, head - 1, true);
+    return slot;
+}
+
+int TrailRing::liveRanges(size_t first[2], size_t counts[2]) const {
+    size_t segments = (count > 1) ? count - 1 : 0;
+    if (segments == 0) return 0;
+
+    size_t oldest = (size_t)((head - (uint32_t)(segments - 1)) % MaxSegments);
+    if (oldest + segments <= MaxSegments) {
+        first[0] = oldest * VertsPerSegment;
+        counts[0] = segments * VertsPerSegment;
+        return 1;
+    }
+
+    size_t tailPart = MaxSegments - oldest;
+    first[0] = oldest * VertsPerSegment;
+    counts[0] = tailPart * VertsPerSegment;
+    first[1] = 0;
+    counts[1] = (segments - tailPart) * VertsPerSegment;
+    return 2;
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// --- GEOMETRÍA DE LAS ESTELAS (RING) ---
+// Antes: un deque de puntos por racer y, en cada frame, dos VertexArray armados de
+// cero (normales, anchos y colores de todos los tramos). Ahora cada punto nuevo
+// escribe UN segmento (un quad) en un ring de tamaño fijo y la cola se corre
+// moviendo un índice: O(1) por racer y por frame, sin importar el largo.
+// El quad no guarda ni ancho ni color: eso depende de la edad relativa al largo
+// actual y lo calcula el shader de TrailRenderer. Cada vértice lleva:
+//  - position:  punto del centro (ya estirado por el solapamiento entre tramos)
+//  - texCoords: normal unitaria del tramo
+//  - color:     rgb = secuencia del punto (24 bits), a = lado (255 = +normal, 0 = -normal)
+// No toca GL: el bench lo mide sin contexto.
+
+class TrailRing {
+public:
+    // Potencia de 2: la secuencia (uint32) da la vuelta sin saltar de slot.
+    // El largo pedido es speed * 1.5 + 5 puntos: hace falta ir a más de 160 m/s para llenarlo.
+    static constexpr size_t MaxSegments = 256;
+    static constexpr size_t VertsPerSegment = 4;
+
+    TrailRing();
+
+    sf::Color color;
+
+    void clear() { count = 0; }
+
+    // Agrega el punto más nuevo. Devuelve el slot de segmento escrito (-1 si es el primero).
+    // overlap = cuánto se estira cada punta para tapar la junta con el tramo vecino (px).
+    int push(sf::Vector2f point, float overlap);
+
+    // Saca el punto más viejo: solo corre la cola
+    void popTail() { if (count > 0) --count; }
+
+    size_t size() const { return count; } // Puntos vivos
+    uint32_t headSequence() const { return head & 0xFFFFFF; } // Lo que espera el shader
+
+    // Segmentos vivos dentro de vertices(): como mucho 2 tramos por la vuelta del ring.
+    // Devuelve cuántos tramos hay; first/counts en vértices.
+    int liveRanges(size_t first[2], size_t counts[2]) const;
+
+    const std::vector<sf::Vertex>& vertices() const { return verts; }
+
+private:
+    std::vector<sf::Vertex> verts; // MaxSegments * VertsPerSegment
+    uint32_t head = 0;             // Secuencia del punto más nuevo
+    size_t count = 0;
+    sf::Vector2f lastPoint;
+};
@@ -0,0 +1,131 @@
+#include "TrailRenderer.hpp"
+#include <iostream>
+
+namespace {
+
+// Reconstruye la edad del vértice (secuencia de 24 bits en el rgb del color) y con eso
+// el ancho y el color. Es la misma cuenta que hacían los VertexArray, vértice por vértice.
+const char* trailVert = R"(
+    uniform float head;       // Secuencia del punto más nuevo
+    uniform float count;      // Puntos vivos: la vida es relativa al largo actual
+    uniform float halfWidth;  // Medio ancho en la cabeza (px)
+    uniform float alphaMult;
+    uniform vec4 baseColor;
+
+    void main() {
+        vec3 bytes = floor(gl_Color.rgb * 255.0 + 0.5);
+        float birth = bytes.r + bytes.g * 256.0 + bytes.b * 65536.0;
+        float age = head - birth;
+        if (age < 0.0) age += 16777216.0; // La secuencia dio la vuelta
+
+        // Cálculo de vida (0.0 a 1.0) para ir apagando la luz
+        float life = max(1.0 - age / count, 0.0);
+
+        // Anchos afinándose hacia la punta
+        float side = (gl_Color.a > 0.5) ? 1.0 : -1.0;
+        vec2 pos = gl_Vertex.xy + gl_MultiTexCoord0.xy * (side * halfWidth * pow(life, 0.6));
+        gl_Position = gl_ModelViewProjectionMatrix * vec4(pos, 0.0, 1.0);
+
+        // --- MAGIA TERMODINÁMICA ---
+        vec4 white = vec4(245.0 / 255.0, 245.0 / 255.0, 245.0 / 255.0, 1.0);
+        vec4 c;
+        if (life >= 0.8) {
+            // 0% a 20% de edad: Blanco incandescente (apenas apagado para no quemar)
+            c = white;
+        } else if (life >= 0.3) {
+            // 20% a 70% de edad: Transición Blanco -> Color Base
+            c = mix(baseColor, white, (life - 0.3) / 0.5);
+        } else {
+            // 70% a 100% de edad: Transición Color Base -> Transparente
+            c = mix(vec4(0.0), baseColor, life / 0.3);
+        }
+
+        // Ajustamos la opacidad para controlar el brillo en el BlendAdd
+        c.a *= alphaMult;
+        gl_FrontColor = c;
+    }
+)";
+
+const char* trailFrag = R"(
+    void main() {
+        gl_FragColor = gl_Color;
+    }
+)";
+
+}
+
+TrailRenderer::TrailRenderer(size_t racerCount)
+    : rings(racerCount)
+{
+}
+
+bool TrailRenderer::init() {
+    if (!shader.loadFromMemory(trailVert, trailFrag)) {
+        std::cerr << "[TRAILS] No compiló el shader de estelas" << std::endl;
+        return false;
+    }
+
+    useVbo = sf::VertexBuffer::isAvailable();
+    vbos.assign(useVbo ? rings.size() : 0, sf::VertexBuffer());
+    for (size_t i = 0; i < vbos.size() && useVbo; ++i) {
+        vbos[i].setPrimitiveType(sf::Quads);
+        vbos[i].setUsage(sf::VertexBuffer::Stream);
+        // Sin VBO seguimos dibujando directo desde el ring en CPU
+        if (!vbos[i].create(TrailRing::MaxSegments * TrailRing::VertsPerSegment)) { useVbo = false; break; }
+        vbos[i].update(rings[i].vertices().data()); // Lo que ya tuviera el ring
+    }
+    return true;
+}
+
+void TrailRenderer::setColor(size_t racer, sf::Color color) {
+    if (racer < rings.size()) rings[racer].color = color;
+}
+
+void TrailRenderer::push(size_t racer, sf::Vector2f point, size_t maxPoints, float overlap) {
+    if (racer >= rings.size()) return;
+    TrailRing& trail = rings[racer];
+
+    int slot = trail.push(point, overlap);
+    if (trail.size() > maxPoints) trail.popTail();
+
+    if (useVbo && slot >= 0) {
+        size_t first = (size_t)slot * TrailRing::VertsPerSegment;
+        vbos[racer].update(&trail.vertices()[first], TrailRing::VertsPerSegment, (unsigned int)first);
+    }
+}
+
+void TrailRenderer::clear() {
+    for (auto& trail : rings) trail.clear();
+}
+
+void TrailRenderer::draw(sf::RenderTarget& target, float baseWidth) {
+    // MAGIA ACÁ: Fusión Aditiva (BlendAdd).
+    // En vez de tapar lo que hay abajo, suma luz. El shader de Bloom se hace un festín.
+    sf::RenderStates states;
+    states.blendMode = sf::BlendAdd;
+    states.shader = &shader;
+
+    // Glow primero (ancho, tenue) y el core encima (fino, fuerte)
+    const float layerHalfWidth[2] = { baseWidth * 1.6f * 0.4f, baseWidth * 0.3f };
+    const float layerAlpha[2] = { 0.35f, 0.85f };
+
+    for (size_t i = 0; i < rings.size(); ++i) {
+        const TrailRing& trail = rings[i];
+        size_t first[2], counts[2];
+        int ranges = trail.liveRanges(first, counts);
+        if (ranges == 0) continue;
+
+        shader.setUniform("head", (float)trail.headSequence());
+        shader.setUniform("count", (float)trail.size());
+        shader.setUniform("baseColor", sf::Glsl::Vec4(trail.color));
+
+        for (int layer = 0; layer < 2; ++layer) {
+            shader.setUniform("halfWidth", layerHalfWidth[layer]);
+            shader.setUniform("alphaMult", layerAlpha[layer]);
+            for (int r = 0; r < ranges; ++r) {
+                if (useVbo) target.draw(vbos[i], first[r], counts[r], states);
+                else target.draw(&trail.vertices()[first[r]], counts[r], sf::Quads, states);
+            }
+        }
+    }
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <vector>
+#include "TrailMesh.hpp"
+
+// --- RENDER DE ESTELAS ---
+// Un TrailRing por racer y un VertexBuffer fijo del mismo tamaño en la GPU.
+// Cada punto nuevo sube un solo quad (4 vértices) a su slot; achicar es correr la cola.
+// El ancho que se afina hacia la punta y la "termodinámica" del color (blanco ->
+// color del racer -> transparente) salen de la edad del vértice en el vertex shader,
+// así que dibujar no recalcula nada en CPU. Glow y core son el mismo buffer
+// dibujado dos veces con otro ancho y otro alpha.
+
+class TrailRenderer {
+public:
+    explicit TrailRenderer(size_t racerCount = 4);
+
+    // Compila el shader y crea los buffers (necesita contexto GL)
+    bool init();
+
+    void setColor(size_t racer, sf::Color color);
+
+    // Un punto nuevo por racer y por step. maxPoints = largo deseado: la cola se corre
+    // de a un punto por llamada, igual que antes, así la estela se acorta suave.
+    void push(size_t racer, sf::Vector2f point, size_t maxPoints, float overlap);
+    void clear();
+
+    // baseWidth = tamaño del racer en píxeles
+    void draw(sf::RenderTarget& target, float baseWidth);
+
+    const TrailRing& ring(size_t racer) const { return rings[racer]; }
+    size_t size() const { return rings.size(); }
+
+private:
+    std::vector<TrailRing> rings;
+    std::vector<sf::VertexBuffer> vbos;
+    bool useVbo = false;
+    sf::Shader shader;
+};
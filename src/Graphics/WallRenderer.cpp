@@ -0,0 +1,292 @@
+#include "WallRenderer.hpp"
+#include "ColorUtils.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    // Dos tramos sucios separados por menos de esto se suben juntos:
+    // un update() más grande sale más barato que muchos chiquitos
+    const size_t MERGE_GAP_WALLS = 4;
+
+    // Más regiones sucias que esto en un frame y se redibuja su unión de una
+    const size_t MAX_STATIC_DIRTY = 8;
+
+    // Margen alrededor de cada pared para que no queden restos del borde al limpiar
+    const float DIRTY_PADDING = 2.0f;
+
+    sf::FloatRect unite(const sf::FloatRect& a, const sf::FloatRect& b) {
+        float left = std::min(a.left, b.left);
+        float top = std::min(a.top, b.top);
+        float right = std::max(a.left + a.width, b.left + b.width);
+        float bottom = std::max(a.top + a.height, b.top + b.height);
+        return sf::FloatRect(left, top, right - left, bottom - top);
+    }
+}
+
+bool WallRenderer::DrawKey::operator==(const DrawKey& o) const {
+    return x == o.x && y == o.y && angle == o.angle
+        && width == o.width && height == o.height
+        && thickness == o.thickness && shapeType == o.shapeType
+        && fill == o.fill && outline == o.outline;
+}
+
+WallRenderer::WallRenderer() {
+    useVbo = sf::VertexBuffer::isAvailable();
+    vbo.setPrimitiveType(sf::Triangles);
+    vbo.setUsage(sf::VertexBuffer::Dynamic);
+}
+
+void WallRenderer::ensureCapacity(size_t count) {
+    if (keys.size() < count) {
+        keys.resize(count);
+        dirty.resize(count, 0);
+        inStaticLayer.resize(count, 0);
+        vertices.resize(count * VERTS_PER_WALL);
+    }
+
+    if (useVbo && vboCapacity < count) {
+        // Crecemos al doble para no recrear el buffer por cada pared nueva
+        size_t newCapacity = std::max<size_t>(64, count * 2);
+        if (!vbo.create(newCapacity * VERTS_PER_WALL)) {
+            useVbo = false; // Sin VBO seguimos con el arreglo en CPU
+            return;
+        }
+        vboCapacity = newCapacity;
+        // Buffer nuevo = vacío: hay que volver a subir todo lo que ya teníamos
+        std::fill(dirty.begin(), dirty.begin() + count, 1);
+    }
+}
+
+void WallRenderer::buildWallGeometry(const DrawKey& key, sf::Vertex* out) const {
+    float hw = key.width / 2.0f;
+    float hh = key.height / 2.0f;
+
+    // Polígono local (misma forma que el b2PolygonShape)
+    sf::Vector2f local[4];
+    int n;
+    if (key.shapeType == 1) {
+        local[0] = sf::Vector2f(0.0f, -hh);
+        local[1] = sf::Vector2f(hw, hh);
+        local[2] = sf::Vector2f(-hw, hh);
+        n = 3;
+    } else {
+        local[0] = sf::Vector2f(-hw, -hh);
+        local[1] = sf::Vector2f(hw, -hh);
+        local[2] = sf::Vector2f(hw, hh);
+        local[3] = sf::Vector2f(-hw, hh);
+        n = 4;
+    }
+
+    sf::Vector2f centroid(0.0f, 0.0f);
+    for (int i = 0; i < n; ++i) { centroid.x += local[i].x; centroid.y += local[i].y; }
+    centroid.x /= n; centroid.y /= n;
+
+    // Normal hacia afuera de cada lado
+    sf::Vector2f normals[4];
+    for (int i = 0; i < n; ++i) {
+        sf::Vector2f a = local[i];
+        sf::Vector2f b = local[(i + 1) % n];
+        sf::Vector2f nrm(a.y - b.y, b.x - a.x);
+        float len = std::sqrt(nrm.x * nrm.x + nrm.y * nrm.y);
+        if (len > 0.0f) { nrm.x /= len; nrm.y /= len; }
+        sf::Vector2f mid((a.x + b.x) * 0.5f - centroid.x, (a.y + b.y) * 0.5f - centroid.y);
+        if (nrm.x * mid.x + nrm.y * mid.y < 0.0f) { nrm.x = -nrm.x; nrm.y = -nrm.y; }
+        normals[i] = nrm;
+    }
+
+    // Borde hacia adentro (como setOutlineThickness negativo): vértice interior por miter
+    sf::Vector2f inner[4];
+    for (int i = 0; i < n; ++i) {
+        sf::Vector2f n1 = normals[(i + n - 1) % n];
+        sf::Vector2f n2 = normals[i];
+        float factor = 1.0f + (n1.x * n2.x + n1.y * n2.y);
+        sf::Vector2f miter((n1.x + n2.x) / factor, (n1.y + n2.y) / factor);
+        inner[i] = sf::Vector2f(local[i].x - miter.x * key.thickness, local[i].y - miter.y * key.thickness);
+    }
+
+    // A mundo (píxeles)
+    float cs = std::cos(key.angle);
+    float sn = std::sin(key.angle);
+    auto toWorld = [&](sf::Vector2f p) {
+        return sf::Vector2f(key.x + p.x * cs - p.y * sn, key.y + p.x * sn + p.y * cs);
+    };
+
+    sf::Vector2f outerW[4], innerW[4];
+    for (int i = 0; i < n; ++i) { outerW[i] = toWorld(local[i]); innerW[i] = toWorld(inner[i]); }
+
+    size_t v = 0;
+    auto emit = [&](sf::Vector2f p, sf::Color c) {
+        out[v].position = p;
+        out[v].color = c;
+        out[v].texCoords = sf::Vector2f(0.0f, 0.0f);
+        v++;
+    };
+
+    // 1. Relleno (abanico)
+    for (int i = 1; i + 1 < n; ++i) {
+        emit(outerW[0], key.fill);
+        emit(outerW[i], key.fill);
+        emit(outerW[i + 1], key.fill);
+    }
+
+    // 2. Borde neón: un quad (2 triángulos) por lado, entre el contorno y el interior
+    for (int i = 0; i < n; ++i) {
+        int j = (i + 1) % n;
+        emit(outerW[i], key.outline);
+        emit(outerW[j], key.outline);
+        emit(innerW[j], key.outline);
+        emit(outerW[i], key.outline);
+        emit(innerW[j], key.outline);
+        emit(innerW[i], key.outline);
+    }
+
+    // El pincho usa menos vértices que la caja: rellenamos con triángulos degenerados
+    while (v < VERTS_PER_WALL) emit(outerW[0], sf::Color::Transparent);
+}
+
+bool WallRenderer::isStaticWall(const CustomWall& wall) {
+    if (wall.flashTimer > 0.0f || wall.pendingDestroy) return false;
+    if (wall.isDeadly || wall.isMoving || wall.isExpandable) return false;
+    // Dañada = tiene grietas y va a volver a flashear: mejor que siga en el VBO
+    return !(wall.isDestructible && wall.currentHits < wall.maxHits);
+}
+
+sf::FloatRect WallRenderer::keyBounds(const DrawKey& key) {
+    // Círculo que contiene la caja rotada: no hace falta más exacto para invalidar
+    float r = 0.5f * std::sqrt(key.width * key.width + key.height * key.height) + DIRTY_PADDING;
+    return sf::FloatRect(key.x - r, key.y - r, 2.0f * r, 2.0f * r);
+}
+
+void WallRenderer::addStaticDirty(const sf::FloatRect& rect) {
+    // Si pisa una región que ya estaba, se funden (una pared que flashea seguido cae siempre en la misma)
+    sf::FloatRect merged = rect;
+    for (size_t i = 0; i < staticDirty.size();) {
+        if (staticDirty[i].intersects(merged)) {
+            merged = unite(merged, staticDirty[i]);
+            staticDirty[i] = staticDirty.back();
+            staticDirty.pop_back();
+        } else {
+            ++i;
+        }
+    }
+    staticDirty.push_back(merged);
+
+    if (staticDirty.size() > MAX_STATIC_DIRTY) {
+        for (size_t i = 1; i < staticDirty.size(); ++i) staticDirty[0] = unite(staticDirty[0], staticDirty[i]);
+        staticDirty.resize(1);
+    }
+}
+
+bool WallRenderer::takeStaticDirty(std::vector<sf::FloatRect>& out) {
+    out.swap(staticDirty);
+    staticDirty.clear();
+    return !out.empty();
+}
+
+void WallRenderer::update(const SlotMap<CustomWall>& walls, float scale, float globalTime) {
+    // Las que ya no existen (swap-remove deja el final vacío) se borran de la capa
+    for (size_t i = walls.size(); i < wallCount; ++i) {
+        if (!inStaticLayer[i]) continue;
+        addStaticDirty(keyBounds(keys[i]));
+        inStaticLayer[i] = 0;
+    }
+
+    wallCount = walls.size();
+    ensureCapacity(wallCount);
+    lastDirtyCount = 0;
+
+    // El pulso de los pinchos es igual para todos: lo calculamos una vez
+    float dangerPulse = (std::sin(globalTime * 10.0f) + 1.0f) * 0.5f;
+    float baseThickness = 0.08f * scale;
+
+    for (size_t i = 0; i < wallCount; ++i) {
+        const CustomWall& wall = walls[i];
+        b2Vec2 pos = wall.body->GetPosition();
+
+        DrawKey key;
+        key.x = pos.x * scale;
+        key.y = pos.y * scale;
+        key.angle = wall.body->GetAngle();
+        key.width = wall.width * scale;
+        key.height = wall.height * scale;
+        key.shapeType = wall.shapeType;
+        key.fill = lerpColor(wall.baseFillColor, wall.flashColor, wall.flashTimer);
+        key.outline = lerpColor(wall.neonColor, sf::Color::White, wall.flashTimer * 0.5f);
+        key.thickness = baseThickness + (wall.flashTimer * baseThickness);
+
+        if (wall.isDeadly) {
+            key.fill = sf::Color(100 + (dangerPulse * 50), 0, 0, 255);
+            key.outline = sf::Color::Red;
+        }
+
+        // Las paredes se compactan al borrar (swap-remove): comparar contra lo que hay
+        // en el tramo y no contra "la misma pared" es justo lo que queremos
+        bool isStatic = isStaticWall(wall);
+        bool changed = !(key == keys[i]) || isStatic != (inStaticLayer[i] != 0);
+        if (!dirty[i] && !changed) continue;
+
+        // Lo que estaba en la capa sale de ahí y lo que entra se pinta en su lugar nuevo
+        if (changed) {
+            if (inStaticLayer[i]) addStaticDirty(keyBounds(keys[i]));
+            if (isStatic) addStaticDirty(keyBounds(key));
+            inStaticLayer[i] = isStatic ? 1 : 0;
+        }
+
+        keys[i] = key;
+        if (isStatic) {
+            // Tramo vacío en el VBO: triángulos degenerados transparentes
+            sf::Vertex* out = &vertices[i * VERTS_PER_WALL];
+            std::fill(out, out + VERTS_PER_WALL, sf::Vertex(sf::Vector2f(key.x, key.y), sf::Color::Transparent));
+        } else {
+            buildWallGeometry(key, &vertices[i * VERTS_PER_WALL]);
+        }
+        dirty[i] = 1;
+        lastDirtyCount++;
+    }
+
+    if (!useVbo) {
+        std::fill(dirty.begin(), dirty.begin() + wallCount, 0);
+        return;
+    }
+
+    // Subimos los tramos sucios, juntando los que están cerca
+    size_t i = 0;
+    while (i < wallCount) {
+        if (!dirty[i]) { ++i; continue; }
+
+        size_t start = i;
+        size_t end = i + 1;
+        for (size_t j = end; j < wallCount && j - end <= MERGE_GAP_WALLS; ++j) {
+            if (dirty[j]) end = j + 1;
+        }
+
+        vbo.update(&vertices[start * VERTS_PER_WALL],
+                   (end - start) * VERTS_PER_WALL,
+                   (unsigned int)(start * VERTS_PER_WALL));
+        std::fill(dirty.begin() + start, dirty.begin() + end, 0);
+        i = end;
+    }
+}
+
+void WallRenderer::draw(sf::RenderTarget& target, const sf::RenderStates& states) const {
+    drawRange(target, 0, wallCount, states);
+}
+
+void WallRenderer::drawRange(sf::RenderTarget& target, size_t first, size_t count, const sf::RenderStates& states) const {
+    if (first >= wallCount) return;
+    count = std::min(count, wallCount - first);
+    if (count == 0) return;
+    if (useVbo) target.draw(vbo, first * VERTS_PER_WALL, count * VERTS_PER_WALL, states);
+    else target.draw(&vertices[first * VERTS_PER_WALL], count * VERTS_PER_WALL, sf::Triangles, states);
+}
+
+void WallRenderer::drawStatic(sf::RenderTarget& target, const sf::FloatRect& region, const sf::RenderStates& states) const {
+    staticScratch.clear();
+    for (size_t i = 0; i < wallCount; ++i) {
+        if (!inStaticLayer[i] || !keyBounds(keys[i]).intersects(region)) continue;
+        size_t start = staticScratch.size();
+        staticScratch.resize(start + VERTS_PER_WALL);
+        buildWallGeometry(keys[i], &staticScratch[start]);
+    }
+    if (!staticScratch.empty()) target.draw(staticScratch.data(), staticScratch.size(), sf::Triangles, states);
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <vector>
+#include "../Physics/PhysicsWorld.hpp"
+
+// --- RENDER DE PAREDES EN LOTE ---
+// Antes: un RectangleShape/ConvexShape nuevo por pared y por frame, con su draw call.
+// Ahora: todas las paredes (relleno + borde neón) viven en un único VertexBuffer
+// en la GPU, un tramo fijo de vértices por pared. Cada frame se compara lo que
+// se va a dibujar (pos, ángulo, tamaño, colores, grosor) contra lo que ya está
+// subido y solo se re-suben los tramos que cambiaron. Paredes quietas = cero bytes.
+// Dibujar todas es UN draw call.
+//
+// Capa estática: las paredes que no se animan (sin flash, ni pincho, ni móvil, ni
+// expansible, ni dañada) no van al VBO sino a una textura retenida que arma el
+// SceneRenderer junto con la grilla. Acá solo se anota qué región de esa capa quedó
+// vieja (pared editada, que flashea o que se destruyó) para redibujar nada más eso.
+
+class WallRenderer {
+public:
+    WallRenderer();
+
+    // Recalcula colores/geometría y sube a la GPU solo lo que cambió
+    void update(const SlotMap<CustomWall>& walls, float scale, float globalTime);
+    void draw(sf::RenderTarget& target, const sf::RenderStates& states = sf::RenderStates::Default) const;
+    // Solo las paredes [first, first + count) en orden denso (para intercalar overlays)
+    void drawRange(sf::RenderTarget& target, size_t first, size_t count,
+                   const sf::RenderStates& states = sf::RenderStates::Default) const;
+
+    // ¿Va a la capa estática? (se ve igual frame a frame)
+    static bool isStaticWall(const CustomWall& wall);
+
+    // Regiones (en píxeles lógicos) de la capa estática que hay que redibujar desde
+    // el último take. Las saca y deja la lista vacía.
+    bool takeStaticDirty(std::vector<sf::FloatRect>& out);
+
+    // Dibuja las paredes de la capa estática que tocan la región (el recorte lo pone el target)
+    void drawStatic(sf::RenderTarget& target, const sf::FloatRect& region,
+                    const sf::RenderStates& states = sf::RenderStates::Default) const;
+
+    // Estadística del último update (para debug/profiler)
+    size_t getLastDirtyCount() const { return lastDirtyCount; }
+
+    // Vértices por pared: relleno (hasta 2 triángulos) + borde (hasta 4 lados x 2 triángulos)
+    static constexpr size_t VERTS_PER_WALL = 6 + 4 * 6;
+
+private:
+    // Todo lo que define cómo se ve una pared. Si no cambia, su tramo en la GPU tampoco.
+    struct DrawKey {
+        float x = 0.0f, y = 0.0f, angle = 0.0f;
+        float width = 0.0f, height = 0.0f;
+        float thickness = 0.0f;
+        int shapeType = -1;
+        sf::Color fill, outline;
+
+        bool operator==(const DrawKey& o) const;
+    };
+
+    void buildWallGeometry(const DrawKey& key, sf::Vertex* out) const;
+    void ensureCapacity(size_t wallCount);
+    static sf::FloatRect keyBounds(const DrawKey& key);
+    void addStaticDirty(const sf::FloatRect& rect);
+
+    std::vector<sf::Vertex> vertices; // Copia en CPU (y fallback si no hay VBO)
+    std::vector<DrawKey> keys;
+    std::vector<char> dirty;
+    std::vector<char> inStaticLayer; // El tramo está vacío en el VBO y la pared vive en la capa
+    std::vector<sf::FloatRect> staticDirty;
+    mutable std::vector<sf::Vertex> staticScratch;
+    size_t wallCount = 0;
+    size_t lastDirtyCount = 0;
+
+    sf::VertexBuffer vbo;
+    bool useVbo = false;
+    size_t vboCapacity = 0; // En paredes
+};
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <box2d/box2d.h>
+#include <cstdint>
+#include "SlotMap.hpp"
+
+// --- ETIQUETA DE ENTIDAD EN EL b2Body ---
+// Cada cuerpo que creamos lleva en su userData qué es (pared, racer, cuchillo, meta)
+// y su slot en el contenedor correspondiente. Así pasar de b2Body* a entidad es O(1)
+// en vez de recorrer todas las paredes por cada contacto.
+
+enum class EntityKind : uint8_t { None = 0, Wall, Racer, Knife, WinZone };
+
+struct EntityHandle {
+    EntityKind kind = EntityKind::None;
+    uint32_t index = 0;      // Slot (paredes/cuchillos) o índice fijo (racers)
+    uint32_t generation = 0; // Solo para slots; en racers queda en 0
+
+    SlotHandle slot() const { return {index, generation}; }
+};
+
+static_assert(sizeof(uintptr_t) >= 8, "El tag de entidad necesita userData de 64 bits");
+
+// Empaquetado: [generación 24 bits][índice 32 bits][tipo 8 bits].
+// El SlotMap ya da la vuelta a sus generaciones en 24 bits: no se pierde nada.
+// Un userData en 0 (cuerpo sin etiquetar) se lee como EntityKind::None.
+static_assert(SlotHandle::GenerationMask == 0xFFFFFFu, "La etiqueta guarda generaciones de 24 bits");
+
+inline void tagBody(b2Body* body, EntityKind kind, uint32_t index, uint32_t generation = 0) {
+    body->GetUserData().pointer = ((uintptr_t)(generation & SlotHandle::GenerationMask) << 40)
+                                | ((uintptr_t)index << 8)
+                                | (uintptr_t)kind;
+}
+
+inline void tagBody(b2Body* body, EntityKind kind, SlotHandle handle) {
+    tagBody(body, kind, handle.index, handle.generation);
+}
+
+inline EntityHandle unpackBodyTag(uintptr_t packed) {
+    return { (EntityKind)(packed & 0xFF),
+             (uint32_t)((packed >> 8) & 0xFFFFFFFFu),
+             (uint32_t)((packed >> 40) & SlotHandle::GenerationMask) };
+}
+
+inline EntityHandle getBodyTag(const b2Body* body) {
+    return unpackBodyTag(body->GetUserData().pointer);
+}
+
+// Orden estable para sets de cuerpos. Ordenar por b2Body* depende de dónde cayó cada
+// cuerpo en el heap: dos corridas con la misma semilla recorrían el set en distinto
+// orden y el caos le tiraba los dados a otro racer. La etiqueta es igual en toda corrida.
+struct BodyTagLess {
+    bool operator()(const b2Body* a, const b2Body* b) const {
+        return a->GetUserData().pointer < b->GetUserData().pointer;
+    }
+};
@@ -0,0 +1,456 @@
+#include "MapFile.hpp"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <type_traits>
+
+// --- TEXTO ---
+
+bool parseMapText(const std::string& text, MapData& out) {
+    out = MapData();
+    std::istringstream file(text);
+    int linesWithExtraFields = 0;
+
+    std::string line;
+    while (std::getline(file, line)) {
+        std::stringstream ss(line);
+        std::string type;
+        ss >> type;
+
+        if (type == "CONFIG") {
+            out.hasConfig = true;
+            ss >> out.targetSpeed >> out.racerSize >> out.restitution >> out.enableChaos;
+            bool stopFW;
+            out.stopOnFirstWin = (ss >> stopFW) ? stopFW : true; // Retrocompatibilidad
+        }
+        else if (type == "WINZONE") {
+            out.hasWinZone = true;
+            ss >> out.winZonePos[0] >> out.winZonePos[1] >> out.winZoneSize[0] >> out.winZoneSize[1];
+            bool hasGlow;
+            out.winZoneGlow = (ss >> hasGlow) ? hasGlow : true;
+        }
+        else if (type == "WALL") {
+            MapWall w;
+            ss >> w.x >> w.y >> w.width >> w.height >> w.soundID;
+
+            // Cada bloque es opcional: los mapas viejos cortan antes
+            int cIdx;
+            if (ss >> cIdx) w.colorIndex = cIdx;
+
+            if (ss >> w.isExpandable) {
+                ss >> w.expansionDelay >> w.expansionSpeed >> w.expansionAxis
+                   >> w.stopOnContact >> w.stopTarget >> w.maxSize;
+            }
+
+            if (ss >> w.shapeType) {
+                if (ss >> w.rotation) ss >> w.isDeadly;
+
+                if (ss >> w.isMoving) {
+                    ss >> w.pointA[0] >> w.pointA[1] >> w.pointB[0] >> w.pointB[1] >> w.moveSpeed;
+                    if (ss >> w.reverseOnContact) ss >> w.freeBounce;
+                }
+
+                if (ss >> w.isDestructible) {
+                    int mHits, cHits;
+                    if (ss >> mHits >> cHits) {
+                        w.maxHits = mHits;
+                        w.currentHits = cHits;
+                    }
+                    ss >> w.useTextForHP;
+                }
+            }
+
+            std::string extra;
+            if (ss.clear(), ss >> extra) linesWithExtraFields++;
+            out.walls.push_back(w);
+        }
+        else if (type == "KNIFE") {
+            MapKnife k;
+            ss >> k.x >> k.y;
+            out.knives.push_back(k);
+        }
+        else if (type == "RACER") {
+            MapRacer r;
+            ss >> r.id >> r.x >> r.y >> r.vx >> r.vy >> r.angle >> r.angularVelocity;
+            out.racers.push_back(r);
+        }
+    }
+
+    if (linesWithExtraFields > 0) {
+        // Campos que este build no conoce: se ignoran, pero que no pase callado
+        std::cerr << "[MAP] " << linesWithExtraFields << " WALL con campos de mas (se ignoran)" << std::endl;
+    }
+    return true;
+}
+
+std::string writeMapText(const MapData& map, bool exactFloats) {
+    std::ostringstream file;
+    if (exactFloats) file << std::setprecision(9); // max_digits10 de float
+
+    if (map.hasConfig) {
+        file << "CONFIG " << map.targetSpeed << " " << map.racerSize << " "
+             << map.restitution << " " << map.enableChaos << " " << map.stopOnFirstWin << "\n";
+    }
+    if (map.hasWinZone) {
+        file << "WINZONE " << map.winZonePos[0] << " " << map.winZonePos[1] << " "
+             << map.winZoneSize[0] << " " << map.winZoneSize[1] << " " << map.winZoneGlow << "\n";
+    }
+
+    for (const auto& w : map.walls) {
+        // Todo en una sola línea. El orden es importante para el load.
+        file << "WALL "
+             << w.x << " " << w.y << " "
+             << w.width << " " << w.height << " "
+             << w.soundID << " "
+             << w.colorIndex << " " // -1 (el del sonido) también: el parser lo acepta
+             << w.isExpandable << " "
+             << w.expansionDelay << " "
+             << w.expansionSpeed << " "
+             << w.expansionAxis << " "
+             << w.stopOnContact << " "
+             << w.stopTarget << " "
+             << w.maxSize << " "
+             << w.shapeType << " "
+             << w.rotation << " "
+             << w.isDeadly << " "
+             << w.isMoving << " "
+             << w.pointA[0] << " " << w.pointA[1] << " "
+             << w.pointB[0] << " " << w.pointB[1] << " "
+             << w.moveSpeed << " "
+             << w.reverseOnContact << " "
+             << w.freeBounce << " "
+             << w.isDestructible << " "
+             << w.maxHits << " "
+             << w.currentHits << " "
+             << w.useTextForHP << "\n";
+    }
+
+    for (const auto& k : map.knives) {
+        file << "KNIFE " << k.x << " " << k.y << "\n";
+    }
+
+    for (const auto& r : map.racers) {
+        file << "RACER " << r.id << " "
+             << r.x << " " << r.y << " "
+             << r.vx << " " << r.vy << " "
+             << r.angle << " " << r.angularVelocity << "\n";
+    }
+    return file.str();
+}
+
+// --- BINARIO ---
+// Little-endian, todo de 4 bytes y cada sección alineada a 8.
+//   FileHeader | SectionEntry[sectionCount] | secciones
+// Una sección es count registros de recordSize bytes. Si el archivo trae registros más
+// largos que los de acá se lee el prefijo; si trae más cortos, el resto queda en default.
+
+namespace {
+
+struct FileHeader {
+    char magic[8];      // "CHAOSMAP"
+    uint32_t byteOrder; // 0x01020304 escrito nativo: si se lee dado vuelta, es de otra endianness
+    uint32_t version;
+    uint32_t headerSize;
+    uint32_t sectionCount;
+};
+
+struct SectionEntry {
+    uint32_t id;
+    uint32_t offset;
+    uint32_t count;
+    uint32_t recordSize;
+};
+
+constexpr uint32_t fourCC(char a, char b, char c, char d) {
+    return (uint32_t)(uint8_t)a | ((uint32_t)(uint8_t)b << 8) | ((uint32_t)(uint8_t)c << 16) | ((uint32_t)(uint8_t)d << 24);
+}
+
+constexpr char MagicBytes[8] = {'C', 'H', 'A', 'O', 'S', 'M', 'A', 'P'};
+constexpr uint32_t ByteOrderMark = 0x01020304u;
+constexpr uint32_t SectionConfig = fourCC('C', 'O', 'N', 'F');
+constexpr uint32_t SectionWinZone = fourCC('W', 'I', 'N', 'Z');
+constexpr uint32_t SectionWalls = fourCC('W', 'A', 'L', 'L');
+constexpr uint32_t SectionKnives = fourCC('K', 'N', 'I', 'F');
+constexpr uint32_t SectionRacers = fourCC('R', 'A', 'C', 'R');
+
+// --- REGISTROS EN DISCO (v1) ---
+// Los campos nuevos van SIEMPRE al final. Cambiar o sacar uno = subir MapBinaryVersion.
+
+struct ConfigRecord {
+    enum : uint32_t { Chaos = 1u << 0, StopOnFirstWin = 1u << 1 };
+    float targetSpeed, racerSize, restitution;
+    uint32_t flags;
+};
+
+struct WinZoneRecord {
+    enum : uint32_t { Glow = 1u << 0 };
+    float x, y, width, height;
+    uint32_t flags;
+};
+
+struct WallRecord {
+    enum : uint32_t {
+        Expandable = 1u << 0, StopOnContact = 1u << 1, Deadly = 1u << 2, Moving = 1u << 3,
+        ReverseOnContact = 1u << 4, FreeBounce = 1u << 5, Destructible = 1u << 6, TextForHP = 1u << 7
+    };
+    float x, y, width, height;
+    int32_t soundID, colorIndex;
+    float expansionDelay, expansionSpeed;
+    int32_t expansionAxis, stopTarget;
+    float maxSize;
+    int32_t shapeType;
+    float rotation;
+    float pointA[2], pointB[2];
+    float moveSpeed;
+    int32_t maxHits, currentHits;
+    uint32_t flags;
+};
+
+struct KnifeRecord {
+    float x, y;
+};
+
+struct RacerRecord {
+    int32_t id;
+    float x, y, vx, vy, angle, angularVelocity;
+};
+
+static_assert(sizeof(FileHeader) == 24 && sizeof(SectionEntry) == 16, "Cabecera con padding");
+static_assert(sizeof(ConfigRecord) == 16 && sizeof(WinZoneRecord) == 20, "Registro con padding");
+static_assert(sizeof(WallRecord) == 84 && sizeof(KnifeRecord) == 8 && sizeof(RacerRecord) == 28, "Registro con padding");
+
+uint32_t flag(bool value, uint32_t bit) { return value ? bit : 0u; }
+
+ConfigRecord toRecord(const MapData& m) {
+    return {m.targetSpeed, m.racerSize, m.restitution,
+            flag(m.enableChaos, ConfigRecord::Chaos) | flag(m.stopOnFirstWin, ConfigRecord::StopOnFirstWin)};
+}
+
+WinZoneRecord toWinZoneRecord(const MapData& m) {
+    return {m.winZonePos[0], m.winZonePos[1], m.winZoneSize[0], m.winZoneSize[1],
+            flag(m.winZoneGlow, WinZoneRecord::Glow)};
+}
+
+WallRecord toRecord(const MapWall& w) {
+    WallRecord r;
+    r.x = w.x; r.y = w.y; r.width = w.width; r.height = w.height;
+    r.soundID = w.soundID; r.colorIndex = w.colorIndex;
+    r.expansionDelay = w.expansionDelay; r.expansionSpeed = w.expansionSpeed;
+    r.expansionAxis = w.expansionAxis; r.stopTarget = w.stopTarget; r.maxSize = w.maxSize;
+    r.shapeType = w.shapeType; r.rotation = w.rotation;
+    r.pointA[0] = w.pointA[0]; r.pointA[1] = w.pointA[1];
+    r.pointB[0] = w.pointB[0]; r.pointB[1] = w.pointB[1];
+    r.moveSpeed = w.moveSpeed;
+    r.maxHits = w.maxHits; r.currentHits = w.currentHits;
+    r.flags = flag(w.isExpandable, WallRecord::Expandable) | flag(w.stopOnContact, WallRecord::StopOnContact)
+            | flag(w.isDeadly, WallRecord::Deadly) | flag(w.isMoving, WallRecord::Moving)
+            | flag(w.reverseOnContact, WallRecord::ReverseOnContact) | flag(w.freeBounce, WallRecord::FreeBounce)
+            | flag(w.isDestructible, WallRecord::Destructible) | flag(w.useTextForHP, WallRecord::TextForHP);
+    return r;
+}
+
+MapWall fromRecord(const WallRecord& r) {
+    MapWall w;
+    w.x = r.x; w.y = r.y; w.width = r.width; w.height = r.height;
+    w.soundID = r.soundID; w.colorIndex = r.colorIndex;
+    w.isExpandable = r.flags & WallRecord::Expandable;
+    w.expansionDelay = r.expansionDelay; w.expansionSpeed = r.expansionSpeed;
+    w.expansionAxis = r.expansionAxis;
+    w.stopOnContact = r.flags & WallRecord::StopOnContact;
+    w.stopTarget = r.stopTarget; w.maxSize = r.maxSize;
+    w.shapeType = r.shapeType; w.rotation = r.rotation;
+    w.isDeadly = r.flags & WallRecord::Deadly;
+    w.isMoving = r.flags & WallRecord::Moving;
+    w.pointA[0] = r.pointA[0]; w.pointA[1] = r.pointA[1];
+    w.pointB[0] = r.pointB[0]; w.pointB[1] = r.pointB[1];
+    w.moveSpeed = r.moveSpeed;
+    w.reverseOnContact = r.flags & WallRecord::ReverseOnContact;
+    w.freeBounce = r.flags & WallRecord::FreeBounce;
+    w.isDestructible = r.flags & WallRecord::Destructible;
+    w.maxHits = r.maxHits; w.currentHits = r.currentHits;
+    w.useTextForHP = r.flags & WallRecord::TextForHP;
+    return w;
+}
+
+// Lee el registro i de la sección arrancando de 'record' (que ya trae los defaults)
+template <typename T>
+void readRecord(const unsigned char* bytes, const SectionEntry& s, uint32_t i, T& record) {
+    std::memcpy(&record, bytes + s.offset + (size_t)i * s.recordSize, std::min<size_t>(s.recordSize, sizeof(T)));
+}
+
+} // namespace
+
+bool isBinaryMap(const void* data, size_t size) {
+    return size >= sizeof(MagicBytes) && std::memcmp(data, MagicBytes, sizeof(MagicBytes)) == 0;
+}
+
+bool parseMapBinary(const void* data, size_t size, MapData& out) {
+    out = MapData();
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+
+    FileHeader header;
+    if (size < sizeof(header) || !isBinaryMap(data, size)) {
+        std::cerr << "[MAP] No es un mapa binario" << std::endl;
+        return false;
+    }
+    std::memcpy(&header, bytes, sizeof(header));
+    if (header.byteOrder != ByteOrderMark) {
+        std::cerr << "[MAP] Mapa binario de otra endianness" << std::endl;
+        return false;
+    }
+    if (header.version != MapBinaryVersion) {
+        std::cerr << "[MAP] Mapa binario version " << header.version << " (este build lee la "
+                  << MapBinaryVersion << "): reconvertilo desde el .txt" << std::endl;
+        return false;
+    }
+    if (header.headerSize < sizeof(header)
+        || (uint64_t)header.headerSize + (uint64_t)header.sectionCount * sizeof(SectionEntry) > size) {
+        std::cerr << "[MAP] Cabecera de mapa binario trucha" << std::endl;
+        return false;
+    }
+
+    // Primero se valida la tabla entera: o se lee todo el mapa o nada
+    std::vector<SectionEntry> sections(header.sectionCount);
+    for (uint32_t i = 0; i < header.sectionCount; ++i) {
+        SectionEntry& s = sections[i];
+        std::memcpy(&s, bytes + header.headerSize + (size_t)i * sizeof(SectionEntry), sizeof(SectionEntry));
+        uint64_t end = (uint64_t)s.offset + (uint64_t)s.count * s.recordSize;
+        if ((s.count > 0 && s.recordSize == 0) || end > size) {
+            std::cerr << "[MAP] Seccion fuera del archivo (mapa cortado?)" << std::endl;
+            return false;
+        }
+    }
+
+    for (const SectionEntry& s : sections) {
+        if (s.id == SectionConfig && s.count > 0) {
+            ConfigRecord r = toRecord(out);
+            readRecord(bytes, s, 0, r);
+            out.hasConfig = true;
+            out.targetSpeed = r.targetSpeed;
+            out.racerSize = r.racerSize;
+            out.restitution = r.restitution;
+            out.enableChaos = r.flags & ConfigRecord::Chaos;
+            out.stopOnFirstWin = r.flags & ConfigRecord::StopOnFirstWin;
+        }
+        else if (s.id == SectionWinZone && s.count > 0) {
+            WinZoneRecord r = toWinZoneRecord(out);
+            readRecord(bytes, s, 0, r);
+            out.hasWinZone = true;
+            out.winZonePos[0] = r.x;
+            out.winZonePos[1] = r.y;
+            out.winZoneSize[0] = r.width;
+            out.winZoneSize[1] = r.height;
+            out.winZoneGlow = r.flags & WinZoneRecord::Glow;
+        }
+        else if (s.id == SectionWalls) {
+            const WallRecord defaults = toRecord(MapWall());
+            out.walls.reserve(s.count);
+            for (uint32_t i = 0; i < s.count; ++i) {
+                WallRecord r = defaults;
+                readRecord(bytes, s, i, r);
+                out.walls.push_back(fromRecord(r));
+            }
+        }
+        else if (s.id == SectionKnives) {
+            out.knives.reserve(s.count);
+            for (uint32_t i = 0; i < s.count; ++i) {
+                KnifeRecord r = {0.0f, 0.0f};
+                readRecord(bytes, s, i, r);
+                out.knives.push_back({r.x, r.y});
+            }
+        }
+        else if (s.id == SectionRacers) {
+            out.racers.reserve(s.count);
+            for (uint32_t i = 0; i < s.count; ++i) {
+                RacerRecord r = {0, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+                readRecord(bytes, s, i, r);
+                out.racers.push_back({r.id, r.x, r.y, r.vx, r.vy, r.angle, r.angularVelocity});
+            }
+        }
+        // Sección desconocida: de una versión más nueva que agregó algo, se saltea
+    }
+    return true;
+}
+
+std::string writeMapBinary(const MapData& map) {
+    std::vector<ConfigRecord> config;
+    std::vector<WinZoneRecord> winZone;
+    std::vector<WallRecord> walls;
+    std::vector<KnifeRecord> knives;
+    std::vector<RacerRecord> racers;
+
+    if (map.hasConfig) config.push_back(toRecord(map));
+    if (map.hasWinZone) winZone.push_back(toWinZoneRecord(map));
+    walls.reserve(map.walls.size());
+    for (const auto& w : map.walls) walls.push_back(toRecord(w));
+    for (const auto& k : map.knives) knives.push_back({k.x, k.y});
+    for (const auto& r : map.racers) racers.push_back({r.id, r.x, r.y, r.vx, r.vy, r.angle, r.angularVelocity});
+
+    std::vector<SectionEntry> sections;
+    std::vector<const void*> payloads;
+    auto addSection = [&](uint32_t id, const auto& records) {
+        using Record = typename std::decay_t<decltype(records)>::value_type;
+        sections.push_back({id, 0, (uint32_t)records.size(), (uint32_t)sizeof(Record)});
+        payloads.push_back(records.data());
+    };
+    addSection(SectionConfig, config);
+    addSection(SectionWinZone, winZone);
+    addSection(SectionWalls, walls);
+    addSection(SectionKnives, knives);
+    addSection(SectionRacers, racers);
+
+    FileHeader header;
+    std::memcpy(header.magic, MagicBytes, sizeof(MagicBytes));
+    header.byteOrder = ByteOrderMark;
+    header.version = MapBinaryVersion;
+    header.headerSize = sizeof(FileHeader);
+    header.sectionCount = (uint32_t)sections.size();
+
+    auto align8 = [](size_t n) { return (n + 7) & ~(size_t)7; };
+    size_t cursor = align8(sizeof(FileHeader) + sections.size() * sizeof(SectionEntry));
+    for (auto& s : sections) {
+        s.offset = (uint32_t)cursor;
+        cursor = align8(cursor + (size_t)s.count * s.recordSize);
+    }
+
+    std::string bytes(cursor, '\0');
+    std::memcpy(&bytes[0], &header, sizeof(header));
+    std::memcpy(&bytes[sizeof(header)], sections.data(), sections.size() * sizeof(SectionEntry));
+    for (size_t i = 0; i < sections.size(); ++i) {
+        if (sections[i].count > 0) {
+            std::memcpy(&bytes[sections[i].offset], payloads[i], (size_t)sections[i].count * sections[i].recordSize);
+        }
+    }
+    return bytes;
+}
+
+// --- ARCHIVOS ---
+
+bool readMapFile(const std::string& filename, MapData& out) {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Map not found: " << filename << std::endl;
+        return false;
+    }
+
+    std::string bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (isBinaryMap(bytes.data(), bytes.size())) return parseMapBinary(bytes.data(), bytes.size(), out);
+    return parseMapText(bytes, out);
+}
+
+bool writeMapFile(const std::string& filename, const MapData& map, bool binary) {
+    std::ofstream file(filename, binary ? std::ios::binary : std::ios::out);
+    if (!file.is_open()) return false;
+
+    file << (binary ? writeMapBinary(map) : writeMapText(map));
+    return (bool)file;
+}
+
+bool hasBinaryMapExtension(const std::string& filename) {
+    const std::string ext = MapBinaryExtension;
+    return filename.size() >= ext.size() && filename.compare(filename.size() - ext.size(), ext.size(), ext) == 0;
+}
@@ -0,0 +1,195 @@
+#include "ParticlePool.hpp"
+#include <cstdint>
+
+#if defined(__AVX__)
+    #include <immintrin.h>
+    #define CHAOS_PARTICLES_AVX 1
+#elif defined(__SSE2__) || defined(_M_X64)
+    #include <emmintrin.h>
+    #define CHAOS_PARTICLES_SSE2 1
+#endif
+
+namespace {
+
+// Los vértices de SFML son AoS (posición, color, texCoords): la cuenta va en SIMD
+// y acá solo desparramamos cada carril a su quad.
+inline void writeQuad(sf::Vertex* v, float x0, float y0, float x1, float y1, sf::Color c) {
+    v[0].position = sf::Vector2f(x0, y0);
+    v[1].position = sf::Vector2f(x1, y0);
+    v[2].position = sf::Vector2f(x1, y1);
+    v[3].position = sf::Vector2f(x0, y1);
+    v[0].color = c;
+    v[1].color = c;
+    v[2].color = c;
+    v[3].color = c;
+}
+
+}
+
+const char* ParticlePool::kernelName() {
+#if defined(CHAOS_PARTICLES_AVX)
+    return "avx";
+#elif defined(CHAOS_PARTICLES_SSE2)
+    return "sse2";
+#else
+    return "scalar";
+#endif
+}
+
+ParticlePool::ParticlePool(size_t capacity) {
+    setCapacity(capacity);
+}
+
+void ParticlePool::setCapacity(size_t newCapacity) {
+    cap = newCapacity;
+    if (count > cap) count = cap;
+
+    px.resize(cap); py.resize(cap);
+    vx.resize(cap); vy.resize(cap);
+    lifeLeft.resize(cap);
+    invLife.resize(cap);
+    colors.resize(cap);
+    vertices.reserve(cap * 4);
+    if (vertices.size() > count * 4) vertices.resize(count * 4);
+}
+
+bool ParticlePool::spawn(sf::Vector2f position, sf::Vector2f velocity, sf::Color color, float life) {
+    if (count >= cap || life <= 0.0f) return false;
+
+    size_t i = count++;
+    px[i] = position.x;
+    py[i] = position.y;
+    vx[i] = velocity.x;
+    vy[i] = velocity.y;
+    lifeLeft[i] = life;
+    invLife[i] = 1.0f / life;
+    colors[i] = color;
+    return true;
+}
+
+void ParticlePool::removeAt(size_t i) {
+    size_t last = --count;
+    if (i == last) return;
+    px[i] = px[last];
+    py[i] = py[last];
+    vx[i] = vx[last];
+    vy[i] = vy[last];
+    lifeLeft[i] = lifeLeft[last];
+    invLife[i] = invLife[last];
+    colors[i] = colors[last];
+}
+
+void ParticlePool::step(float dt, float gravity, bool useSimd) {
+    // 1. Compactación ANTES de integrar: las que no sobreviven este dt se van ya,
+    // así el kernel de abajo recorre solo vivas y no tiene ni una rama.
+    // De atrás para adelante: lo que llega al hueco ya fue revisado.
+    for (size_t i = count; i-- > 0; ) {
+        if (lifeLeft[i] - dt <= 0.0f) removeAt(i);
+    }
+
+    const size_t n = count;
+    vertices.resize(n * 4); // Nunca realoca: reservado a cap*4
+
+    float* __restrict x = px.data();
+    float* __restrict y = py.data();
+    float* __restrict velX = vx.data();
+    float* __restrict velY = vy.data();
+    float* __restrict l = lifeLeft.data();
+    const float* __restrict inv = invLife.data();
+    const sf::Color* col = colors.data();
+    sf::Vertex* out = vertices.data();
+
+    const float h = quadHalfSize;
+    const float gdt = gravity * dt;
+    size_t i = 0;
+
+    // 2. Kernel: integra (pos += vel*dt con la velocidad vieja, después gravedad),
+    // baja la vida, calcula alpha y esquinas del quad. Todo en una pasada.
+#if defined(CHAOS_PARTICLES_AVX)
+    if (useSimd) {
+        const __m256 vdt = _mm256_set1_ps(dt);
+        const __m256 vgdt = _mm256_set1_ps(gdt);
+        const __m256 vh = _mm256_set1_ps(h);
+        const __m256 v255 = _mm256_set1_ps(255.0f);
+        alignas(32) float x0[8], x1[8], y0[8], y1[8];
+        alignas(32) int32_t alpha[8];
+
+        for (; i + 8 <= n; i += 8) {
+            __m256 lv = _mm256_sub_ps(_mm256_loadu_ps(l + i), vdt);
+            __m256 vxv = _mm256_loadu_ps(velX + i);
+            __m256 vyv = _mm256_loadu_ps(velY + i);
+            __m256 xv = _mm256_add_ps(_mm256_loadu_ps(x + i), _mm256_mul_ps(vxv, vdt));
+            __m256 yv = _mm256_add_ps(_mm256_loadu_ps(y + i), _mm256_mul_ps(vyv, vdt));
+            vyv = _mm256_add_ps(vyv, vgdt);
+
+            _mm256_storeu_ps(l + i, lv);
+            _mm256_storeu_ps(x + i, xv);
+            _mm256_storeu_ps(y + i, yv);
+            _mm256_storeu_ps(velY + i, vyv);
+
+            __m256 a = _mm256_mul_ps(_mm256_mul_ps(lv, _mm256_loadu_ps(inv + i)), v255);
+            _mm256_store_si256((__m256i*)alpha, _mm256_cvttps_epi32(a));
+            _mm256_store_ps(x0, _mm256_sub_ps(xv, vh));
+            _mm256_store_ps(x1, _mm256_add_ps(xv, vh));
+            _mm256_store_ps(y0, _mm256_sub_ps(yv, vh));
+            _mm256_store_ps(y1, _mm256_add_ps(yv, vh));
+
+            for (int k = 0; k < 8; ++k) {
+                sf::Color c = col[i + k];
+                c.a = (sf::Uint8)alpha[k];
+                writeQuad(out + (i + k) * 4, x0[k], y0[k], x1[k], y1[k], c);
+            }
+        }
+    }
+#elif defined(CHAOS_PARTICLES_SSE2)
+    if (useSimd) {
+        const __m128 vdt = _mm_set1_ps(dt);
+        const __m128 vgdt = _mm_set1_ps(gdt);
+        const __m128 vh = _mm_set1_ps(h);
+        const __m128 v255 = _mm_set1_ps(255.0f);
+        alignas(16) float x0[4], x1[4], y0[4], y1[4];
+        alignas(16) int32_t alpha[4];
+
+        for (; i + 4 <= n; i += 4) {
+            __m128 lv = _mm_sub_ps(_mm_loadu_ps(l + i), vdt);
+            __m128 vxv = _mm_loadu_ps(velX + i);
+            __m128 vyv = _mm_loadu_ps(velY + i);
+            __m128 xv = _mm_add_ps(_mm_loadu_ps(x + i), _mm_mul_ps(vxv, vdt));
+            __m128 yv = _mm_add_ps(_mm_loadu_ps(y + i), _mm_mul_ps(vyv, vdt));
+            vyv = _mm_add_ps(vyv, vgdt);
+
+            _mm_storeu_ps(l + i, lv);
+            _mm_storeu_ps(x + i, xv);
+            _mm_storeu_ps(y + i, yv);
+            _mm_storeu_ps(velY + i, vyv);
+
+            __m128 a = _mm_mul_ps(_mm_mul_ps(lv, _mm_loadu_ps(inv + i)), v255);
+            _mm_store_si128((__m128i*)alpha, _mm_cvttps_epi32(a));
+            _mm_store_ps(x0, _mm_sub_ps(xv, vh));
+            _mm_store_ps(x1, _mm_add_ps(xv, vh));
+            _mm_store_ps(y0, _mm_sub_ps(yv, vh));
+            _mm_store_ps(y1, _mm_add_ps(yv, vh));
+
+            for (int k = 0; k < 4; ++k) {
+                sf::Color c = col[i + k];
+                c.a = (sf::Uint8)alpha[k];
+                writeQuad(out + (i + k) * 4, x0[k], y0[k], x1[k], y1[k], c);
+            }
+        }
+    }
+#else
+    (void)useSimd;
+#endif
+
+    // Cola escalar (y camino completo cuando no hay SIMD o se pide la referencia)
+    for (; i < n; ++i) {
+        l[i] -= dt;
+        x[i] += velX[i] * dt;
+        y[i] += velY[i] * dt;
+        velY[i] += gdt;
+
+        sf::Color c = col[i];
+        c.a = (sf::Uint8)(255.0f * (l[i] * inv[i]));
+        writeQuad(out + i * 4, x[i] - h, y[i] - h, x[i] + h, y[i] + h, c);
+    }
+}
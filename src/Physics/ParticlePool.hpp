@@ -0,0 +1,67 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <cstddef>
+#include <vector>
+
+// --- POOL DE PARTÍCULAS (SoA) ---
+// Cada campo vive en su propio arreglo contiguo y todo se reserva de entrada,
+// así spawnear no realoca y el loop de integración es aritmética pura sobre floats.
+// Las muertas se compactan con swap-remove: la última viva tapa el hueco,
+// O(1) por partícula, sin importar cuántas mueran juntas.
+// Si se llena, las nuevas se descartan: mejor perder chispas que frames.
+//
+// update() es un solo kernel SIMD (AVX si se compila con -mavx, si no SSE2,
+// si no escalar) que integra y de paso escribe los quads listos para dibujar
+// en un arreglo de vértices persistente. El render sube ese tramo vivo a su
+// VertexBuffer (una vez por frame) y lo dibuja: la física no toca GL.
+
+class ParticlePool {
+public:
+    explicit ParticlePool(size_t capacity = 8192);
+
+    // Cambia el tope. Si hay más vivas que el tope nuevo, se recortan las sobrantes.
+    void setCapacity(size_t newCapacity);
+    size_t capacity() const { return cap; }
+
+    // Medio lado del cuadradito en píxeles (depende de la resolución de render)
+    void setQuadHalfSize(float halfSizePx) { quadHalfSize = halfSizePx; }
+
+    // Devuelve false si el pool está lleno (la partícula se descarta)
+    bool spawn(sf::Vector2f position, sf::Vector2f velocity, sf::Color color, float life);
+
+    // Descarta las que no llegan vivas al final de este dt, integra y arma los quads
+    void update(float dt, float gravity) { step(dt, gravity, true); }
+    // Lo mismo sin SIMD: la referencia contra la que se compara el kernel (tests)
+    void updateScalar(float dt, float gravity) { step(dt, gravity, false); }
+    void clear() { count = 0; vertices.clear(); }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    // 4 vértices por partícula (sf::Quads), al día con el último update()
+    const std::vector<sf::Vertex>& quads() const { return vertices; }
+
+    // Acceso crudo (0..size()-1)
+    const float* posX() const { return px.data(); }
+    const float* posY() const { return py.data(); }
+    const float* life() const { return lifeLeft.data(); }
+
+    // Nombre del kernel compilado ("avx", "sse2" o "scalar"), para el log
+    static const char* kernelName();
+
+private:
+    size_t cap = 0;
+    size_t count = 0;
+    float quadHalfSize = 8.0f;
+
+    std::vector<float> px, py;
+    std::vector<float> vx, vy;
+    std::vector<float> lifeLeft;
+    std::vector<float> invLife; // 1/maxLife: el alpha sale con una multiplicación
+    std::vector<sf::Color> colors;
+    std::vector<sf::Vertex> vertices;
+
+    void removeAt(size_t i);
+    void step(float dt, float gravity, bool useSimd);
+};
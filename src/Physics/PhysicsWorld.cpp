@@ -51,6 +51,8 @@ if (dynamicBody && wallBody) {
         bodiesToCheck.insert(dynamicBody);
         wallsHit.insert(wallBody);
 
+        if (!recordCollisionEvents) return;
+
         // --- EXTRACCIÓN PARA PARTÍCULAS ---
         b2WorldManifold worldManifold;
         contact->GetWorldManifold(&worldManifold);
@@ -61,29 +63,68 @@ if (dynamicBody && wallBody) {
         // Box2D saca la normal siempre de A hacia B. 
         // Nosotros necesitamos que apunte DESDE la pared HACIA afuera.
         ev.normal = (bodyA == wallBody) ? worldManifold.normal : -worldManifold.normal; 
-        ev.racer = dynamicBody;
-        ev.wall = wallBody;
+        ev.racer = getBodyTag(dynamicBody);
+        ev.wall = getBodyTag(wallBody);
         
         collisionEvents.push_back(ev);
     }
 }
 
 PhysicsWorld::PhysicsWorld(float widthPixels, float heightPixels, SoundManager* soundMgr)
-    : world(b2Vec2(0.0f, 0.0f)) 
 {
-    rng.seed(77);
     this->soundManager = soundMgr;
 
     contactListener.soundManager = soundMgr;
     contactListener.worldWidth = widthPixels / SCALE;
-    world.SetContactListener(&contactListener);
 
     this->SCALE = widthPixels / 24.0f;
 
     worldWidthMeters = 24.0f;
     worldHeightMeters = heightPixels / this->SCALE;
 
-    createWalls(widthPixels, heightPixels);
+    rebuildWorld();
+}
+
+void PhysicsWorld::rebuildWorld() {
+    EditScope scope(*this);
+
+    // Los b2Body se van con el b2World viejo: acá solo vaciamos lo que los apuntaba.
+    // SlotMaps nuevos y no clear(): las generaciones también tienen que arrancar de cero,
+    // si no los handles del replay no coinciden con los de la grabación.
+    customWalls = SlotMap<CustomWall>();
+    knives = SlotMap<KnifeItem>();
+    dynamicBodies.clear();
+    winZoneBody = nullptr;
+    particles.clear();
+
+    contactListener.bodiesToCheck.clear();
+    contactListener.wallsHit.clear();
+    contactListener.bodiesReachedWinZone.clear();
+    contactListener.collisionEvents.clear();
+    contactListener.pendingPickups.clear();
+    contactListener.pendingKills.clear();
+    contactListener.winZoneBody = nullptr;
+
+    // Todo como recién construido (los racers nacen con targetSpeed y el tamaño actual)
+    applySettings(PhysicsSettings());
+    currentRacerSize = 1.0f;
+    currentRestitution = 1.0f;
+    currentFriction = 0.0f;
+    currentFixedRotation = true;
+    winZoneSize[0] = 2.0f;
+    winZoneSize[1] = 2.0f;
+    gameOver = false;
+    winnerIndex = -1;
+    currentNoteIndex = 0;
+    stepCount = 0;
+
+    world = std::make_unique<b2World>(b2Vec2(0.0f, 0.0f));
+    world->SetContactListener(&contactListener);
+
+    rng.seed(seed);
+    fxRng.seed(1337);
+
+    createWalls(worldWidthMeters * SCALE, worldHeightMeters * SCALE);
     createWinZone();
     createRacers();
 }
@@ -93,9 +134,41 @@ float PhysicsWorld::randomFloat(float min, float max) {
     return dist(rng);
 }
 
+void PhysicsWorld::setSeed(uint32_t newSeed) {
+    seed = newSeed;
+    rng.seed(seed);
+}
+
+float PhysicsWorld::fxRandomFloat(float min, float max) {
+    std::uniform_real_distribution<float> dist(min, max);
+    return dist(fxRng);
+}
+
+void PhysicsWorld::advance(float timeStep, int velIter, int posIter) {
+    if (isPaused || gameOver) return;
+    step(timeStep, velIter, posIter);
+    updateWallExpansion(timeStep);
+    updateMovingPlatforms(timeStep);
+}
+
 void PhysicsWorld::step(float timeStep, int velIter, int posIter) {
     if (isPaused || gameOver) return;
+    ProfileScope timer(profiler, ProfileStage::PhysicsStep);
+
+    pollSettings(); // Lo que el editor tocó a mano desde el step anterior
+    stepCount++;
 
+    simulateStep(timeStep, velIter, posIter);
+
+    // Golpes de este step (nota, flash, vida). Antes esto vivía en updateWallVisuals,
+    // una vez por FRAME: con varios steps por frame se juntaban golpes y la pared
+    // destructible se rompía en otro momento según los fps. Ahora es una vez por step y
+    // AL FINAL: el step que termina la carrera también aplica sus golpes (si no, el
+    // replay y la carrera en vivo quedaban un step corridos al cierre).
+    processWallHits();
+}
+
+void PhysicsWorld::simulateStep(float timeStep, int velIter, int posIter) {
     // --- BAJAR COOLDOWN DE LOS CUCHILLOS ---
     for (auto& k : knives) {
         if (k.cooldownTimer > 0.0f) {
@@ -103,13 +176,14 @@ void PhysicsWorld::step(float timeStep, int velIter, int posIter) {
         }
     }
 
-    world.SetGravity(enableGravity ? b2Vec2(0.0f, 9.8f) : b2Vec2(0.0f, 0.0f));
+    world->SetGravity(enableGravity ? b2Vec2(0.0f, 9.8f) : b2Vec2(0.0f, 0.0f));
     
     contactListener.bodiesToCheck.clear();
+    contactListener.recordCollisionEvents = visualFx;
     //contactListener.winnerBody = nullptr;
 
     // 1. Dejar que Box2D calcule rebotes y resuelva colisiones
-    world.Step(timeStep, velIter, posIter);
+    world->Step(timeStep, velIter, posIter);
 
     for (size_t i = 0; i < dynamicBodies.size(); ++i) {
         if (!racerStatus[i].isAlive) continue; // Si ya murió, next.
@@ -120,23 +194,23 @@ void PhysicsWorld::step(float timeStep, int velIter, int posIter) {
         for (b2ContactEdge* ce = racer->GetContactList(); ce; ce = ce->next) {
             if (!ce->contact->IsTouching()) continue;
 
-            // Obtenemos el otro cuerpo con el que choca
-            b2Body* other = ce->other;
-
-            // Chequeamos si ese "otro" es una pared nuestra
-            for (const auto& wall : customWalls) {
-                if (wall.body == other) {
-                    // SI ES MORTAL, CHAU RACER
-                    if (wall.isDeadly) {
-                        racerStatus[i].isAlive = false;
-                        racerStatus[i].deathPos = racer->GetPosition();
-                        racer->SetEnabled(false); // Lo sacamos de la simulación
-                        std::cout << ">>> RACER " << i << " MURIO EN PINCHOS <<<" << std::endl;
-                        
-                        // Opcional: Sonido de muerte o fx visual
-                    }
-                    break; // Ya encontramos la pared, salimos del loop de walls
-                }
+            // Chequeamos si el "otro" cuerpo es una pared nuestra (lookup directo por etiqueta)
+            EntityHandle other = getBodyTag(ce->other);
+            if (other.kind != EntityKind::Wall) continue;
+            const CustomWall* wall = customWalls.get(other.slot());
+
+            // SI ES MORTAL, CHAU RACER
+            if (wall && wall->isDeadly) {
+                racerStatus[i].isAlive = false;
+                racerStatus[i].deathPos = racer->GetPosition();
+                racerStatus[i].deathCause = DeathCause::Spike;
+                if (logEvents) std::cout << ">>> RACER " << i << " MURIO EN PINCHOS <<<" << std::endl;
+                
+                // Opcional: Sonido de muerte o fx visual
+
+                // SetEnabled(false) destruye la lista de contactos que estamos recorriendo: salimos ya
+                racer->SetEnabled(false); // Lo sacamos de la simulación
+                break;
             }
         }
     }
@@ -144,12 +218,7 @@ void PhysicsWorld::step(float timeStep, int velIter, int posIter) {
 // --- CHECK VICTORIA (CON DELAY) ---
     // 1. Detectar quién acaba de tocar la meta
     for (b2Body* winnerBody : contactListener.bodiesReachedWinZone) {
-        int wIndex = -1;
-        for (size_t i = 0; i < dynamicBodies.size(); ++i) {
-            if (dynamicBodies[i] == winnerBody) {
-                wIndex = i; break;
-            }
-        }
+        int wIndex = getRacerIndex(winnerBody);
 
         // Si tocó la meta, está vivo, no terminó, y NO estaba ya cruzando...
         if (wIndex != -1 && !racerStatus[wIndex].hasFinished && !racerStatus[wIndex].isFinishing && racerStatus[wIndex].isAlive) {
@@ -179,7 +248,7 @@ void PhysicsWorld::step(float timeStep, int velIter, int posIter) {
                 if (stopOnFirstWin && winnerIndex == (int)i) {
                     gameOver = true;
                     isPaused = true; 
-                    std::cout << ">>> VICTORY: RACER " << winnerIndex << " <<<" << std::endl;
+                    if (logEvents) std::cout << ">>> VICTORY: RACER " << winnerIndex << " <<<" << std::endl;
                     return;
                 }
             }
@@ -200,7 +269,7 @@ void PhysicsWorld::step(float timeStep, int velIter, int posIter) {
         if (!activeRacersLeft) {
             gameOver = true;
             isPaused = true;
-            std::cout << ">>> RACE FINISHED (No active racers left) <<<" << std::endl;
+            if (logEvents) std::cout << ">>> RACE FINISHED (No active racers left) <<<" << std::endl;
             return;
         }
     }
@@ -264,15 +333,15 @@ void PhysicsWorld::step(float timeStep, int velIter, int posIter) {
 // --- RESOLVER PICKUPS ---
     for (auto& ev : contactListener.pendingPickups) {
         int rIdx = getRacerIndex(ev.racer);
-        int kIdx = getKnifeIndex(ev.knife);
+        KnifeItem* knife = getKnife(ev.knife);
 
-        if (rIdx != -1 && kIdx != -1) {
+        if (rIdx != -1 && knife) {
             // ACÁ AGREGAMOS LA CONDICIÓN DEL COOLDOWN:
-            if (!racerStatus[rIdx].hasKnife && !knives[kIdx].isPickedUp && knives[kIdx].cooldownTimer <= 0.0f) {
+            if (!racerStatus[rIdx].hasKnife && !knife->isPickedUp && knife->cooldownTimer <= 0.0f) {
                 racerStatus[rIdx].hasKnife = true;
-                knives[kIdx].isPickedUp = true;
-                knives[kIdx].ownerIndex = rIdx;
-                knives[kIdx].body->SetEnabled(false); 
+                knife->isPickedUp = true;
+                knife->ownerIndex = rIdx;
+                knife->body->SetEnabled(false); 
             }
         }
     }
@@ -290,6 +359,8 @@ void PhysicsWorld::step(float timeStep, int velIter, int posIter) {
                 // Matamos a la víctima
                 racerStatus[victimIdx].isAlive = false;
                 racerStatus[victimIdx].deathPos = dynamicBodies[victimIdx]->GetPosition();
+                racerStatus[victimIdx].deathCause = DeathCause::Knife;
+                racerStatus[victimIdx].killerIndex = killerIdx;
                 dynamicBodies[victimIdx]->SetEnabled(false);
 
                 // El asesino suelta el cuchillo
@@ -314,35 +385,34 @@ void PhysicsWorld::step(float timeStep, int velIter, int posIter) {
 
 void PhysicsWorld::updateParticles(float dt) {
     if (isPaused) return;
+    ProfileScope timer(profiler, ProfileStage::Particles);
 
     // 1. SPAWN: Procesamos los choques de este frame
     for (auto& ev : contactListener.collisionEvents) {
         // Sacamos el color de la pared
         sf::Color wallColor = sf::Color::White;
-        for (const auto& w : customWalls) {
-            if (w.body == ev.wall) { wallColor = w.neonColor; break; }
+        if (ev.wall.kind == EntityKind::Wall) {
+            // Si la pared se rompió en este mismo frame el handle ya no resuelve: chispa blanca
+            if (const CustomWall* wall = customWalls.get(ev.wall.slot())) wallColor = wall->neonColor;
         }
 
         // Sacamos el color del racer por su índice
         sf::Color racerColor = sf::Color::White;
-        for (size_t i = 0; i < dynamicBodies.size(); ++i) {
-            if (dynamicBodies[i] == ev.racer) {
-                if (i == 0) racerColor = sf::Color(0, 255, 255);
-                else if (i == 1) racerColor = sf::Color(255, 0, 255);
-                else if (i == 2) racerColor = sf::Color(57, 255, 20);
-                else if (i == 3) racerColor = sf::Color(255, 215, 0);
-                break;
-            }
+        if (ev.racer.kind == EntityKind::Racer) {
+            uint32_t i = ev.racer.index;
+            if (i == 0) racerColor = sf::Color(0, 255, 255);
+            else if (i == 1) racerColor = sf::Color(255, 0, 255);
+            else if (i == 2) racerColor = sf::Color(57, 255, 20);
+            else if (i == 3) racerColor = sf::Color(255, 215, 0);
         }
 
         // Explotamos 4 partículas
         for(int i = 0; i < 4; i++) {
-            Particle p;
-            p.position = sf::Vector2f(ev.point.x * SCALE, ev.point.y * SCALE);
-            p.color = (i < 2) ? wallColor : racerColor;
+            sf::Vector2f position(ev.point.x * SCALE, ev.point.y * SCALE);
+            sf::Color color = (i < 2) ? wallColor : racerColor;
             
             // Le metemos una dispersión aleatoria a la normal (aprox -60 a 60 grados)
-            float angleDev = randomFloat(-1.0f, 1.0f); 
+            float angleDev = fxRandomFloat(-1.0f, 1.0f); 
             float cs = std::cos(angleDev);
             float sn = std::sin(angleDev);
             sf::Vector2f dir(
@@ -351,26 +421,14 @@ void PhysicsWorld::updateParticles(float dt) {
             );
             
             // Velocidad inicial picante
-            float speed = randomFloat(200.0f, 600.0f); 
-            p.velocity = dir * speed;
-            p.maxLife = 0.5f;
-            p.life = p.maxLife;
-            particles.push_back(p);
+            float speed = fxRandomFloat(200.0f, 600.0f); 
+            particles.spawn(position, dir * speed, color, 0.5f);
         }
     }
     contactListener.collisionEvents.clear();
 
-    // 2. CINEMÁTICA: Movemos las que ya están vivas
-    for (auto it = particles.begin(); it != particles.end(); ) {
-        it->life -= dt;
-        if (it->life <= 0.0f) {
-            it = particles.erase(it); // Se murió, la borramos del vector
-        } else {
-            it->position += it->velocity * dt;
-            it->velocity.y += 900.0f * dt; // Gravedad cruda en píxeles (caen)
-            ++it;
-        }
-    }
+    // 2. CINEMÁTICA: Movemos las vivas y barremos las muertas
+    particles.update(dt, 900.0f); // Gravedad cruda en píxeles (caen)
 }
 
 void PhysicsWorld::spawnDebris(const CustomWall& wall) {
@@ -385,34 +443,29 @@ void PhysicsWorld::spawnDebris(const CustomWall& wall) {
     if (numParticles > 100) numParticles = 100;
 
     for (int i = 0; i < numParticles; i++) {
-        Particle p;
-        
+
         // 1. Posición aleatoria DENTRO del volumen de la pared
-        float lx = randomFloat(-halfW, halfW);
-        float ly = randomFloat(-halfH, halfH);
+        float lx = fxRandomFloat(-halfW, halfW);
+        float ly = fxRandomFloat(-halfH, halfH);
         
         // 2. Rotamos al espacio del mundo
         float wx = pos.x + (lx * std::cos(angle) - ly * std::sin(angle));
         float wy = pos.y + (lx * std::sin(angle) + ly * std::cos(angle));
 
-        p.position = sf::Vector2f(wx * SCALE, wy * SCALE);
-        p.color = wall.neonColor;
-        
         // 3. Explosión violenta en 360 grados
-        float vAngle = randomFloat(0.0f, 3.141592f * 2.0f);
-        float speed = randomFloat(100.0f, 450.0f); 
-        p.velocity = sf::Vector2f(std::cos(vAngle) * speed, std::sin(vAngle) * speed);
+        float vAngle = fxRandomFloat(0.0f, 3.141592f * 2.0f);
+        float speed = fxRandomFloat(100.0f, 450.0f); 
+        sf::Vector2f velocity(std::cos(vAngle) * speed, std::sin(vAngle) * speed);
         
-        p.maxLife = randomFloat(0.4f, 1.2f);
-        p.life = p.maxLife;
-        particles.push_back(p);
+        float maxLife = fxRandomFloat(0.4f, 1.2f);
+        particles.spawn(sf::Vector2f(wx * SCALE, wy * SCALE), velocity, wall.neonColor, maxLife);
     }
 }
 
-// --- ACTUALIZACIÓN VISUAL Y AUDIO (SIMPLIFICADO) ---
-// --- ACTUALIZACIÓN VISUAL Y AUDIO ---
-void PhysicsWorld::updateWallVisuals(float dt) {
-    
+// --- GOLPES EN PAREDES: CANCIÓN, FLASH Y DESTRUCCIÓN ---
+void PhysicsWorld::processWallHits() {
+    EditScope scope(*this); // removeCustomWall de acá adentro no es una edición del usuario
+
     // Recorremos las paredes que fueron golpeadas
     for (b2Body* body : contactListener.wallsHit) {
         
@@ -427,56 +480,67 @@ void PhysicsWorld::updateWallVisuals(float dt) {
             currentNoteIndex = (currentNoteIndex + 1) % songNotes.size();
         }
 
-        for (auto& wall : customWalls) {
-            if (wall.body == body) {
-                // 1. FLASH VISUAL
-                wall.flashTimer = 1.0f;
+        EntityHandle tag = getBodyTag(body);
+        CustomWall* wallPtr = (tag.kind == EntityKind::Wall) ? customWalls.get(tag.slot()) : nullptr;
+        if (wallPtr) {
+            CustomWall& wall = *wallPtr;
 
-                // Si hay canción, sobreescribimos el color del flash basado en la nota
-                // Notas graves (bajas) -> Azul/Violeta. Notas agudas (altas) -> Rojo/Naranja
+            // 1. FLASH VISUAL
+            wall.flashTimer = 1.0f;
+
+            // Si hay canción, sobreescribimos el color del flash basado en la nota
+            // Notas graves (bajas) -> Azul/Violeta. Notas agudas (altas) -> Rojo/Naranja
+            if (noteToPlay != -1) {
+                // Mapeo trucho de nota MIDI (ej: 40 a 90) a índice de paleta (0 a 8)
+                int pSize = getPalette().size();
+                int colorIdx = (noteToPlay % 12) % pSize; // Usamos el semitono para el color
+                
+                // Actualizamos el color del flash dinámicamente
+                sf::Color neon = getPalette()[colorIdx];
+                wall.flashColor = sf::Color(
+                    std::min(255, neon.r + 150),
+                    std::min(255, neon.g + 150),
+                    std::min(255, neon.b + 150)
+                );
+            }
+
+            // 2. SONIDO
+            if (soundManager) {
                 if (noteToPlay != -1) {
-                    // Mapeo trucho de nota MIDI (ej: 40 a 90) a índice de paleta (0 a 8)
-                    int pSize = getPalette().size();
-                    int colorIdx = (noteToPlay % 12) % pSize; // Usamos el semitono para el color
-                    
-                    // Actualizamos el color del flash dinámicamente
-                    sf::Color neon = getPalette()[colorIdx];
-                    wall.flashColor = sf::Color(
-                        std::min(255, neon.r + 150),
-                        std::min(255, neon.g + 150),
-                        std::min(255, neon.b + 150)
-                    );
+                    // MODO CANCIÓN: Toca la nota secuencial
+                    soundManager->playMidiNote(noteToPlay);
+                } else if (wall.soundID > 0) {
+                    // MODO CLÁSICO: Toca el sonido de la pared
+                    soundManager->playSound(wall.soundID, 0, 0);
                 }
+            }
 
-                // 2. SONIDO
-                if (soundManager) {
-                    if (noteToPlay != -1) {
-                        // MODO CANCIÓN: Toca la nota secuencial
-                        soundManager->playMidiNote(noteToPlay);
-                    } else if (wall.soundID > 0) {
-                        // MODO CLÁSICO: Toca el sonido de la pared
-                        soundManager->playSound(wall.soundID, 0, 0);
-                    }
-                }
-
-                if (wall.isDestructible && wall.currentHits > 0 && !wall.pendingDestroy) {
-                wall.currentHits--;
-                    if (wall.currentHits <= 0) {
-                    wall.pendingDestroy = true; 
-                    }
+            if (wall.isDestructible && wall.currentHits > 0 && !wall.pendingDestroy) {
+            wall.currentHits--;
+                if (wall.currentHits <= 0) {
+                wall.pendingDestroy = true; 
                 }
             }
         }
     }
 
+    contactListener.wallsHit.clear();
+
     // EJECUCIÓN DE DESTRUCCIÓN POST-CÁLCULOS
-    for (int i = (int)customWalls.size() - 1; i >= 0; --i) {
-        if (customWalls[i].pendingDestroy) {
-            spawnDebris(customWalls[i]);
-            removeCustomWall(i); // Borra el Box2D body de forma segura
-        }
+    // Primero se juntan los handles y después se borra: el swap-remove baraja el arreglo
+    // denso, pero los handles siguen valiendo, así el recorrido no depende del sentido
+    wallsToDestroy.clear();
+    for (size_t i = 0; i < customWalls.size(); ++i) {
+        if (!customWalls[i].pendingDestroy) continue;
+        if (visualFx) spawnDebris(customWalls[i]);
+        wallsToDestroy.push_back(customWalls.handleAt(i));
     }
+    for (WallHandle handle : wallsToDestroy) removeCustomWall(handle); // O(1) cada una
+}
 
+// --- ACTUALIZACIÓN VISUAL ---
+void PhysicsWorld::updateWallVisuals(float dt) {
+    ProfileScope timer(profiler, ProfileStage::WallVisuals);
     // Fade out
     for (auto& wall : customWalls) {
         if (wall.flashTimer > 0.0f) {
@@ -484,206 +548,207 @@ void PhysicsWorld::updateWallVisuals(float dt) {
             if (wall.flashTimer < 0.0f) wall.flashTimer = 0.0f;
         }
     }
-
-    contactListener.wallsHit.clear();
 }
 
-// --- GUARDADO/CARGA (Sin cambios, ya soporta soundID) ---
+// --- GUARDADO/CARGA ---
+// Texto o binario según la extensión al guardar y según el magic al cargar (MapFile.hpp)
 void PhysicsWorld::saveMap(const std::string& filename) {
-    std::ofstream file(filename);
-    if (!file.is_open()) return;
+    if (!writeMapFile(filename, exportMap(), hasBinaryMapExtension(filename))) return;
+    std::cout << "Map saved: " << filename << std::endl;
+}
 
-    file << "CONFIG " << targetSpeed << " " << currentRacerSize << " " 
-         << currentRestitution << " " << enableChaos << " " << stopOnFirstWin << "\n";
-    file << "WINZONE " << winZonePos[0] << " " << winZonePos[1] << " " 
-         << winZoneSize[0] << " " << winZoneSize[1] << " " << winZoneGlow << " " << "\n";
+std::string PhysicsWorld::saveMapToString() const {
+    return writeMapText(exportMap());
+}
+
+bool PhysicsWorld::loadMap(const std::string& filename) {
+    MapData map;
+    if (!readMapFile(filename, map)) return false;
+    loadMapData(map);
+    if (logEvents) std::cout << "Map loaded: " << filename << std::endl;
+    return true;
+}
 
-    for (const auto& w : customWalls) {
+bool PhysicsWorld::loadMapFromString(const std::string& mapText) {
+    MapData map;
+    if (!parseMapText(mapText, map)) return false;
+    loadMapData(map);
+    return true;
+}
+
+MapData PhysicsWorld::exportMap() const {
+    MapData map;
+    map.hasConfig = true;
+    map.targetSpeed = targetSpeed;
+    map.racerSize = currentRacerSize;
+    map.restitution = currentRestitution;
+    map.enableChaos = enableChaos;
+    map.stopOnFirstWin = stopOnFirstWin;
+
+    map.hasWinZone = true;
+    map.winZonePos[0] = winZonePos[0]; map.winZonePos[1] = winZonePos[1];
+    map.winZoneSize[0] = winZoneSize[0]; map.winZoneSize[1] = winZoneSize[1];
+    map.winZoneGlow = winZoneGlow;
+
+    // A disco van en orden de inserción (el denso se baraja al borrar); stopTarget se
+    // traduce a esa misma posición
+    std::vector<uint32_t> wallOrder = customWalls.insertionOrder();
+    std::vector<int> savedIndex(customWalls.size());
+    for (size_t k = 0; k < wallOrder.size(); ++k) savedIndex[wallOrder[k]] = (int)k;
+
+    map.walls.reserve(customWalls.size());
+    for (uint32_t d : wallOrder) {
+        const CustomWall& w = customWalls[d];
         b2Vec2 pos = w.body->GetPosition();
-        // Guardamos TODO en una sola línea.
-        // El orden es importante para el load.
-        file << "WALL " 
-             << pos.x << " " << pos.y << " " 
-             << w.width << " " << w.height << " " 
-             << w.soundID << " "
-             << w.colorIndex << " "      
-             << w.isExpandable << " "    
-             << w.expansionDelay << " "
-             << w.expansionSpeed << " "
-             << w.expansionAxis << " "
-             << w.stopOnContact << " "
-             << w.stopTargetIdx << " "
-             << w.maxSize << " "
-             << w.shapeType << " "
-             << w.rotation << " "
-             << w.isDeadly << " "
-             << w.isMoving << " "
-             << w.pointA.x << " " << w.pointA.y << " "
-             << w.pointB.x << " " << w.pointB.y << " "
-             << w.moveSpeed << " "
-             << w.reverseOnContact << " "
-             << w.freeBounce << " "
-             << w.isDestructible << " "
-             << w.maxHits << " "
-             << w.currentHits << " "
-             << w.useTextForHP << "\n";
+        MapWall mw;
+        mw.x = pos.x; mw.y = pos.y;
+        mw.width = w.width; mw.height = w.height;
+        mw.soundID = w.soundID;
+        mw.colorIndex = w.colorIndex;
+        mw.isExpandable = w.isExpandable;
+        mw.expansionDelay = w.expansionDelay;
+        mw.expansionSpeed = w.expansionSpeed;
+        mw.expansionAxis = w.expansionAxis;
+        mw.stopOnContact = w.stopOnContact;
+        int targetDense = customWalls.denseIndexOf(w.stopTarget);
+        mw.stopTarget = targetDense >= 0 ? savedIndex[targetDense] : -1; // En disco va como índice de pared
+        mw.maxSize = w.maxSize;
+        mw.shapeType = w.shapeType;
+        mw.rotation = w.rotation;
+        mw.isDeadly = w.isDeadly;
+        mw.isMoving = w.isMoving;
+        mw.pointA[0] = w.pointA.x; mw.pointA[1] = w.pointA.y;
+        mw.pointB[0] = w.pointB.x; mw.pointB[1] = w.pointB.y;
+        mw.moveSpeed = w.moveSpeed;
+        mw.reverseOnContact = w.reverseOnContact;
+        mw.freeBounce = w.freeBounce;
+        mw.isDestructible = w.isDestructible;
+        mw.maxHits = w.maxHits;
+        mw.currentHits = w.currentHits;
+        mw.useTextForHP = w.useTextForHP;
+        map.walls.push_back(mw);
     }
 
-    for (const auto& k : knives) {
-        file << "KNIFE " << k.initialPos.x << " " << k.initialPos.y << "\n";
+    for (uint32_t d : knives.insertionOrder()) {
+        map.knives.push_back({knives[d].initialPos.x, knives[d].initialPos.y});
     }
 
     for (size_t i = 0; i < dynamicBodies.size(); ++i) {
-        b2Body* b = dynamicBodies[i];
-        b2Vec2 pos = b->GetPosition();
-        b2Vec2 vel = b->GetLinearVelocity();
-        float angle = b->GetAngle();
-        float angVel = b->GetAngularVelocity();
-        file << "RACER " << i << " " 
-             << pos.x << " " << pos.y << " " 
-             << vel.x << " " << vel.y << " " 
-             << angle << " " << angVel << "\n";
+        const b2Body* b = dynamicBodies[i];
+        map.racers.push_back({(int)i, b->GetPosition().x, b->GetPosition().y,
+                              b->GetLinearVelocity().x, b->GetLinearVelocity().y,
+                              b->GetAngle(), b->GetAngularVelocity()});
     }
-    file.close();
-    std::cout << "Map saved: " << filename << std::endl;
+    return map;
 }
 
-void PhysicsWorld::loadMap(const std::string& filename) {
-    std::ifstream file(filename);
-    if (!file.is_open()) {
-        std::cerr << "Map not found: " << filename << std::endl;
-        return;
-    }
+void PhysicsWorld::loadMapData(const MapData& map) {
+    EditScope scope(*this); // Cargar un mapa no es una edición: el replay guarda el texto entero
 
     clearCustomWalls();
-    resetRacers(); 
+    resetRacers();
+
+    if (map.hasConfig) {
+        targetSpeed = map.targetSpeed;
+        enableChaos = map.enableChaos;
+        stopOnFirstWin = map.stopOnFirstWin;
+        updateRacerSize(map.racerSize);
+        updateRestitution(map.restitution);
+    }
+    if (map.hasWinZone) {
+        updateWinZone(map.winZonePos[0], map.winZonePos[1], map.winZoneSize[0], map.winZoneSize[1]);
+        winZoneGlow = map.winZoneGlow;
+    }
 
-    std::string line;
-    while (std::getline(file, line)) {
-        std::stringstream ss(line);
-        std::string type;
-        ss >> type;
-
-        if (type == "CONFIG") {
-            float spd, size, rest; bool chaos;
-            ss >> spd >> size >> rest >> chaos;
-            targetSpeed = spd; enableChaos = chaos;
-            updateRacerSize(size); updateRestitution(rest);
-            
-            bool stopFW;
-            if (ss >> stopFW) stopOnFirstWin = stopFW;
-            else stopOnFirstWin = true; // Retrocompatibilidad
-        }
-        else if (type == "WINZONE") {             
-            float x, y, w, h;
-            ss >> x >> y >> w >> h;
-            updateWinZone(x, y, w, h);
-
-            bool hasGlow = true;
-            if (ss >> hasGlow) winZoneGlow = hasGlow;
-            else winZoneGlow = true;
-        }
-        else if (type == "WALL") {
-            float x, y, w, h;
-            int sid = 0;
-            ss >> x >> y >> w >> h >> sid;
-            
-            // Creamos la pared (por defecto rectangular y sin rotación)
-            addCustomWall(x, y, w, h, sid, 0, 0.0f);
-            CustomWall& newWall = customWalls.back();
+    // Una sola pasada: cada pared nace con su forma, tipo y rotación finales.
+    // Antes era addCustomWall + updateCustomWall (el pincho armaba la fixture dos veces)
+    // y un stringstream por campo; con 10k paredes eso era lo que tardaba.
+    customWalls.reserve(map.walls.size());
+    std::vector<WallHandle> wallsInFileOrder;
+    wallsInFileOrder.reserve(map.walls.size());
 
-            // 2. Color y Expansión
-            int cIdx = 0;
-            if (ss >> cIdx) updateWallColor(customWalls.size() - 1, cIdx);
-            
-            bool isExp = false;
-            if (ss >> isExp) {
-                newWall.isExpandable = isExp;
-                ss >> newWall.expansionDelay 
-                   >> newWall.expansionSpeed 
-                   >> newWall.expansionAxis 
-                   >> newWall.stopOnContact 
-                   >> newWall.stopTargetIdx 
-                   >> newWall.maxSize;
-            }
+    for (const MapWall& mw : map.walls) {
+        b2BodyDef bd;
+        bd.type = mw.isMoving ? b2_kinematicBody : b2_staticBody;
+        bd.position.Set(mw.x, mw.y);
+        bd.angle = mw.rotation;
+        b2Body* body = world->CreateBody(&bd);
 
-            // 3. Geometría y Letalidad (NUEVO)
-            int sType = 0;
-            float rot = 0.0f;
-            bool deadly = false;
-
-            // Intentamos leer si existen en el archivo (retro-compatibilidad)
-            if (ss >> sType) {
-                newWall.shapeType = sType;
-                if (ss >> rot) newWall.rotation = rot;
-                if (ss >> deadly) newWall.isDeadly = deadly;
-
-            bool isMov = false;
-                if (ss >> isMov) {
-                    newWall.isMoving = isMov;
-                   ss >> newWall.pointA.x >> newWall.pointA.y
-                       >> newWall.pointB.x >> newWall.pointB.y
-                       >> newWall.moveSpeed;
-                       
-                    bool isRev = false;
-                    if (ss >> isRev) newWall.reverseOnContact = isRev;
-                    
-                    bool isFree = false;
-                    if (ss >> isFree) newWall.freeBounce = isFree;
-                       
-                    if (newWall.isMoving) {
-                        newWall.body->SetType(b2_kinematicBody);
-                    }
-                }
-                
-                bool isDestr = false;
-                if (ss >> isDestr) {
-                    newWall.isDestructible = isDestr;
-                    
-                    int mHits = 3, cHits = 3;
-                    if (ss >> mHits >> cHits) {
-                        newWall.maxHits = mHits;
-                        newWall.currentHits = cHits;
-                    }
-                    
-                    bool useTxt = false;
-                    if (ss >> useTxt) newWall.useTextForHP = useTxt;
-                }
+        b2PolygonShape shape;
+        setWallShape(shape, mw.width, mw.height, mw.shapeType);
+        b2FixtureDef fd;
+        fd.friction = 0.0f;
+        fd.restitution = 1.0f;
+        fd.shape = &shape;
+        body->CreateFixture(&fd);
+
+        CustomWall wall;
+        wall.body = body;
+        wall.width = mw.width;
+        wall.height = mw.height;
+        wall.soundID = mw.soundID;
+        wall.isExpandable = mw.isExpandable;
+        wall.expansionDelay = mw.expansionDelay;
+        wall.expansionSpeed = mw.expansionSpeed;
+        wall.expansionAxis = mw.expansionAxis;
+        wall.stopOnContact = mw.stopOnContact;
+        wall.maxSize = mw.maxSize;
+        wall.shapeType = mw.shapeType;
+        wall.rotation = mw.rotation;
+        wall.isDeadly = mw.isDeadly;
+        wall.isMoving = mw.isMoving;
+        wall.pointA.Set(mw.pointA[0], mw.pointA[1]);
+        wall.pointB.Set(mw.pointB[0], mw.pointB[1]);
+        wall.moveSpeed = mw.moveSpeed;
+        wall.reverseOnContact = mw.reverseOnContact;
+        wall.freeBounce = mw.freeBounce;
+        wall.isDestructible = mw.isDestructible;
+        wall.maxHits = mw.maxHits;
+        wall.currentHits = mw.currentHits;
+        wall.useTextForHP = mw.useTextForHP;
+
+        // Sin color en el archivo sale del sonido; los pinchos cargan siempre rojos
+        int colorIdx = (mw.colorIndex >= 0) ? mw.colorIndex : (mw.soundID > 0 ? mw.soundID - 1 : 0);
+        if (mw.shapeType == 1) colorIdx = 5;
+        applyWallColor(wall, colorIdx);
+
+        WallHandle handle = customWalls.insert(std::move(wall));
+        tagBody(body, EntityKind::Wall, handle);
+        wallsInFileOrder.push_back(handle);
+    }
 
-                updateCustomWall(customWalls.size() - 1, x, y, w, h, sid, sType, rot);
-                customWalls.back().isDeadly = deadly;
-            }
+    // El target de frenado es un índice de pared y puede apuntar a una posterior
+    for (size_t i = 0; i < map.walls.size(); ++i) {
+        int targetIdx = map.walls[i].stopTarget;
+        if (targetIdx >= 0 && targetIdx < (int)wallsInFileOrder.size()) {
+            customWalls.get(wallsInFileOrder[i])->stopTarget = wallsInFileOrder[targetIdx];
         }
+    }
 
-        else if (type == "KNIFE") {
-            float x, y;
-            ss >> x >> y;
-            addKnife(x, y);
-        }
+    for (const MapKnife& k : map.knives) {
+        addKnife(k.x, k.y);
+    }
 
-        else if (type == "RACER") { 
-            int id; float x, y, vx, vy, a, av;
-            ss >> id >> x >> y >> vx >> vy >> a >> av;
-            if (id >= 0 && id < dynamicBodies.size()) {
-                b2Body* b = dynamicBodies[id];
-                b->SetEnabled(true);
-                b->SetTransform(b2Vec2(x, y), a);
-                b->SetLinearVelocity(b2Vec2(vx, vy));
-                b->SetAngularVelocity(av);
-                b->SetAwake(true);
-            }
+    for (const MapRacer& r : map.racers) {
+        if (r.id >= 0 && r.id < (int)dynamicBodies.size()) {
+            b2Body* b = dynamicBodies[r.id];
+            b->SetEnabled(true);
+            b->SetTransform(b2Vec2(r.x, r.y), r.angle);
+            b->SetLinearVelocity(b2Vec2(r.vx, r.vy));
+            b->SetAngularVelocity(r.angularVelocity);
+            b->SetAwake(true);
         }
     }
+
     isPaused = true;
-    file.close();
-    std::cout << "Map loaded: " << filename << std::endl;
 }
 
 void PhysicsWorld::clearCustomWalls() {
     for (const auto& wall : customWalls) {
-        world.DestroyBody(wall.body);
+        world->DestroyBody(wall.body);
     }
     customWalls.clear();
+    contactListener.wallsHit.clear(); // Ya no hay a quién leerle la etiqueta
 }
 
 sf::Color getNeonColor(int index) {
@@ -716,32 +781,21 @@ const std::vector<sf::Color>& PhysicsWorld::getPalette() {
     return palette;
 }
 
-void PhysicsWorld::addCustomWall(float x, float y, float w, float h, int soundID, int shapeType, float rotation) {
+WallHandle PhysicsWorld::addCustomWall(float x, float y, float w, float h, int soundID, int shapeType, float rotation) {
+    EditScope scope(*this);
     b2BodyDef bd; 
     bd.type = b2_staticBody; 
     bd.position.Set(x, y);
     bd.angle = rotation; // <--- Rotación Física
     
-    b2Body* body = world.CreateBody(&bd);
+    b2Body* body = world->CreateBody(&bd);
 
     b2FixtureDef fd;
     fd.friction = 0.0f;
     fd.restitution = 1.0f;
 
     b2PolygonShape shape;
-    
-    if (shapeType == 1) { 
-        // --- TRIÁNGULO (PINCHO) ---
-        b2Vec2 vertices[3];
-        // Triangulo isósceles apuntando hacia "arriba" localmente
-        vertices[0].Set(0.0f, -h / 2.0f);       // Punta Superior
-        vertices[1].Set(w / 2.0f, h / 2.0f);    // Base Derecha
-        vertices[2].Set(-w / 2.0f, h / 2.0f);   // Base Izquierda
-        shape.Set(vertices, 3);
-    } else {
-        // --- CAJA (NORMAL) ---
-        shape.SetAsBox(w / 2.0f, h / 2.0f);
-    }
+    setWallShape(shape, w, h, shapeType);
 
     fd.shape = &shape;
     body->CreateFixture(&fd);
@@ -764,45 +818,33 @@ void PhysicsWorld::addCustomWall(float x, float y, float w, float h, int soundID
     int colorIdx = (soundID > 0) ? (soundID - 1) : newWall.colorIndex;
     if (shapeType == 1 && soundID == 0) colorIdx = 5; // Force Red
 
-    // Forzamos rango
-    if (colorIdx < 0) colorIdx = 0;
-    colorIdx = colorIdx % getPalette().size();
-
-    newWall.colorIndex = colorIdx;
-    
-    const auto& pal = getPalette();
-    sf::Color neon = pal[colorIdx];
-    newWall.baseFillColor = sf::Color(neon.r / 5, neon.g / 5, neon.b / 5, 240);
-    newWall.neonColor = neon;
-    newWall.flashColor = sf::Color(
-        std::min(255, neon.r + 100),
-        std::min(255, neon.g + 100),
-        std::min(255, neon.b + 100)
-    );
+    applyWallColor(newWall, colorIdx);
 
-    customWalls.push_back(newWall);
+    WallHandle handle = customWalls.insert(newWall);
+    tagBody(body, EntityKind::Wall, handle);
+    recordEdit(EditType::WallAdd, handle, {x, y, w, h, (double)soundID, (double)shapeType, rotation});
+    return handle;
 }
 
 int PhysicsWorld::getRacerIndex(b2Body* body) const {
-    for (size_t i = 0; i < dynamicBodies.size(); ++i) {
-        if (dynamicBodies[i] == body) return (int)i;
-    }
-    return -1;
+    EntityHandle tag = getBodyTag(body);
+    if (tag.kind != EntityKind::Racer || tag.index >= dynamicBodies.size()) return -1;
+    return (int)tag.index;
 }
 
-int PhysicsWorld::getKnifeIndex(b2Body* body) const {
-    for (size_t i = 0; i < knives.size(); ++i) {
-        if (knives[i].body == body) return (int)i;
-    }
-    return -1;
+KnifeItem* PhysicsWorld::getKnife(b2Body* body) {
+    EntityHandle tag = getBodyTag(body);
+    if (tag.kind != EntityKind::Knife) return nullptr;
+    return knives.get(tag.slot());
 }
 
-void PhysicsWorld::addKnife(float x, float y) {
+KnifeHandle PhysicsWorld::addKnife(float x, float y) {
+    EditScope scope(*this);
     b2BodyDef bd;
     bd.type = b2_staticBody; // Estático para que no ruede ni tenga física real de peso
     bd.position.Set(x, y);
     
-    b2Body* body = world.CreateBody(&bd);
+    b2Body* body = world->CreateBody(&bd);
     
     b2PolygonShape shape;
     shape.SetAsBox(0.5f, 0.5f); // Hitbox del item
@@ -815,40 +857,55 @@ void PhysicsWorld::addKnife(float x, float y) {
     KnifeItem knife;
     knife.body = body;
     knife.initialPos = b2Vec2(x, y); // Guardamos dónde nació
-    knives.push_back(knife);
+    KnifeHandle handle = knives.insert(knife);
+    tagBody(body, EntityKind::Knife, handle);
+    recordEdit(EditType::KnifeAdd, handle, {x, y});
+    return handle;
 }
 
-void PhysicsWorld::removeKnife(int index) {
-    if (index < 0 || index >= knives.size()) return;
-    world.DestroyBody(knives[index].body);
-    knives.erase(knives.begin() + index);
+void PhysicsWorld::removeKnife(KnifeHandle handle) {
+    KnifeItem* knife = knives.get(handle);
+    if (!knife) return;
+    EditScope scope(*this);
+    world->DestroyBody(knife->body);
+    knives.erase(handle); // Los demás conservan su slot: no hay que re-etiquetar nada
+    recordEdit(EditType::KnifeRemove, handle);
 }
 
-void PhysicsWorld::updateKnifePos(int index, float x, float y) {
-    if (index < 0 || index >= knives.size()) return;
-    knives[index].initialPos.Set(x, y);
-    knives[index].body->SetTransform(b2Vec2(x, y), 0);
+void PhysicsWorld::updateKnifePos(KnifeHandle handle, float x, float y) {
+    KnifeItem* knife = knives.get(handle);
+    if (!knife) return;
+    EditScope scope(*this);
+    knife->initialPos.Set(x, y);
+    knife->body->SetTransform(b2Vec2(x, y), 0);
+    recordEdit(EditType::KnifePos, handle, {x, y});
 }
 
 void PhysicsWorld::clearKnives() {
     for (auto& k : knives) {
-        if (k.body) world.DestroyBody(k.body);
+        if (k.body) world->DestroyBody(k.body);
     }
     knives.clear();
 }
 
-void PhysicsWorld::updateWallColor(int index, int newColorIndex) {
-    if (index < 0 || index >= customWalls.size()) return;
+void PhysicsWorld::updateWallColor(WallHandle handle, int newColorIndex) {
+    CustomWall* wallPtr = customWalls.get(handle);
+    if (!wallPtr) return;
+    EditScope scope(*this);
     
-    CustomWall& w = customWalls[index];
+    applyWallColor(*wallPtr, newColorIndex);
+    recordEdit(EditType::WallColor, handle, {(double)wallPtr->colorIndex});
+}
+
+void PhysicsWorld::applyWallColor(CustomWall& w, int colorIndex) {
     const auto& pal = getPalette();
     
     // Safety check
-    if (newColorIndex < 0) newColorIndex = 0;
-    newColorIndex = newColorIndex % pal.size();
+    if (colorIndex < 0) colorIndex = 0;
+    colorIndex = colorIndex % pal.size();
 
-    w.colorIndex = newColorIndex;
-    sf::Color neon = pal[newColorIndex];
+    w.colorIndex = colorIndex;
+    sf::Color neon = pal[colorIndex];
     
     w.baseFillColor = sf::Color(neon.r / 5, neon.g / 5, neon.b / 5, 240);
     w.neonColor = neon;
@@ -859,9 +916,41 @@ void PhysicsWorld::updateWallColor(int index, int newColorIndex) {
     );
 }
 
-void PhysicsWorld::updateCustomWall(int index, float x, float y, float w, float h, int soundID, int shapeType, float rotation) {
-    if (index < 0 || index >= customWalls.size()) return;
-    CustomWall& wall = customWalls[index];
+void PhysicsWorld::setWallShape(b2PolygonShape& shape, float w, float h, int shapeType) {
+    if (shapeType == 1) { 
+        // --- TRIÁNGULO (PINCHO) ---
+        b2Vec2 vertices[3];
+        // Triangulo isósceles apuntando hacia "arriba" localmente
+        vertices[0].Set(0.0f, -h / 2.0f);       // Punta Superior
+        vertices[1].Set(w / 2.0f, h / 2.0f);    // Base Derecha
+        vertices[2].Set(-w / 2.0f, h / 2.0f);   // Base Izquierda
+        shape.Set(vertices, 3);
+    } else {
+        // --- CAJA (NORMAL) ---
+        shape.SetAsBox(w / 2.0f, h / 2.0f);
+    }
+}
+
+// Cambia el polígono del (único) fixture sin destruirlo. Destroy/CreateFixture libera y
+// vuelve a pedir memoria, saca y mete el proxy del broadphase y tira los contactos:
+// con paredes creciendo eso pasaba 60 veces por segundo por pared.
+// Box2D no expone el refresh del proxy; un SetTransform al mismo lugar recalcula el
+// AABB y solo toca el árbol si se salió del AABB engordado. Los contactos siguen
+// vivos y el narrowphase ya lee los vértices nuevos en el próximo step.
+void PhysicsWorld::reshapeFixture(b2Body* body, const b2PolygonShape& shape) {
+    b2Fixture* fixture = body->GetFixtureList();
+    if (!fixture || fixture->GetType() != b2Shape::e_polygon) return;
+
+    *static_cast<b2PolygonShape*>(fixture->GetShape()) = shape;
+    if (body->GetType() == b2_dynamicBody) body->ResetMassData(); // La masa sale del área
+    body->SetTransform(body->GetPosition(), body->GetAngle());
+}
+
+void PhysicsWorld::updateCustomWall(WallHandle handle, float x, float y, float w, float h, int soundID, int shapeType, float rotation) {
+    CustomWall* wallPtr = customWalls.get(handle);
+    if (!wallPtr) return;
+    EditScope scope(*this);
+    CustomWall& wall = *wallPtr;
     
     bool needRebuild = (wall.width != w || wall.height != h || wall.shapeType != shapeType);
     
@@ -874,7 +963,7 @@ void PhysicsWorld::updateCustomWall(int index, float x, float y, float w, float
     // Si cambia a pincho, lo hacemos mortal y rojo
     if (shapeType == 1) {
         wall.isDeadly = true;
-        updateWallColor(index, 5);
+        updateWallColor(handle, 5);
     } else {
         // Si vuelve a ser pared, le sacamos lo mortal (opcional, capaz querés pared mortal)
         // wall.isDeadly = false; 
@@ -883,36 +972,58 @@ void PhysicsWorld::updateCustomWall(int index, float x, float y, float w, float
     wall.body->SetTransform(b2Vec2(x, y), rotation);
 
     if (needRebuild) {
-        wall.body->DestroyFixture(wall.body->GetFixtureList());
-        
-        b2FixtureDef fd;
-        fd.friction = 0.0f;
-        fd.restitution = 1.0f;
         b2PolygonShape shape;
+        setWallShape(shape, w, h, shapeType);
+        reshapeFixture(wall.body, shape);
+    }
+    recordEdit(EditType::WallUpdate, handle, {x, y, w, h, (double)soundID, (double)shapeType, rotation});
+}
 
-        if (shapeType == 1) { // Triángulo
-            b2Vec2 vertices[3];
-            vertices[0].Set(0.0f, -h / 2.0f);
-            vertices[1].Set(w / 2.0f, h / 2.0f);
-            vertices[2].Set(-w / 2.0f, h / 2.0f);
-            shape.Set(vertices, 3);
-        } else { // Caja
-            shape.SetAsBox(w / 2.0f, h / 2.0f);
-        }
+void PhysicsWorld::removeCustomWall(WallHandle handle) {
+    CustomWall* wall = customWalls.get(handle);
+    if (!wall) return;
+    EditScope scope(*this);
+    contactListener.wallsHit.erase(wall->body); // Que no quede un puntero colgado
+    world->DestroyBody(wall->body);
+    // O(1): la última pared tapa el hueco y conserva su slot/etiqueta.
+    // Los stopTarget que apuntaban a esta pared quedan con handle muerto (no frenan con nadie).
+    customWalls.erase(handle);
+    recordEdit(EditType::WallRemove, handle);
+}
 
-        fd.shape = &shape;
-        wall.body->CreateFixture(&fd);
-    }
+void PhysicsWorld::buildWallGrid() {
+    wallGrid.reset(worldWidthMeters, worldHeightMeters, WallGridCellSize);
+    for (size_t j = 0; j < customWalls.size(); ++j) insertWallInGrid(j);
 }
 
-void PhysicsWorld::removeCustomWall(int index) {
-    if (index < 0 || index >= customWalls.size()) return;
-    world.DestroyBody(customWalls[index].body);
-    customWalls.erase(customWalls.begin() + index);
+void PhysicsWorld::insertWallInGrid(size_t denseIndex) {
+    const CustomWall& wall = customWalls[denseIndex];
+    b2Vec2 pos = wall.body->GetPosition();
+    float halfW = wall.width / 2.0f;
+    float halfH = wall.height / 2.0f;
+    wallGrid.insert((uint32_t)denseIndex, pos.x - halfW, pos.y - halfH, pos.x + halfW, pos.y + halfH);
 }
 
 void PhysicsWorld::updateWallExpansion(float dt) {
     if (isPaused) return;
+    ProfileScope timer(profiler, ProfileStage::WallExpansion);
+
+    // La grilla solo hace falta si alguna pared frena contra "cualquiera"
+    bool useGrid = false;
+    for (const CustomWall& wall : customWalls) {
+        if (wall.isExpandable && wall.stopOnContact && !wall.stopTarget.isValid()) { useGrid = true; break; }
+    }
+    if (useGrid) buildWallGrid();
+
+    // Caja que encierra a todos los racers vivos: la pared que no la toca no puede aplastar a nadie
+    float racerRadius = currentRacerSize / 2.0f;
+    b2Vec2 racersMin(1e30f, 1e30f), racersMax(-1e30f, -1e30f);
+    for (size_t r = 0; r < dynamicBodies.size(); ++r) {
+        if (!racerStatus[r].isAlive || !dynamicBodies[r]->IsEnabled()) continue;
+        b2Vec2 p = dynamicBodies[r]->GetPosition();
+        racersMin.Set(std::min(racersMin.x, p.x - racerRadius), std::min(racersMin.y, p.y - racerRadius));
+        racersMax.Set(std::max(racersMax.x, p.x + racerRadius), std::max(racersMax.y, p.y + racerRadius));
+    }
 
     for (size_t i = 0; i < customWalls.size(); ++i) {
         CustomWall& wall = customWalls[i];
@@ -949,10 +1060,20 @@ void PhysicsWorld::updateWallExpansion(float dt) {
         // --- CHECK 2: STOP ON SPECIFIC CONTACT ---
         if (wall.stopOnContact) {
             b2Vec2 myPos = wall.body->GetPosition();
+
+            // Con target: solo esa pared (si ya no existe, no frena con nadie).
+            // Sin target: las que la grilla diga que pueden tocar la caja nueva.
+            if (wall.stopTarget.isValid()) {
+                gridCandidates.clear();
+                int targetIdx = customWalls.denseIndexOf(wall.stopTarget);
+                if (targetIdx >= 0) gridCandidates.push_back((uint32_t)targetIdx);
+            } else {
+                wallGrid.query(myPos.x - newWidth / 2.0f, myPos.y - newHeight / 2.0f,
+                               myPos.x + newWidth / 2.0f, myPos.y + newHeight / 2.0f, gridCandidates);
+            }
             
-            for (size_t j = 0; j < customWalls.size(); ++j) {
+            for (uint32_t j : gridCandidates) {
                 if (i == j) continue; 
-                if (wall.stopTargetIdx != -1 && (int)j != wall.stopTargetIdx) continue;
 
                 const CustomWall& other = customWalls[j];
                 b2Vec2 otherPos = other.body->GetPosition();
@@ -972,7 +1093,7 @@ void PhysicsWorld::updateWallExpansion(float dt) {
                     newWidth = wall.width; 
                     newHeight = wall.height;
                     sizeChanged = false; 
-                    std::cout << "Wall " << i << " stopped by target Wall " << j << std::endl;
+                    if (logEvents) std::cout << "Wall " << i << " stopped by target Wall " << j << std::endl;
                     break; 
                 }
             }
@@ -983,13 +1104,14 @@ void PhysicsWorld::updateWallExpansion(float dt) {
         float wallHalfW = (sizeChanged ? newWidth : wall.width) / 2.0f;
         float wallHalfH = (sizeChanged ? newHeight : wall.height) / 2.0f;
         
-        float racerRadius = currentRacerSize / 2.0f; 
+        bool nearRacers = wallPos.x - wallHalfW < racersMax.x && wallPos.x + wallHalfW > racersMin.x &&
+                          wallPos.y - wallHalfH < racersMax.y && wallPos.y + wallHalfH > racersMin.y;
         
         // ACÁ PODÉS JUGAR CON EL PORCENTAJE (0.9 = 90% aplastado para morir)
         float killPercentage = 0.5f; 
         float killThresholdArea = (currentRacerSize * currentRacerSize) * killPercentage;
 
-        for (size_t r = 0; r < dynamicBodies.size(); ++r) {
+        for (size_t r = 0; nearRacers && r < dynamicBodies.size(); ++r) {
             if (!racerStatus[r].isAlive) continue;
 
             b2Body* racerBody = dynamicBodies[r];
@@ -1013,10 +1135,11 @@ void PhysicsWorld::updateWallExpansion(float dt) {
                 float crushedArea = realOverlapX * realOverlapY;
                 
                 if (crushedArea > killThresholdArea) {
-                    std::cout << ">>> RACER " << r << " SQUASHED (" << (crushedArea/(currentRacerSize*currentRacerSize))*100 << "%) <<<" << std::endl;
+                    if (logEvents) std::cout << ">>> RACER " << r << " SQUASHED (" << (crushedArea/(currentRacerSize*currentRacerSize))*100 << "%) <<<" << std::endl;
                     
                     racerStatus[r].isAlive = false;
                     racerStatus[r].deathPos = racerPos;
+                    racerStatus[r].deathCause = DeathCause::Crush;
                     racerBody->SetEnabled(false); 
                 }
             }
@@ -1029,19 +1152,25 @@ void PhysicsWorld::updateWallExpansion(float dt) {
         // Actualizar física de la pared
         wall.width = newWidth;
         wall.height = newHeight;
-        wall.body->DestroyFixture(wall.body->GetFixtureList());
         b2PolygonShape box;
         box.SetAsBox(wall.width / 2.0f, wall.height / 2.0f);
-        b2FixtureDef fd;
-        fd.shape = &box;
-        fd.friction = 0.0f;
-        fd.restitution = 1.0f;
-        wall.body->CreateFixture(&fd);
+        reshapeFixture(wall.body, box);
+
+        // Las que vienen después la tienen que ver con el tamaño nuevo
+        if (useGrid) insertWallInGrid(i);
     }
 }
 
 void PhysicsWorld::updateMovingPlatforms(float dt) {
     if (isPaused) return;
+    ProfileScope timer(profiler, ProfileStage::MovingPlatforms);
+
+    // Acá nadie cambia de tamaño ni de lugar (solo de velocidad): la grilla queda fija
+    bool useGrid = false;
+    for (const CustomWall& wall : customWalls) {
+        if (wall.isMoving && wall.reverseOnContact) { useGrid = true; break; }
+    }
+    if (useGrid) buildWallGrid();
 
     for (size_t i = 0; i < customWalls.size(); ++i) {
         CustomWall& wall = customWalls[i];
@@ -1080,7 +1209,8 @@ void PhysicsWorld::updateMovingPlatforms(float dt) {
             float myHalfW = wall.width / 2.0f;
             float myHalfH = wall.height / 2.0f;
             
-            for (size_t j = 0; j < customWalls.size(); ++j) {
+            wallGrid.query(nextPos.x - myHalfW, nextPos.y - myHalfH, nextPos.x + myHalfW, nextPos.y + myHalfH, gridCandidates);
+            for (uint32_t j : gridCandidates) {
                 if (i == j) continue; 
                 
                 const CustomWall& other = customWalls[j];
@@ -1124,16 +1254,24 @@ void PhysicsWorld::updateMovingPlatforms(float dt) {
     }
 }
 
-std::vector<CustomWall>& PhysicsWorld::getCustomWalls() { return customWalls; }
+SlotMap<CustomWall>& PhysicsWorld::getCustomWalls() { return customWalls; }
 b2Body* PhysicsWorld::getWinZoneBody() const { return winZoneBody; }
-void PhysicsWorld::createWinZone() { b2BodyDef bd; bd.type=b2_staticBody; winZonePos[0]=worldWidthMeters/1.0f; winZonePos[1]=worldHeightMeters*0.8f; bd.position.Set(winZonePos[0], winZonePos[1]); winZoneBody=world.CreateBody(&bd); b2PolygonShape b; b.SetAsBox(winZoneSize[0]/2, winZoneSize[1]/2); b2FixtureDef fd; fd.shape=&b; fd.isSensor=true; winZoneBody->CreateFixture(&fd); contactListener.winZoneBody=winZoneBody; }
-void PhysicsWorld::updateWinZone(float x, float y, float w, float h) { if(!winZoneBody)return; winZoneBody->SetTransform(b2Vec2(x,y),0); winZoneBody->DestroyFixture(winZoneBody->GetFixtureList()); b2PolygonShape b; b.SetAsBox(w/2,h/2); b2FixtureDef fd; fd.shape=&b; fd.isSensor=true; winZoneBody->CreateFixture(&fd); winZonePos[0]=x;winZonePos[1]=y;winZoneSize[0]=w;winZoneSize[1]=h; }
-void PhysicsWorld::updateRacerSize(float newSize) { currentRacerSize=newSize; for(b2Body* b:dynamicBodies){ b->DestroyFixture(b->GetFixtureList()); b2PolygonShape s; s.SetAsBox(newSize/2,newSize/2); b2FixtureDef fd; fd.shape=&s; fd.density=1; fd.friction=currentFriction; fd.restitution=currentRestitution; b->CreateFixture(&fd); b->SetAwake(true); } }
-void PhysicsWorld::updateRestitution(float newRest) { currentRestitution=newRest; for(auto b:dynamicBodies) for(auto f=b->GetFixtureList();f;f=f->GetNext()) f->SetRestitution(newRest); }
-void PhysicsWorld::updateFriction(float newFriction) { currentFriction=newFriction; for(auto b:dynamicBodies) for(auto f=b->GetFixtureList();f;f=f->GetNext()) f->SetFriction(newFriction); }
-void PhysicsWorld::updateFixedRotation(bool fixed) { currentFixedRotation=fixed; for(auto b:dynamicBodies) { b->SetFixedRotation(fixed); b->SetAwake(true); } }
+void PhysicsWorld::createWinZone() { b2BodyDef bd; bd.type=b2_staticBody; winZonePos[0]=worldWidthMeters/1.0f; winZonePos[1]=worldHeightMeters*0.8f; bd.position.Set(winZonePos[0], winZonePos[1]); winZoneBody=world->CreateBody(&bd); tagBody(winZoneBody, EntityKind::WinZone, 0); b2PolygonShape b; b.SetAsBox(winZoneSize[0]/2, winZoneSize[1]/2); b2FixtureDef fd; fd.shape=&b; fd.isSensor=true; winZoneBody->CreateFixture(&fd); contactListener.winZoneBody=winZoneBody; }
+void PhysicsWorld::updateWinZone(float x, float y, float w, float h) { if(!winZoneBody)return; EditScope scope(*this); recordEdit(EditType::WinZone, SlotHandle(), {x, y, w, h}); winZoneBody->SetTransform(b2Vec2(x,y),0); b2PolygonShape b; b.SetAsBox(w/2,h/2); reshapeFixture(winZoneBody, b); winZonePos[0]=x;winZonePos[1]=y;winZoneSize[0]=w;winZoneSize[1]=h; }
+void PhysicsWorld::updateRacerSize(float newSize) { EditScope scope(*this); recordEdit(EditType::RacerSize, SlotHandle(), {newSize}); currentRacerSize=newSize; for(b2Body* b:dynamicBodies){ b2PolygonShape s; s.SetAsBox(newSize/2,newSize/2); reshapeFixture(b, s); b->SetAwake(true); } }
+void PhysicsWorld::updateRestitution(float newRest) { EditScope scope(*this); recordEdit(EditType::Restitution, SlotHandle(), {newRest}); currentRestitution=newRest; for(auto b:dynamicBodies) for(auto f=b->GetFixtureList();f;f=f->GetNext()) f->SetRestitution(newRest); }
+void PhysicsWorld::updateFriction(float newFriction) { EditScope scope(*this); recordEdit(EditType::Friction, SlotHandle(), {newFriction}); currentFriction=newFriction; for(auto b:dynamicBodies) for(auto f=b->GetFixtureList();f;f=f->GetNext()) f->SetFriction(newFriction); }
+void PhysicsWorld::updateFixedRotation(bool fixed) { EditScope scope(*this); recordEdit(EditType::FixedRotation, SlotHandle(), {(double)fixed}); currentFixedRotation=fixed; for(auto b:dynamicBodies) { b->SetFixedRotation(fixed); b->SetAwake(true); } }
 const std::vector<b2Body*>& PhysicsWorld::getDynamicBodies() const { return dynamicBodies; }
 void PhysicsWorld::resetRacers() { 
+    EditScope scope(*this);
+    recordEdit(EditType::ResetRacers);
+
+    // Misma semilla, misma carrera: sin esto RESET RACE seguía con el RNG donde quedó
+    rng.seed(seed);
+    fxRng.seed(1337);
+    currentNoteIndex = 0;
+
     // --- REVIVIR A TODOS ---
 for(auto& status : racerStatus) {
         status.isAlive = true;
@@ -1141,6 +1279,8 @@ for(auto& status : racerStatus) {
         status.isFinishing = false; // <---
         status.finishTimer = 0.0f;  // <---
         status.hasKnife = false;     // <---
+        status.deathCause = DeathCause::None;
+        status.killerIndex = -1;
     }
 
     for(auto& k : knives) {
@@ -1168,16 +1308,19 @@ for(auto& status : racerStatus) {
     isPaused = true; 
 }
 
-void PhysicsWorld::duplicateCustomWall(int index) {
-    if (index < 0 || index >= customWalls.size()) return;
+WallHandle PhysicsWorld::duplicateCustomWall(WallHandle handle) {
+    const CustomWall* source = customWalls.get(handle);
+    if (!source) return WallHandle();
+    EditScope scope(*this);
 
-    const CustomWall& original = customWalls[index];
+    // Copia, no referencia: addCustomWall puede realocar el arreglo denso
+    const CustomWall original = *source;
     b2Vec2 pos = original.body->GetPosition();
 
     // Creamos la pared base desfasada 1 metro en X e Y para que se note en pantalla
-    addCustomWall(pos.x + 1.0f, pos.y + 1.0f, original.width, original.height, original.soundID, original.shapeType, original.rotation);
+    WallHandle newHandle = addCustomWall(pos.x + 1.0f, pos.y + 1.0f, original.width, original.height, original.soundID, original.shapeType, original.rotation);
 
-    CustomWall& newWall = customWalls.back();
+    CustomWall& newWall = *customWalls.get(newHandle);
 
     // --- COPIAMOS TODAS LAS PROPIEDADES A MANO ---
     newWall.isExpandable = original.isExpandable;
@@ -1185,7 +1328,7 @@ void PhysicsWorld::duplicateCustomWall(int index) {
     newWall.expansionSpeed = original.expansionSpeed;
     newWall.expansionAxis = original.expansionAxis;
     newWall.stopOnContact = original.stopOnContact;
-    newWall.stopTargetIdx = original.stopTargetIdx;
+    newWall.stopTarget = original.stopTarget;
     newWall.maxSize = original.maxSize;
     newWall.isDeadly = original.isDeadly;
 
@@ -1209,6 +1352,8 @@ void PhysicsWorld::duplicateCustomWall(int index) {
     if (newWall.isMoving) {
         newWall.body->SetType(b2_kinematicBody);
     }
+    recordEdit(EditType::WallDuplicate, handle, {(double)newHandle.index, (double)newHandle.generation});
+    return newHandle;
 }
 
 void PhysicsWorld::createWalls(float widthPixels, float heightPixels) {
@@ -1243,7 +1388,8 @@ void PhysicsWorld::createRacers() {
         bd.bullet = true; 
         bd.fixedRotation = currentFixedRotation; 
         bd.position.Set((worldWidthMeters/5.0f)*(i+1), worldHeightMeters/2.0f); 
-        b2Body* bod = world.CreateBody(&bd); 
+        b2Body* bod = world->CreateBody(&bd); 
+        tagBody(bod, EntityKind::Racer, (uint32_t)dynamicBodies.size());
         bod->CreateFixture(&fd); 
         bod->SetLinearVelocity(b2Vec2(targetSpeed, targetSpeed)); 
         dynamicBodies.push_back(bod); 
@@ -1261,8 +1407,7 @@ void PhysicsWorld::loadSong(const std::string& filename) {
         return;
     }
 
-    songNotes.clear();
-    currentNoteIndex = 0;
+    std::vector<int> notes;
     std::string line;
     bool readingNotes = false;
 
@@ -1277,11 +1422,501 @@ void PhysicsWorld::loadSong(const std::string& filename) {
         if (readingNotes) {
             try {
                 int note = std::stoi(line);
-                songNotes.push_back(note);
+                notes.push_back(note);
             } catch (...) {}
         }
     }
-    
-    isSongLoaded = !songNotes.empty();
+
+    setSongNotes(notes);
     std::cout << "Cancion cargada! Notas: " << songNotes.size() << std::endl;
-}
\ No newline at end of file
+}
+
+void PhysicsWorld::setSongNotes(const std::vector<int>& notes) {
+    EditScope scope(*this);
+    songNotes = notes;
+    currentNoteIndex = 0;
+    isSongLoaded = !songNotes.empty();
+    recordEdit(EditType::SongLoad, SlotHandle(), std::vector<double>(songNotes.begin(), songNotes.end()));
+}
+// --- REPLAY: AJUSTES, EDICIONES Y HUELLA ---
+
+bool PhysicsSettings::operator==(const PhysicsSettings& o) const {
+    return targetSpeed == o.targetSpeed && enforceSpeed == o.enforceSpeed
+        && enableGravity == o.enableGravity && stopOnFirstWin == o.stopOnFirstWin
+        && finishDelay == o.finishDelay && enableChaos == o.enableChaos
+        && chaosChance == o.chaosChance && chaosBoost == o.chaosBoost;
+}
+
+bool WallProps::operator==(const WallProps& o) const {
+    return isDeadly == o.isDeadly && isExpandable == o.isExpandable
+        && expansionDelay == o.expansionDelay && expansionSpeed == o.expansionSpeed
+        && expansionAxis == o.expansionAxis && stopOnContact == o.stopOnContact
+        && stopTarget == o.stopTarget && maxSize == o.maxSize
+        && isMoving == o.isMoving && pointA == o.pointA && pointB == o.pointB
+        && moveSpeed == o.moveSpeed && reverseOnContact == o.reverseOnContact
+        && freeBounce == o.freeBounce && isFreeBouncing == o.isFreeBouncing
+        && isDestructible == o.isDestructible && maxHits == o.maxHits
+        && currentHits == o.currentHits && useTextForHP == o.useTextForHP;
+}
+
+// El orden de los valores ES el formato del archivo de replay: agregar siempre al final
+static std::vector<double> settingsToValues(const PhysicsSettings& s) {
+    return { s.targetSpeed, (double)s.enforceSpeed, (double)s.enableGravity, (double)s.stopOnFirstWin,
+             s.finishDelay, (double)s.enableChaos, s.chaosChance, s.chaosBoost };
+}
+
+static PhysicsSettings settingsFromValues(const std::vector<double>& v) {
+    PhysicsSettings s;
+    if (v.size() < 8) return s;
+    s.targetSpeed = (float)v[0];
+    s.enforceSpeed = v[1] != 0.0;
+    s.enableGravity = v[2] != 0.0;
+    s.stopOnFirstWin = v[3] != 0.0;
+    s.finishDelay = (float)v[4];
+    s.enableChaos = v[5] != 0.0;
+    s.chaosChance = (float)v[6];
+    s.chaosBoost = (float)v[7];
+    return s;
+}
+
+static std::vector<double> wallPropsToValues(const WallProps& p) {
+    return { (double)p.isDeadly, (double)p.isExpandable, p.expansionDelay, p.expansionSpeed,
+             (double)p.expansionAxis, (double)p.stopOnContact,
+             (double)p.stopTarget.index, (double)p.stopTarget.generation, p.maxSize,
+             (double)p.isMoving, p.pointA.x, p.pointA.y, p.pointB.x, p.pointB.y, p.moveSpeed,
+             (double)p.reverseOnContact, (double)p.freeBounce, (double)p.isFreeBouncing,
+             (double)p.isDestructible, (double)p.maxHits, (double)p.currentHits, (double)p.useTextForHP };
+}
+
+static bool wallPropsFromValues(const std::vector<double>& v, WallProps& p) {
+    if (v.size() < 22) return false;
+    p.isDeadly = v[0] != 0.0;
+    p.isExpandable = v[1] != 0.0;
+    p.expansionDelay = (float)v[2];
+    p.expansionSpeed = (float)v[3];
+    p.expansionAxis = (int)v[4];
+    p.stopOnContact = v[5] != 0.0;
+    p.stopTarget = {(uint32_t)v[6], (uint32_t)v[7]};
+    p.maxSize = (float)v[8];
+    p.isMoving = v[9] != 0.0;
+    p.pointA.Set((float)v[10], (float)v[11]);
+    p.pointB.Set((float)v[12], (float)v[13]);
+    p.moveSpeed = (float)v[14];
+    p.reverseOnContact = v[15] != 0.0;
+    p.freeBounce = v[16] != 0.0;
+    p.isFreeBouncing = v[17] != 0.0;
+    p.isDestructible = v[18] != 0.0;
+    p.maxHits = (int)v[19];
+    p.currentHits = (int)v[20];
+    p.useTextForHP = v[21] != 0.0;
+    return true;
+}
+
+PhysicsSettings PhysicsWorld::getSettings() const {
+    PhysicsSettings s;
+    s.targetSpeed = targetSpeed;
+    s.enforceSpeed = enforceSpeed;
+    s.enableGravity = enableGravity;
+    s.stopOnFirstWin = stopOnFirstWin;
+    s.finishDelay = finishDelay;
+    s.enableChaos = enableChaos;
+    s.chaosChance = chaosChance;
+    s.chaosBoost = chaosBoost;
+    return s;
+}
+
+void PhysicsWorld::applySettings(const PhysicsSettings& s) {
+    targetSpeed = s.targetSpeed;
+    enforceSpeed = s.enforceSpeed;
+    enableGravity = s.enableGravity;
+    stopOnFirstWin = s.stopOnFirstWin;
+    finishDelay = s.finishDelay;
+    enableChaos = s.enableChaos;
+    chaosChance = s.chaosChance;
+    chaosBoost = s.chaosBoost;
+}
+
+WallProps PhysicsWorld::getWallProps(WallHandle handle) const {
+    WallProps p;
+    const CustomWall* wallPtr = customWalls.get(handle);
+    if (!wallPtr) return p;
+    const CustomWall& w = *wallPtr;
+
+    p.isDeadly = w.isDeadly;
+    p.isExpandable = w.isExpandable;
+    p.expansionDelay = w.expansionDelay;
+    p.expansionSpeed = w.expansionSpeed;
+    p.expansionAxis = w.expansionAxis;
+    p.stopOnContact = w.stopOnContact;
+    p.stopTarget = w.stopTarget;
+    p.maxSize = w.maxSize;
+    p.isMoving = w.isMoving;
+    p.pointA = w.pointA;
+    p.pointB = w.pointB;
+    p.moveSpeed = w.moveSpeed;
+    p.reverseOnContact = w.reverseOnContact;
+    p.freeBounce = w.freeBounce;
+    p.isFreeBouncing = w.isFreeBouncing;
+    p.isDestructible = w.isDestructible;
+    p.maxHits = w.maxHits;
+    p.currentHits = w.currentHits;
+    p.useTextForHP = w.useTextForHP;
+    return p;
+}
+
+void PhysicsWorld::setWallProps(WallHandle handle, const WallProps& p) {
+    CustomWall* wallPtr = customWalls.get(handle);
+    if (!wallPtr) return;
+    EditScope scope(*this);
+    CustomWall& w = *wallPtr;
+
+    bool wasMoving = w.isMoving;
+    bool wasFreeBouncing = w.isFreeBouncing;
+
+    w.isDeadly = p.isDeadly;
+    w.isExpandable = p.isExpandable;
+    w.expansionDelay = p.expansionDelay;
+    w.expansionSpeed = p.expansionSpeed;
+    w.expansionAxis = p.expansionAxis;
+    w.stopOnContact = p.stopOnContact;
+    w.stopTarget = p.stopTarget;
+    w.maxSize = p.maxSize;
+    w.isMoving = p.isMoving;
+    w.pointA = p.pointA;
+    w.pointB = p.pointB;
+    w.moveSpeed = p.moveSpeed;
+    w.reverseOnContact = p.reverseOnContact;
+    w.freeBounce = p.freeBounce;
+    w.isFreeBouncing = p.isFreeBouncing;
+    w.isDestructible = p.isDestructible;
+    w.maxHits = p.maxHits;
+    w.currentHits = p.currentHits;
+    w.useTextForHP = p.useTextForHP;
+
+    // Lo que antes hacía el inspector a mano sobre el b2Body, solo cuando cambia el valor
+    if (w.isMoving != wasMoving) {
+        if (w.isMoving) {
+            w.body->SetType(b2_kinematicBody);
+        } else {
+            w.body->SetType(b2_staticBody);
+            w.body->SetLinearVelocity(b2Vec2(0.0f, 0.0f));
+        }
+    }
+    if (wasFreeBouncing && !w.isFreeBouncing) {
+        w.body->SetLinearVelocity(b2Vec2(0.0f, 0.0f)); // "Reset Route": arranca de nuevo hacia A/B
+    }
+
+    recordEdit(EditType::WallProps, handle, wallPropsToValues(p));
+}
+
+void PhysicsWorld::setRacerPosition(int index, float x, float y) {
+    if (index < 0 || index >= (int)dynamicBodies.size()) return;
+    EditScope scope(*this);
+    b2Body* b = dynamicBodies[index];
+    b->SetTransform(b2Vec2(x, y), b->GetAngle());
+    b->SetAwake(true);
+    recordEdit(EditType::RacerPos, {(uint32_t)index, 0}, {x, y});
+}
+
+void PhysicsWorld::setRacerVelocity(int index, float vx, float vy) {
+    if (index < 0 || index >= (int)dynamicBodies.size()) return;
+    EditScope scope(*this);
+    b2Body* b = dynamicBodies[index];
+    b->SetLinearVelocity(b2Vec2(vx, vy));
+    b->SetAwake(true);
+    recordEdit(EditType::RacerVel, {(uint32_t)index, 0}, {vx, vy});
+}
+
+void PhysicsWorld::setEditListener(std::function<void(const PhysicsEdit&)> listener) {
+    editListener = std::move(listener);
+    settingsPolled = false; // El primer poll del listener nuevo siempre manda los ajustes
+}
+
+void PhysicsWorld::pollSettings() {
+    if (!editListener) return;
+
+    PhysicsSettings current = getSettings();
+    if (settingsPolled && current == lastSettings) return;
+
+    settingsPolled = true;
+    lastSettings = current;
+    editListener({EditType::Settings, SlotHandle(), settingsToValues(current)});
+}
+
+void PhysicsWorld::recordEdit(EditType type, SlotHandle handle, std::vector<double> values) {
+    if (!editListener || editDepth > 1) return;
+
+    // Si el editor tocó algún ajuste antes de esta edición, que quede antes en el journal
+    pollSettings();
+    editListener({type, handle, std::move(values)});
+}
+
+void PhysicsWorld::applyEdit(const PhysicsEdit& edit) {
+    const std::vector<double>& v = edit.values;
+    auto val = [&v](size_t i) { return i < v.size() ? v[i] : 0.0; };
+    // Mismo mundo de partida + mismas ediciones = mismo slot. Si no, algo se desincronizó.
+    auto checkSlot = [](SlotHandle got, SlotHandle recorded, const char* what) {
+        if (got != recorded) std::cerr << "[REPLAY] Pah, " << what << " cayo en otro slot: el replay puede divergir" << std::endl;
+    };
+
+    switch (edit.type) {
+        case EditType::Settings: applySettings(settingsFromValues(v)); break;
+        case EditType::WallAdd: {
+            WallHandle h = addCustomWall((float)val(0), (float)val(1), (float)val(2), (float)val(3),
+                                         (int)val(4), (int)val(5), (float)val(6));
+            checkSlot(h, edit.handle, "la pared nueva");
+            break;
+        }
+        case EditType::WallUpdate:
+            updateCustomWall(edit.handle, (float)val(0), (float)val(1), (float)val(2), (float)val(3),
+                             (int)val(4), (int)val(5), (float)val(6));
+            break;
+        case EditType::WallRemove: removeCustomWall(edit.handle); break;
+        case EditType::WallDuplicate: {
+            WallHandle h = duplicateCustomWall(edit.handle);
+            checkSlot(h, {(uint32_t)val(0), (uint32_t)val(1)}, "la pared duplicada");
+            break;
+        }
+        case EditType::WallColor: updateWallColor(edit.handle, (int)val(0)); break;
+        case EditType::WallProps: {
+            WallProps p;
+            if (wallPropsFromValues(v, p)) setWallProps(edit.handle, p);
+            break;
+        }
+        case EditType::KnifeAdd: {
+            KnifeHandle h = addKnife((float)val(0), (float)val(1));
+            checkSlot(h, edit.handle, "el cuchillo nuevo");
+            break;
+        }
+        case EditType::KnifeRemove: removeKnife(edit.handle); break;
+        case EditType::KnifePos: updateKnifePos(edit.handle, (float)val(0), (float)val(1)); break;
+        case EditType::WinZone: updateWinZone((float)val(0), (float)val(1), (float)val(2), (float)val(3)); break;
+        case EditType::RacerSize: updateRacerSize((float)val(0)); break;
+        case EditType::Restitution: updateRestitution((float)val(0)); break;
+        case EditType::Friction: updateFriction((float)val(0)); break;
+        case EditType::FixedRotation: updateFixedRotation(val(0) != 0.0); break;
+        case EditType::RacerPos: setRacerPosition((int)edit.handle.index, (float)val(0), (float)val(1)); break;
+        case EditType::RacerVel: setRacerVelocity((int)edit.handle.index, (float)val(0), (float)val(1)); break;
+        case EditType::ResetRacers: resetRacers(); break;
+        case EditType::SongLoad: setSongNotes(std::vector<int>(v.begin(), v.end())); break;
+    }
+}
+
+uint64_t PhysicsWorld::stateChecksum() const {
+    // FNV-1a sobre los bits crudos: un float que difiere en el último bit ya cambia la huella
+    uint64_t hash = 14695981039346656037ull;
+    auto mix = [&hash](const void* data, size_t size) {
+        const unsigned char* bytes = (const unsigned char*)data;
+        for (size_t i = 0; i < size; ++i) {
+            hash ^= bytes[i];
+            hash *= 1099511628211ull;
+        }
+    };
+
+    for (size_t i = 0; i < dynamicBodies.size(); ++i) {
+        const b2Body* b = dynamicBodies[i];
+        b2Vec2 pos = b->GetPosition();
+        b2Vec2 vel = b->GetLinearVelocity();
+        float angle = b->GetAngle();
+        mix(&pos.x, sizeof(float)); mix(&pos.y, sizeof(float));
+        mix(&vel.x, sizeof(float)); mix(&vel.y, sizeof(float));
+        mix(&angle, sizeof(float));
+
+        const RacerStatus& st = racerStatus[i];
+        int flags[4] = { st.isAlive, st.hasFinished, (int)st.deathCause, st.killerIndex };
+        mix(flags, sizeof(flags));
+    }
+
+    int32_t tail[2] = { winnerIndex, (int32_t)customWalls.size() };
+    mix(tail, sizeof(tail));
+    return hash;
+}
+
+// --- SNAPSHOTS ---
+
+static void captureBody(const b2Body* body, BodySnapshot& out) {
+    out.type = body->GetType();
+    out.position = body->GetPosition();
+    out.angle = body->GetAngle();
+    out.linearVelocity = body->GetLinearVelocity();
+    out.angularVelocity = body->GetAngularVelocity();
+    out.enabled = body->IsEnabled();
+    out.awake = body->IsAwake();
+    out.fixedRotation = body->IsFixedRotation();
+    out.bullet = body->IsBullet();
+
+    const b2Fixture* f = body->GetFixtureList();
+    if (f && f->GetType() == b2Shape::e_polygon) {
+        out.shape = *static_cast<const b2PolygonShape*>(f->GetShape());
+        out.density = f->GetDensity();
+        out.friction = f->GetFriction();
+        out.restitution = f->GetRestitution();
+        out.isSensor = f->IsSensor();
+    }
+}
+
+b2Body* PhysicsWorld::createBodyFromSnapshot(const BodySnapshot& s) {
+    b2BodyDef bd;
+    bd.type = s.type;
+    bd.position = s.position;
+    bd.angle = s.angle;
+    bd.linearVelocity = s.linearVelocity;
+    bd.angularVelocity = s.angularVelocity;
+    bd.enabled = s.enabled;
+    bd.awake = s.awake;
+    bd.fixedRotation = s.fixedRotation;
+    bd.bullet = s.bullet;
+    b2Body* body = world->CreateBody(&bd);
+
+    b2FixtureDef fd;
+    fd.shape = &s.shape;
+    fd.density = s.density;
+    fd.friction = s.friction;
+    fd.restitution = s.restitution;
+    fd.isSensor = s.isSensor;
+    body->CreateFixture(&fd);
+    return body;
+}
+
+b2Body* PhysicsWorld::bodyFromTag(uintptr_t packedTag) const {
+    EntityHandle tag = unpackBodyTag(packedTag);
+    switch (tag.kind) {
+        case EntityKind::Wall: {
+            const CustomWall* wall = customWalls.get(tag.slot());
+            return wall ? wall->body : nullptr;
+        }
+        case EntityKind::Knife: {
+            const KnifeItem* knife = knives.get(tag.slot());
+            return knife ? knife->body : nullptr;
+        }
+        case EntityKind::Racer: return tag.index < dynamicBodies.size() ? dynamicBodies[tag.index] : nullptr;
+        case EntityKind::WinZone: return winZoneBody;
+        default: return nullptr;
+    }
+}
+
+void PhysicsWorld::captureSnapshot(PhysicsSnapshot& out) const {
+    out.step = stepCount;
+    out.settings = getSettings();
+    out.racerSize = currentRacerSize;
+    out.restitution = currentRestitution;
+    out.friction = currentFriction;
+    out.fixedRotation = currentFixedRotation;
+    for (int i = 0; i < 2; ++i) {
+        out.winZonePos[i] = winZonePos[i];
+        out.winZoneSize[i] = winZoneSize[i];
+    }
+    out.winZoneGlow = winZoneGlow;
+
+    out.gameOver = gameOver;
+    out.winnerIndex = winnerIndex;
+    out.currentNoteIndex = currentNoteIndex;
+    out.rng = rng; // mt19937 se copia entero: el próximo número sale igual
+    out.fxRng = fxRng;
+
+    out.walls = customWalls;
+    out.wallBodies.resize(customWalls.size());
+    for (size_t i = 0; i < customWalls.size(); ++i) captureBody(customWalls[i].body, out.wallBodies[i]);
+
+    out.knives = knives;
+    out.knifeBodies.resize(knives.size());
+    for (size_t i = 0; i < knives.size(); ++i) captureBody(knives[i].body, out.knifeBodies[i]);
+
+    out.racerBodies.resize(dynamicBodies.size());
+    for (size_t i = 0; i < dynamicBodies.size(); ++i) captureBody(dynamicBodies[i], out.racerBodies[i]);
+    out.racerStatus = racerStatus;
+    captureBody(winZoneBody, out.winZoneBody);
+
+    auto tagOf = [](const b2Body* b) { return b->GetUserData().pointer; };
+    out.wallsHit.clear();
+    for (b2Body* b : contactListener.wallsHit) out.wallsHit.push_back(tagOf(b));
+    out.reachedWinZone.clear();
+    for (b2Body* b : contactListener.bodiesReachedWinZone) out.reachedWinZone.push_back(tagOf(b));
+    out.pendingPickups.clear();
+    for (const auto& ev : contactListener.pendingPickups) out.pendingPickups.push_back({tagOf(ev.racer), tagOf(ev.knife)});
+    out.pendingKills.clear();
+    for (const auto& ev : contactListener.pendingKills) out.pendingKills.push_back({tagOf(ev.killer), tagOf(ev.victim)});
+}
+
+void PhysicsWorld::restoreSnapshot(const PhysicsSnapshot& snap) {
+    EditScope scope(*this);
+
+    // Mundo nuevo, con los cuerpos creados siempre en el mismo orden:
+    // restaurar dos veces la misma foto da exactamente la misma continuación
+    world = std::make_unique<b2World>(b2Vec2(0.0f, 0.0f));
+    particles.clear();
+    contactListener.bodiesToCheck.clear();
+    contactListener.wallsHit.clear();
+    contactListener.bodiesReachedWinZone.clear();
+    contactListener.collisionEvents.clear();
+    contactListener.pendingPickups.clear();
+    contactListener.pendingKills.clear();
+
+    applySettings(snap.settings);
+    currentRacerSize = snap.racerSize;
+    currentRestitution = snap.restitution;
+    currentFriction = snap.friction;
+    currentFixedRotation = snap.fixedRotation;
+    for (int i = 0; i < 2; ++i) {
+        winZonePos[i] = snap.winZonePos[i];
+        winZoneSize[i] = snap.winZoneSize[i];
+    }
+    winZoneGlow = snap.winZoneGlow;
+
+    gameOver = snap.gameOver;
+    winnerIndex = snap.winnerIndex;
+    currentNoteIndex = snap.currentNoteIndex;
+    stepCount = snap.step;
+    rng = snap.rng;
+    fxRng = snap.fxRng;
+    if (gameOver) isPaused = true;
+
+    customWalls = snap.walls;
+    for (size_t i = 0; i < customWalls.size(); ++i) {
+        customWalls[i].body = createBodyFromSnapshot(snap.wallBodies[i]);
+        tagBody(customWalls[i].body, EntityKind::Wall, customWalls.handleAt(i));
+    }
+
+    winZoneBody = createBodyFromSnapshot(snap.winZoneBody);
+    tagBody(winZoneBody, EntityKind::WinZone, 0);
+    contactListener.winZoneBody = winZoneBody;
+
+    dynamicBodies.clear();
+    for (size_t i = 0; i < snap.racerBodies.size(); ++i) {
+        b2Body* body = createBodyFromSnapshot(snap.racerBodies[i]);
+        tagBody(body, EntityKind::Racer, (uint32_t)i);
+        dynamicBodies.push_back(body);
+    }
+    racerStatus = snap.racerStatus;
+
+    knives = snap.knives;
+    for (size_t i = 0; i < knives.size(); ++i) {
+        knives[i].body = createBodyFromSnapshot(snap.knifeBodies[i]);
+        tagBody(knives[i].body, EntityKind::Knife, knives.handleAt(i));
+    }
+
+    // CONTACTOS: un Step(0) arma la lista de contactos y su estado "tocando" a partir de
+    // la geometría, sin mover nada (con dt = 0 Box2D no resuelve). Va SIN listener: esos
+    // pares ya se estaban tocando en la foto, así que no es un choque nuevo (ni nota, ni golpe).
+    // Lo que no se recupera son los impulsos de warm-starting: Box2D 2.4 no deja setear
+    // el dt anterior, así que el primer step arranca en frío como en un mundo recién hecho.
+    world->Step(0.0f, 0, 0);
+    world->SetContactListener(&contactListener);
+
+    for (uintptr_t tag : snap.wallsHit) {
+        if (b2Body* b = bodyFromTag(tag)) contactListener.wallsHit.insert(b);
+    }
+    for (uintptr_t tag : snap.reachedWinZone) {
+        if (b2Body* b = bodyFromTag(tag)) contactListener.bodiesReachedWinZone.insert(b);
+    }
+    for (const auto& [racer, knife] : snap.pendingPickups) {
+        b2Body* r = bodyFromTag(racer);
+        b2Body* k = bodyFromTag(knife);
+        if (r && k) contactListener.pendingPickups.push_back({r, k});
+    }
+    for (const auto& [killer, victim] : snap.pendingKills) {
+        b2Body* a = bodyFromTag(killer);
+        b2Body* b = bodyFromTag(victim);
+        if (a && b) contactListener.pendingKills.push_back({a, b});
+    }
+}
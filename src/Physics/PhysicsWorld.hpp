@@ -7,21 +7,27 @@
 #include <random>
 #include <set>
 #include <string>
+#include <memory>
+#include <functional>
 #include "../Sound/SoundManager.hpp" 
+#include "EntityHandle.hpp"
+#include "SlotMap.hpp"
+#include "ParticlePool.hpp"
+#include "WallGrid.hpp"
+#include "MapFile.hpp"
+#include "../Utils/Profiler.hpp"
+
+// Handles estables para el editor/UI: no se corren cuando se borra otra pared
+using WallHandle = SlotHandle;
+using KnifeHandle = SlotHandle;
 
 struct CollisionEvent {
     b2Vec2 point;
     b2Vec2 normal;
-    b2Body* racer;
-    b2Body* wall;
-};
-
-struct Particle {
-    sf::Vector2f position;
-    sf::Vector2f velocity;
-    sf::Color color;
-    float life;
-    float maxLife;
+    // Etiquetas leídas en el momento del choque: el b2Body puede no existir
+    // más cuando se procesan las chispas (paredes destructibles)
+    EntityHandle racer;
+    EntityHandle wall;
 };
 
 // --- ESTRUCTURAS DE ARMAS ---
@@ -43,6 +49,9 @@ struct KillEvent {
     b2Body* victim;
 };
 
+// Cómo murió un racer (para el log de carreras headless)
+enum class DeathCause { None, Spike, Crush, Knife };
+
 struct RacerStatus {
     bool isAlive = true;
     bool hasFinished = false; // <--- NUEVO
@@ -50,6 +59,8 @@ struct RacerStatus {
     float finishTimer = 0.0f; // <--- CRONÓMETRO
     b2Vec2 deathPos = {0, 0};
     bool hasKnife = false;
+    DeathCause deathCause = DeathCause::None;
+    int killerIndex = -1; // Solo para muertes con cuchillo
 };
 
 struct CustomWall {
@@ -66,7 +77,7 @@ struct CustomWall {
     float timeAlive = 0.0f;
 
     bool stopOnContact = false;
-    int stopTargetIdx = -1;
+    WallHandle stopTarget; // Inválido = frena con cualquier pared
     float maxSize = 0.0f;
     bool isDeadly = false;
     
@@ -99,11 +110,13 @@ struct CustomWall {
 
 class ChaosContactListener : public b2ContactListener {
 public:
-    std::set<b2Body*> bodiesToCheck;
-    std::set<b2Body*> wallsHit;
+    // Ordenados por etiqueta, no por puntero: así se recorren igual en toda corrida
+    std::set<b2Body*, BodyTagLess> bodiesToCheck;
+    std::set<b2Body*, BodyTagLess> wallsHit;
     b2Body* winZoneBody = nullptr;
-    std::set<b2Body*> bodiesReachedWinZone;
+    std::set<b2Body*, BodyTagLess> bodiesReachedWinZone;
     std::vector<CollisionEvent> collisionEvents;
+    bool recordCollisionEvents = true; // En headless nadie consume las chispas
     
     SoundManager* soundManager = nullptr;
     float worldWidth = 10.0f; 
@@ -114,6 +127,126 @@ public:
     void BeginContact(b2Contact* contact) override; 
 };
 
+// --- REPLAY: AJUSTES Y EDICIONES ---
+// Lo que el editor toca a mano sobre los campos públicos (sin pasar por un método).
+// Se compara antes de cada step y cada edición: si cambió, va al journal.
+struct PhysicsSettings {
+    float targetSpeed = 8.0f;
+    bool enforceSpeed = true;
+    bool enableGravity = false;
+    bool stopOnFirstWin = true;
+    float finishDelay = 0.25f;
+    bool enableChaos = false;
+    float chaosChance = 0.05f;
+    float chaosBoost = 1.5f;
+
+    bool operator==(const PhysicsSettings& o) const;
+    bool operator!=(const PhysicsSettings& o) const { return !(*this == o); }
+};
+
+// Propiedades de comportamiento de una pared que el inspector edita en caliente
+struct WallProps {
+    bool isDeadly = false;
+    bool isExpandable = false;
+    float expansionDelay = 2.0f;
+    float expansionSpeed = 0.5f;
+    int expansionAxis = 2;
+    bool stopOnContact = false;
+    WallHandle stopTarget;
+    float maxSize = 0.0f;
+
+    bool isMoving = false;
+    b2Vec2 pointA = {0.0f, 0.0f};
+    b2Vec2 pointB = {0.0f, 0.0f};
+    float moveSpeed = 3.0f;
+    bool reverseOnContact = false;
+    bool freeBounce = false;
+    bool isFreeBouncing = false;
+
+    bool isDestructible = false;
+    int maxHits = 3;
+    int currentHits = 3;
+    bool useTextForHP = false;
+
+    bool operator==(const WallProps& o) const;
+    bool operator!=(const WallProps& o) const { return !(*this == o); }
+};
+
+enum class EditType {
+    Settings, WallAdd, WallUpdate, WallRemove, WallDuplicate, WallColor, WallProps,
+    KnifeAdd, KnifeRemove, KnifePos, WinZone, RacerSize, Restitution, Friction,
+    FixedRotation, RacerPos, RacerVel, ResetRacers, SongLoad
+};
+
+// Una mutación hecha desde afuera entre dos steps. Todo número va como double:
+// float, int y los 32 bits de un handle entran exactos.
+struct PhysicsEdit {
+    EditType type = EditType::Settings;
+    SlotHandle handle; // Pared/cuchillo afectado (en racers: index = número de racer)
+    std::vector<double> values;
+};
+
+// --- SNAPSHOT DEL ESTADO COMPLETO ---
+// Un b2Body con su único fixture (todos los cuerpos del juego tienen uno solo)
+struct BodySnapshot {
+    b2BodyType type = b2_staticBody;
+    b2Vec2 position = {0.0f, 0.0f};
+    float angle = 0.0f;
+    b2Vec2 linearVelocity = {0.0f, 0.0f};
+    float angularVelocity = 0.0f;
+    bool enabled = true;
+    bool awake = true;
+    bool fixedRotation = false;
+    bool bullet = false;
+
+    b2PolygonShape shape; // La forma real (una pared que se expandió ya no es la del mapa)
+    float density = 0.0f;
+    float friction = 0.0f;
+    float restitution = 0.0f;
+    bool isSensor = false;
+};
+
+// Foto de TODO lo que decide cómo sigue la carrera. Restaurarla arma un b2World nuevo;
+// los contactos se reconstruyen de la geometría (ver restoreSnapshot).
+struct PhysicsSnapshot {
+    long long step = 0;
+
+    PhysicsSettings settings;
+    float racerSize = 1.0f;
+    float restitution = 1.0f;
+    float friction = 0.0f;
+    bool fixedRotation = true;
+    float winZonePos[2] = {0.0f, 0.0f};
+    float winZoneSize[2] = {2.0f, 2.0f};
+    bool winZoneGlow = true;
+
+    bool gameOver = false;
+    int winnerIndex = -1;
+    int currentNoteIndex = 0;
+    std::mt19937 rng;
+    std::mt19937 fxRng;
+
+    // Mismos slots y generaciones: los handles del editor siguen valiendo después de restaurar
+    SlotMap<CustomWall> walls;
+    std::vector<BodySnapshot> wallBodies; // En orden denso, igual que 'walls'
+    SlotMap<KnifeItem> knives;
+    std::vector<BodySnapshot> knifeBodies;
+    std::vector<BodySnapshot> racerBodies;
+    std::vector<RacerStatus> racerStatus;
+    BodySnapshot winZoneBody;
+
+    // Golpes que juntó el contact listener sin procesar (por etiqueta, no por puntero).
+    // Como step() los procesa al final, entre steps queda vacío salvo en fotos viejas.
+    std::vector<uintptr_t> wallsHit;
+    std::vector<uintptr_t> reachedWinZone;
+    std::vector<std::pair<uintptr_t, uintptr_t>> pendingPickups; // (racer, cuchillo)
+    std::vector<std::pair<uintptr_t, uintptr_t>> pendingKills;   // (asesino, víctima)
+};
+
+// Lado en píxeles del render del editor (mundo cuadrado de 24 m). Lo que simula sin
+// ventana arma el mundo con esto, así SCALE no se despega del ejecutable principal.
+constexpr float WorldRenderSize = 2160.0f;
+
 class PhysicsWorld {
 public:
     PhysicsWorld(float widthPixels, float heightPixels, SoundManager* soundMgr);
@@ -121,49 +254,66 @@ public:
     const std::vector<RacerStatus>& getRacerStatus() const { return racerStatus; }
 
     void step(float timeStep, int velocityIterations, int positionIterations);
-    void updateWallVisuals(float dt);
+    // Un tick completo de simulación: step + expansión + plataformas.
+    // Es LA secuencia que tienen que usar el editor, el headless, el offline y el replay.
+    void advance(float timeStep, int velocityIterations, int positionIterations);
+    void updateWallVisuals(float dt); // Solo el fade del flash (los golpes se procesan en step)
+    long long getStepCount() const { return stepCount; }
 
     const std::vector<b2Body*>& getDynamicBodies() const;
     b2Body* getWinZoneBody() const;
     void resetRacers();
 
-    const std::vector<Particle>& getParticles() const { return particles; }
+    const ParticlePool& getParticles() const { return particles; }
     void updateParticles(float dt); // <--- AGREGAR ESTO
+    void setProfiler(Profiler* newProfiler) { profiler = newProfiler; } // nullptr = sin medir
+    void setMaxParticles(size_t maxParticles) { particles.setCapacity(maxParticles); }
+    void setParticleSize(float halfSizePx) { particles.setQuadHalfSize(halfSizePx); }
 
     void saveMap(const std::string& filename);
-    void loadMap(const std::string& filename);
+    bool loadMap(const std::string& filename);
+    std::string saveMapToString() const;
+    bool loadMapFromString(const std::string& mapText);
+    // El mapa tal cual está (stopTarget como índice de pared) y la carga en una pasada
+    MapData exportMap() const;
+    void loadMapData(const MapData& map);
     void clearCustomWalls(); 
 
     // --- ACTUALIZADO: Aceptan shapeType y rotation ---
-    void addCustomWall(float x, float y, float w, float h, int soundID = 0, int shapeType = 0, float rotation = 0.0f);
-    void updateCustomWall(int index, float x, float y, float w, float h, int soundID, int shapeType, float rotation);
+    WallHandle addCustomWall(float x, float y, float w, float h, int soundID = 0, int shapeType = 0, float rotation = 0.0f);
+    void updateCustomWall(WallHandle handle, float x, float y, float w, float h, int soundID, int shapeType, float rotation);
     // --------------------------------------------------
     
-    void removeCustomWall(int index);
-    void duplicateCustomWall(int index);
-    std::vector<CustomWall>& getCustomWalls(); 
+    void removeCustomWall(WallHandle handle);
+    WallHandle duplicateCustomWall(WallHandle handle);
+    SlotMap<CustomWall>& getCustomWalls(); 
+    CustomWall* getWall(WallHandle handle) { return customWalls.get(handle); }
 
     static const std::vector<sf::Color>& getPalette();
-    void updateWallColor(int wallIndex, int newColorIndex);
+    void updateWallColor(WallHandle handle, int newColorIndex);
+    WallProps getWallProps(WallHandle handle) const;
+    void setWallProps(WallHandle handle, const WallProps& props);
 
     float SCALE = 30.0f;
 
     // MÉTODOS DE LOS CUCHILLOS
-    void addKnife(float x, float y);
-    void removeKnife(int index);
-    void updateKnifePos(int index, float x, float y);
+    KnifeHandle addKnife(float x, float y);
+    void removeKnife(KnifeHandle handle);
+    void updateKnifePos(KnifeHandle handle, float x, float y);
     void clearKnives();
-    std::vector<KnifeItem>& getKnives() { return knives; }
+    SlotMap<KnifeItem>& getKnives() { return knives; }
 
     int getRacerIndex(b2Body* body) const;
-    int getKnifeIndex(b2Body* body) const;
+    KnifeItem* getKnife(b2Body* body);
 
     void updateRacerSize(float newSize);
     void updateRestitution(float newRest);
     void updateFixedRotation(bool fixed);
     void updateFriction(float newFriction);
     void updateWinZone(float x, float y, float w, float h);
-    
+    void setRacerPosition(int index, float x, float y);
+    void setRacerVelocity(int index, float vx, float vy);
+
     float currentRacerSize = 1.0f;
     float currentRestitution = 1.0f;
     float currentFriction = 0.0f;
@@ -176,6 +326,10 @@ public:
     float finishDelay = 0.25f; // Segundos extra que corre después de tocar la meta
     bool isPaused = false;
 
+    // --- MODO HEADLESS ---
+    bool visualFx = true;  // false = sin chispas ni escombros (nadie los va a dibujar)
+    bool logEvents = true; // false = sin spam de muertes/victorias por consola
+
     bool enableChaos = false;
     float chaosChance = 0.05f;
     float chaosBoost = 1.5f;
@@ -191,31 +345,96 @@ public:
     void updateMovingPlatforms(float dt);
 
     void loadSong(const std::string& filename);
+    void setSongNotes(const std::vector<int>& notes);
+    const std::vector<int>& getSongNotes() const { return songNotes; }
     bool isSongLoaded = false;
 
+    // Semilla del RNG de física (chaos, monedas del enforceSpeed). Por defecto 77.
+    // resetRacers vuelve a sembrar: RESET RACE repite la misma carrera.
+    void setSeed(uint32_t newSeed);
+    uint32_t getSeed() const { return seed; }
+
+    // --- DETERMINISMO / REPLAY ---
+    // Tira el b2World entero y arma uno nuevo (bordes, meta, racers) como el constructor.
+    // Un mundo con historia (bodies borrados, proxies reciclados) no resuelve los contactos
+    // en el mismo orden que uno recién hecho: para reproducir bit a bit hay que partir de cero.
+    void rebuildWorld();
+
+    PhysicsSettings getSettings() const;
+    void applySettings(const PhysicsSettings& settings);
+
+    // Con listener, cada mutación pública (la de más afuera, no las anidadas) se reporta
+    // antes de devolver. applyEdit la vuelve a ejecutar del otro lado.
+    void setEditListener(std::function<void(const PhysicsEdit&)> listener);
+    void applyEdit(const PhysicsEdit& edit);
+
+    // Huella del estado de los racers: si dos corridas dan lo mismo, se comportaron igual
+    uint64_t stateChecksum() const;
+
+    // Foto del estado completo (reusa los buffers de 'out': pensado para un ring)
+    void captureSnapshot(PhysicsSnapshot& out) const;
+    // Vuelve a la foto. No toca isPaused (salvo gameOver) ni la canción; no va al journal.
+    void restoreSnapshot(const PhysicsSnapshot& snapshot);
+
 private:
     std::vector<int> songNotes;
     int currentNoteIndex = 0;
 
+    // Solo la mutación de más afuera llega al journal (loadMap llama a addCustomWall, etc.)
+    struct EditScope {
+        explicit EditScope(PhysicsWorld& w) : world(w) { world.editDepth++; }
+        ~EditScope() { world.editDepth--; }
+        PhysicsWorld& world;
+    };
+    void recordEdit(EditType type, SlotHandle handle = SlotHandle(), std::vector<double> values = {});
+    void pollSettings();
+    void processWallHits();
+    void simulateStep(float timeStep, int velocityIterations, int positionIterations); // El cuerpo de step()
+
+    static void applyWallColor(CustomWall& wall, int colorIndex);
+    static void setWallShape(b2PolygonShape& shape, float w, float h, int shapeType);
+    static void reshapeFixture(b2Body* body, const b2PolygonShape& shape);
+
+    b2Body* createBodyFromSnapshot(const BodySnapshot& snapshot);
+    b2Body* bodyFromTag(uintptr_t packedTag) const;
+
+    std::function<void(const PhysicsEdit&)> editListener;
+    int editDepth = 0;
+    bool settingsPolled = false;
+    PhysicsSettings lastSettings;
+    long long stepCount = 0;
+
     void createWalls(float widthPixels, float heightPixels);
     void createRacers();
     void createWinZone();
     float randomFloat(float min, float max);
+    float fxRandomFloat(float min, float max);
 
-    b2World world;
+    std::unique_ptr<b2World> world; // Puntero para poder tirarlo y armar otro (rebuildWorld)
     std::vector<b2Body*> dynamicBodies;
-    std::vector<CustomWall> customWalls;
+    SlotMap<CustomWall> customWalls;
     b2Body* winZoneBody = nullptr;
     std::vector<RacerStatus> racerStatus;
-    std::vector<Particle> particles; // <--- AGREGAR ESTO
+    ParticlePool particles; // Tope por defecto: 8192 (una explosión grande son ~100)
 
     ChaosContactListener contactListener;
+    uint32_t seed = 77;
     std::mt19937 rng;
+    std::mt19937 fxRng; // Solo para partículas: así lo visual no le roba tiradas a la física
     SoundManager* soundManager; 
+    Profiler* profiler = nullptr;
 
-    std::vector<KnifeItem> knives;
+    SlotMap<KnifeItem> knives;
 
     void spawnDebris(const CustomWall& wall);
+    std::vector<WallHandle> wallsToDestroy; // Scratch de processWallHits (sin alocar por step)
+
+    // Broadphase de los chequeos pared vs pared (se rearma en cada update que la necesite)
+    static constexpr float WallGridCellSize = 2.0f;
+    WallGrid wallGrid;
+    std::vector<uint32_t> gridCandidates;
+    void buildWallGrid();
+    void insertWallInGrid(size_t denseIndex);
 
     float worldWidthMeters;
     float worldHeightMeters;
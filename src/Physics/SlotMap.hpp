@@ -0,0 +1,157 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// --- SLOT MAP (ÍNDICES GENERACIONALES) ---
+// Los elementos viven compactos en 'dense' (iteración rápida para update/render)
+// y se referencian desde afuera con un SlotHandle que NO cambia cuando se borra otro.
+// Borrar es O(1): el último elemento ocupa el hueco y se re-apunta su slot.
+// Eso baraja el orden denso; el de inserción queda en un sello creciente por
+// elemento (insertionOrder) para que la Hierarchy y el mapa guardado no se muevan.
+// Cada vez que un slot se libera sube su generación, así un handle viejo
+// deja de resolver en vez de apuntar en silencio a otra entidad.
+
+struct SlotHandle {
+    static constexpr uint32_t InvalidIndex = 0xFFFFFFFFu;
+    // Las generaciones dan la vuelta a los 24 bits: así entran enteras en la etiqueta
+    // del b2Body (EntityHandle.hpp) y la comparación contra el handle nunca se desfasa
+    static constexpr uint32_t GenerationMask = 0xFFFFFFu;
+
+    uint32_t index = InvalidIndex;
+    uint32_t generation = 0;
+
+    bool isValid() const { return index != InvalidIndex; }
+    bool operator==(const SlotHandle& o) const { return index == o.index && generation == o.generation; }
+    bool operator!=(const SlotHandle& o) const { return !(*this == o); }
+};
+
+template <typename T>
+class SlotMap {
+public:
+    using iterator = typename std::vector<T>::iterator;
+    using const_iterator = typename std::vector<T>::const_iterator;
+
+    SlotHandle insert(T value) {
+        uint32_t slotIdx;
+        if (!freeSlots.empty()) {
+            slotIdx = freeSlots.back();
+            freeSlots.pop_back();
+        } else {
+            slotIdx = (uint32_t)slots.size();
+            slots.push_back({SlotHandle::InvalidIndex, 1}); // Generación 0 = nunca válida
+        }
+
+        slots[slotIdx].denseIndex = (uint32_t)dense.size();
+        dense.push_back(std::move(value));
+        denseToSlot.push_back(slotIdx);
+        stamps.push_back(nextStamp++);
+        return {slotIdx, slots[slotIdx].generation};
+    }
+
+    bool erase(SlotHandle h) {
+        if (!contains(h)) return false;
+
+        uint32_t hole = slots[h.index].denseIndex;
+        uint32_t last = (uint32_t)dense.size() - 1;
+
+        // El último tapa el hueco (swap-remove); su sello viaja con él
+        if (hole != last) {
+            dense[hole] = std::move(dense[last]);
+            denseToSlot[hole] = denseToSlot[last];
+            stamps[hole] = stamps[last];
+            slots[denseToSlot[hole]].denseIndex = hole;
+        }
+        dense.pop_back();
+        denseToSlot.pop_back();
+        stamps.pop_back();
+
+        slots[h.index].denseIndex = SlotHandle::InvalidIndex;
+        slots[h.index].generation = nextGeneration(slots[h.index].generation);
+        freeSlots.push_back(h.index);
+        return true;
+    }
+
+    bool contains(SlotHandle h) const {
+        return h.index < slots.size()
+            && slots[h.index].generation == h.generation
+            && slots[h.index].denseIndex != SlotHandle::InvalidIndex;
+    }
+
+    T* get(SlotHandle h) { return contains(h) ? &dense[slots[h.index].denseIndex] : nullptr; }
+    const T* get(SlotHandle h) const { return contains(h) ? &dense[slots[h.index].denseIndex] : nullptr; }
+
+    // Posición actual en el arreglo denso (-1 si el handle no resuelve).
+    // OJO: cambia cuando se borra otro elemento; sirve para el loop de turno, no para guardarse.
+    int denseIndexOf(SlotHandle h) const { return contains(h) ? (int)slots[h.index].denseIndex : -1; }
+    SlotHandle handleAt(size_t denseIndex) const {
+        uint32_t slotIdx = denseToSlot[denseIndex];
+        return {slotIdx, slots[slotIdx].generation};
+    }
+
+    // --- ORDEN DE INSERCIÓN ---
+    // Índices densos ordenados por sello: el orden que ve la Hierarchy y el que va a disco.
+    // O(n log n): para listar/guardar, no para el update ni el render.
+    std::vector<uint32_t> insertionOrder() const {
+        std::vector<uint32_t> order(dense.size());
+        for (uint32_t i = 0; i < (uint32_t)order.size(); ++i) order[i] = i;
+        std::sort(order.begin(), order.end(), [this](uint32_t a, uint32_t b) { return stamps[a] < stamps[b]; });
+        return order;
+    }
+
+    // Posición en ese orden (-1 si el handle no resuelve). O(n): para mostrar de a uno.
+    int insertionIndexOf(SlotHandle h) const {
+        if (!contains(h)) return -1;
+        uint64_t stamp = stamps[slots[h.index].denseIndex];
+        int rank = 0;
+        for (uint64_t s : stamps) rank += (s < stamp) ? 1 : 0;
+        return rank;
+    }
+
+    void clear() {
+        // Todos los slots vivos pasan a la lista libre con generación nueva
+        for (uint32_t slotIdx : denseToSlot) {
+            slots[slotIdx].denseIndex = SlotHandle::InvalidIndex;
+            slots[slotIdx].generation = nextGeneration(slots[slotIdx].generation);
+            freeSlots.push_back(slotIdx);
+        }
+        dense.clear();
+        denseToSlot.clear();
+        stamps.clear();
+    }
+
+    void reserve(size_t n) { dense.reserve(n); denseToSlot.reserve(n); stamps.reserve(n); slots.reserve(n); }
+
+    size_t size() const { return dense.size(); }
+    bool empty() const { return dense.empty(); }
+
+    T& operator[](size_t denseIndex) { return dense[denseIndex]; }
+    const T& operator[](size_t denseIndex) const { return dense[denseIndex]; }
+    T& back() { return dense.back(); }
+
+    iterator begin() { return dense.begin(); }
+    iterator end() { return dense.end(); }
+    const_iterator begin() const { return dense.begin(); }
+    const_iterator end() const { return dense.end(); }
+
+private:
+    // Generación 0 = nunca válida: al dar la vuelta se salta
+    static uint32_t nextGeneration(uint32_t generation) {
+        uint32_t next = (generation + 1) & SlotHandle::GenerationMask;
+        return next == 0 ? 1 : next;
+    }
+
+    struct Slot {
+        uint32_t denseIndex;
+        uint32_t generation;
+    };
+
+    std::vector<T> dense;
+    std::vector<uint32_t> denseToSlot;
+    std::vector<uint64_t> stamps; // Paralelo a 'dense': sello de inserción (solo crece)
+    std::vector<Slot> slots;
+    std::vector<uint32_t> freeSlots;
+    uint64_t nextStamp = 0;
+};
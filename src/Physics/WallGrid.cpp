@@ -0,0 +1,61 @@
+#include "WallGrid.hpp"
+#include <algorithm>
+#include <cmath>
+
+void WallGrid::reset(float worldWidth, float worldHeight, float newCellSize) {
+    cellSize = std::max(0.1f, newCellSize);
+    int newCols = std::max(1, (int)std::ceil(worldWidth / cellSize));
+    int newRows = std::max(1, (int)std::ceil(worldHeight / cellSize));
+
+    if (newCols != cols || newRows != rows || cells.empty()) {
+        cols = newCols;
+        rows = newRows;
+        cells.assign((size_t)cols * rows, {});
+        return;
+    }
+    for (auto& cell : cells) cell.clear();
+}
+
+int WallGrid::cellX(float x) const {
+    return std::clamp((int)std::floor(x / cellSize), 0, cols - 1);
+}
+
+int WallGrid::cellY(float y) const {
+    return std::clamp((int)std::floor(y / cellSize), 0, rows - 1);
+}
+
+void WallGrid::insert(uint32_t id, float minX, float minY, float maxX, float maxY) {
+    if (id >= seenStamp.size()) seenStamp.resize(id + 1, 0);
+
+    int x0 = cellX(minX), x1 = cellX(maxX);
+    int y0 = cellY(minY), y1 = cellY(maxY);
+    for (int cy = y0; cy <= y1; ++cy) {
+        for (int cx = x0; cx <= x1; ++cx) {
+            auto& cell = cells[(size_t)cy * cols + cx];
+            // Reinsertar la misma caja agrandada casi siempre repite celda: no la duplicamos
+            if (cell.empty() || cell.back() != id) cell.push_back(id);
+        }
+    }
+}
+
+void WallGrid::query(float minX, float minY, float maxX, float maxY, std::vector<uint32_t>& out) {
+    out.clear();
+
+    if (++stamp == 0) { // Dio la vuelta: limpiamos las marcas viejas
+        std::fill(seenStamp.begin(), seenStamp.end(), 0);
+        stamp = 1;
+    }
+
+    int x0 = cellX(minX), x1 = cellX(maxX);
+    int y0 = cellY(minY), y1 = cellY(maxY);
+    for (int cy = y0; cy <= y1; ++cy) {
+        for (int cx = x0; cx <= x1; ++cx) {
+            for (uint32_t id : cells[(size_t)cy * cols + cx]) {
+                if (seenStamp[id] == stamp) continue;
+                seenStamp[id] = stamp;
+                out.push_back(id);
+            }
+        }
+    }
+    std::sort(out.begin(), out.end());
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// --- GRILLA UNIFORME PARED vs PARED ---
+// Broadphase para los chequeos a mano de updateWallExpansion (stopOnContact) y
+// updateMovingPlatforms (reverseOnContact): antes cada pared recorría todas las demás.
+// Guarda las mismas cajas sin rotar (centro ± ancho/2, alto/2) que usan esos chequeos,
+// así los candidatos son siempre un superconjunto exacto de los que pueden chocar.
+// El árbol de Box2D no sirve para esto: sus AABB son del fixture rotado y una pared
+// larga girada 90° no encierra la caja lógica. Se rearma cada step (O(paredes)).
+// Lo que cae fuera del mundo va a la celda del borde: nunca se pierde un candidato.
+
+class WallGrid {
+public:
+    // Vacía la grilla (conserva la memoria de las celdas entre steps)
+    void reset(float worldWidth, float worldHeight, float cellSize);
+
+    // Una misma id puede insertarse varias veces (ej: la pared creció): query no repite
+    void insert(uint32_t id, float minX, float minY, float maxX, float maxY);
+
+    // Ids cuyas cajas pueden tocar la caja pedida, sin repetir y en orden creciente
+    // (mismo orden que el loop viejo: el primer choque es el mismo).
+    void query(float minX, float minY, float maxX, float maxY, std::vector<uint32_t>& out);
+
+private:
+    float cellSize = 1.0f;
+    int cols = 1;
+    int rows = 1;
+    std::vector<std::vector<uint32_t>> cells;
+
+    // Marca de la última query que vio cada id (evita un set por query)
+    std::vector<uint32_t> seenStamp;
+    uint32_t stamp = 0;
+
+    int cellX(float x) const;
+    int cellY(float y) const;
+};
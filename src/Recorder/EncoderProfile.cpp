@@ -0,0 +1,108 @@
+#include "EncoderProfile.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#ifdef _WIN32
+    #define CHAOS_NULL_REDIRECT " > NUL 2>&1"
+#else
+    #define CHAOS_NULL_REDIRECT " > /dev/null 2>&1"
+#endif
+
+const std::vector<EncoderProfile>& getBuiltinEncoderProfiles() {
+    static const std::vector<EncoderProfile> profiles = {
+        {"nvenc_hevc", "mp4", "yuv420p", true,  "-c:v hevc_nvenc -preset p7 -tune hq -rc vbr -cq 18 -b:v 0"},
+        {"nvenc_h264", "mp4", "yuv420p", true,  "-c:v h264_nvenc -preset p7 -tune hq -rc vbr -cq 18 -b:v 0"},
+        {"x264",       "mp4", "yuv420p", true,  "-c:v libx264 -preset veryfast -crf 18"},
+        {"x264_hq",    "mp4", "yuv420p", false, "-c:v libx264 -preset slow -crf 16"},
+        {"x265",       "mp4", "yuv420p", false, "-c:v libx265 -preset fast -crf 20 -tag:v hvc1"},
+        {"ffv1",       "mkv", "bgr0",    false, "-c:v ffv1 -level 3 -slices 16 -g 1"}
+    };
+    return profiles;
+}
+
+std::vector<EncoderProfile> loadEncoderProfiles(const std::string& filename, std::string& selectedName) {
+    selectedName = "auto";
+
+    std::ifstream file(filename);
+    if (!file.is_open()) return getBuiltinEncoderProfiles();
+
+    std::vector<EncoderProfile> profiles;
+    std::string line;
+    while (std::getline(file, line)) {
+        std::stringstream ss(line);
+        std::string type;
+        ss >> type;
+
+        if (type == "PROFILE") {
+            EncoderProfile p;
+            ss >> p.name >> p.container >> p.pixFmt >> p.autoCandidate;
+            std::getline(ss >> std::ws, p.codecArgs); // El resto de la línea va tal cual a ffmpeg
+            if (!p.name.empty() && !p.codecArgs.empty()) profiles.push_back(p);
+        }
+        else if (type == "USE") {
+            ss >> selectedName;
+        }
+    }
+
+    if (profiles.empty()) return getBuiltinEncoderProfiles();
+    return profiles;
+}
+
+bool probeEncoder(const EncoderProfile& profile, double* secondsOut) {
+    // 60 frames sintéticos a 540p: alcanza para que el encoder muestre la hilacha
+    // (NVENC sin placa falla al toque) sin demorar el arranque
+    std::string cmd = "ffmpeg -hide_banner -loglevel error -nostdin "
+                      "-f lavfi -i testsrc2=s=960x540:r=60 "
+                      "-frames:v 60 -vf format=" + profile.pixFmt + " " +
+                      profile.codecArgs + " -f null -" CHAOS_NULL_REDIRECT;
+
+    auto t0 = std::chrono::steady_clock::now();
+    int result = std::system(cmd.c_str());
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    if (secondsOut) *secondsOut = seconds;
+    return result == 0;
+}
+
+EncoderProfile pickEncoderProfile(const std::string& configFile) {
+    std::string selected;
+    std::vector<EncoderProfile> profiles = loadEncoderProfiles(configFile, selected);
+
+    if (const char* env = std::getenv("CHAOS_ENCODER")) selected = env;
+
+    if (selected != "auto") {
+        for (const auto& p : profiles) {
+            if (p.name == selected) {
+                std::cout << "[REC] Encoder elegido a mano: " << p.name << std::endl;
+                return p;
+            }
+        }
+        std::cerr << "[REC] No existe el perfil '" << selected << "', pruebo en automatico." << std::endl;
+    }
+
+    const EncoderProfile* best = nullptr;
+    double bestTime = 0.0;
+    for (const auto& p : profiles) {
+        if (!p.autoCandidate) continue;
+
+        double t = 0.0;
+        bool ok = probeEncoder(p, &t);
+        std::cout << "[REC] Probe " << p.name << ": " << (ok ? "OK " : "NO ") << t << "s" << std::endl;
+        if (ok && (!best || t < bestTime)) {
+            best = &p;
+            bestTime = t;
+        }
+    }
+
+    if (best) {
+        std::cout << "[REC] Encoder automatico: " << best->name << std::endl;
+        return *best;
+    }
+
+    // Ni el probe anduvo (¿no hay ffmpeg en el PATH?): vamos con software, que es lo más portable
+    std::cerr << "[REC] Pah, ningun encoder paso la prueba. Uso x264." << std::endl;
+    return getBuiltinEncoderProfiles()[2];
+}
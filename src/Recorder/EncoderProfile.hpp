@@ -0,0 +1,29 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+// --- PERFILES DE ENCODER ---
+// Antes el Recorder tenía clavado hevc_nvenc: sin placa NVIDIA no grababa nada.
+// Ahora el códec sale de un perfil (config/encoders.txt o los de fábrica) y con
+// "USE auto" se prueba cada candidato contra ffmpeg al arrancar y gana el más rápido.
+
+struct EncoderProfile {
+    std::string name = "nvenc_hevc";
+    std::string container = "mp4";   // Extensión del archivo de video (ffv1 necesita mkv)
+    std::string pixFmt = "yuv420p";  // Formato al que convierte ffmpeg después del vflip
+    bool autoCandidate = true;       // Entra en la prueba de "USE auto"
+    std::string codecArgs = "-c:v hevc_nvenc -preset p7 -tune hq -rc vbr -cq 18 -b:v 0";
+};
+
+// Los perfiles de fábrica (mismos que config/encoders.txt)
+const std::vector<EncoderProfile>& getBuiltinEncoderProfiles();
+
+// Lee perfiles y la línea USE. Si el archivo no existe devuelve los de fábrica y "auto".
+std::vector<EncoderProfile> loadEncoderProfiles(const std::string& filename, std::string& selectedName);
+
+// Codifica unos frames sintéticos a /dev/null. Devuelve false si ffmpeg no lo banca.
+bool probeEncoder(const EncoderProfile& profile, double* secondsOut = nullptr);
+
+// Perfil final: CHAOS_ENCODER > línea USE > auto (probe). Si nada anda, x264.
+EncoderProfile pickEncoderProfile(const std::string& configFile);
@@ -3,9 +3,14 @@
 #include <stdexcept>
 #include <algorithm> 
 #include <cmath>     
-#include <fstream> 
 #include <SFML/Window/Context.hpp> // Para enganchar funciones de OpenGL
 
+#ifndef _WIN32
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 // --- DEFINICIONES DE OPENGL ---
 #ifndef GL_PIXEL_PACK_BUFFER
 #define GL_PIXEL_PACK_BUFFER 0x88EB
@@ -28,34 +33,24 @@ glMapBufferFunc my_glMapBuffer = nullptr;
 glUnmapBufferFunc my_glUnmapBuffer = nullptr;
 glDeleteBuffersFunc my_glDeleteBuffers = nullptr;
 
-Recorder::Recorder(int width, int height, int fps, const std::string& outputFilename) 
-    : width(width), height(height), fps(fps), finalFilename(outputFilename) 
+Recorder::Recorder(int width, int height, int fps, const std::string& outputFilename, const RecorderOptions& options) 
+    : width(width), height(height), fps(fps), finalFilename(outputFilename), options(options) 
 {
     this->width = width + (width % 2);
     this->height = height + (height % 2);
 
-    tempVideoFilename = "temp_video_render.mp4";
-    tempAudioFilename = "temp_audio_render.wav";
+    const EncoderProfile& enc = this->options.encoder;
 
-    // --- MAGIA VERDE DE NVIDIA (NVENC HEVC) ---
-    // -vf "vflip,format=yuv420p": vflip corrige el eje Y de OpenGL, format asegura compatibilidad.
-    // -c:v hevc_nvenc: Códec H.265 por hardware NVIDIA.
-    // -preset p7 -tune hq: Calidad absolutamente máxima del encoder.
-    // -rc vbr -cq 18 -b:v 0: Calidad Constante (18 es calidad visualmente sin pérdida).
-    std::string cmd = "ffmpeg -y -loglevel warning "
-                      "-f rawvideo -vcodec rawvideo "
-                      "-s " + std::to_string(width) + "x" + std::to_string(height) + " "
-                      "-pix_fmt rgba "
-                      "-r " + std::to_string(fps) + " "
-                      "-i - "
-                      "-vf \"vflip,format=yuv420p\" " 
-                      "-c:v hevc_nvenc -preset p7 -tune hq -rc vbr -cq 18 -b:v 0 " 
-                      "\"" + tempVideoFilename + "\""; 
-
-    ffmpegPipe = popen(cmd.c_str(), "w");
-    if (!ffmpegPipe) throw std::runtime_error("No se pudo iniciar FFmpeg.");
+    // Si el contenedor del perfil no es el del archivo final (ej: FFV1 no entra en mp4), lo cambiamos
+    size_t dot = finalFilename.find_last_of('.');
+    std::string finalExt = (dot == std::string::npos) ? "" : finalFilename.substr(dot + 1);
+    if (finalExt != enc.container) {
+        finalFilename = finalFilename.substr(0, dot) + "." + enc.container;
+        std::cout << "[REC] El perfil " << enc.name << " va en ." << enc.container << ": salida -> " << finalFilename << std::endl;
+    }
 
-    audioMixBuffer.reserve(44100 * 60 * 5);
+    // Release del limitador: ~200 ms para volver a ganancia 1 después de un pico
+    limiterRelease = std::exp(-1.0f / (0.2f * sampleRate));
 
     // --- 1. CARGAMOS LAS FUNCIONES EXTENDIDAS DE OPENGL ---
     my_glGenBuffers = (glGenBuffersFunc)sf::Context::getFunction("glGenBuffers");
@@ -69,98 +64,296 @@ Recorder::Recorder(int width, int height, int fps, const std::string& outputFile
         throw std::runtime_error("Pah, la gráfica no soporta PBOs o falló la carga de OpenGL.");
     }
 
-    // --- 2. INICIALIZAMOS EL DOBLE BUFFER (PING-PONG) ---
+    // --- 2. INICIALIZAMOS EL ANILLO DE PBOs ---
+    // La mitad del anillo esperando a la GPU, la otra mitad para que FFmpeg tenga margen
+    int pboCount = std::max(2, this->options.pboCount);
+    readbackLag = std::max(1, pboCount / 2);
+
     size_t dataSize = this->width * this->height * 4;
-    my_glGenBuffers(2, pbo);
-    
-    my_glBindBuffer(GL_PIXEL_PACK_BUFFER, pbo[0]);
-    my_glBufferData(GL_PIXEL_PACK_BUFFER, dataSize, nullptr, GL_STREAM_READ);
-    
-    my_glBindBuffer(GL_PIXEL_PACK_BUFFER, pbo[1]);
-    my_glBufferData(GL_PIXEL_PACK_BUFFER, dataSize, nullptr, GL_STREAM_READ);
-    
+    std::vector<GLuint> ids(pboCount);
+    my_glGenBuffers(pboCount, ids.data());
+
+    pboSlots.resize(pboCount);
+    for (int i = 0; i < pboCount; ++i) {
+        pboSlots[i].id = ids[i];
+        my_glBindBuffer(GL_PIXEL_PACK_BUFFER, ids[i]);
+        my_glBufferData(GL_PIXEL_PACK_BUFFER, dataSize, nullptr, GL_STREAM_READ);
+    }
     my_glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
-    
+
+    // FFmpeg recién arranca con el primer frame grabado (start): abrir y cerrar
+    // el editor sin grabar no pisa el video anterior con uno vacío
+}
+
+bool Recorder::start() {
+    const EncoderProfile& enc = options.encoder;
+
+    // --- AUDIO: FIFO como segunda entrada de FFmpeg ---
+    std::string audioInput;
+#ifndef _WIN32
+    audioFifoPath = "/tmp/chaos_audio_" + std::to_string(getpid()) + ".pcm";
+    unlink(audioFifoPath.c_str());
+    if (mkfifo(audioFifoPath.c_str(), 0600) == 0) {
+        audioInput = "-f s16le -ar " + std::to_string(sampleRate) + " -ac 2 "
+                     "-probesize 32 -analyzeduration 0 -i \"" + audioFifoPath + "\" ";
+    } else {
+        audioFifoPath.clear();
+        std::cerr << "[REC] No se pudo crear la FIFO de audio: el video sale mudo." << std::endl;
+    }
+#else
+    std::cerr << "[REC] Audio en streaming no soportado en Windows: el video sale mudo." << std::endl;
+#endif
+
+    // -vf "vflip,format=...": vflip corrige el eje Y de OpenGL, format lo pide el perfil.
+    // El códec y su calidad salen del perfil (NVENC, x264/x265, FFV1 sin pérdida...)
+    // Video por stdin + audio por la FIFO, muxeados en vivo directo al archivo final.
+    std::string cmd = "ffmpeg -y -loglevel warning "
+                      "-f rawvideo -vcodec rawvideo "
+                      "-s " + std::to_string(width) + "x" + std::to_string(height) + " "
+                      "-pix_fmt rgba "
+                      "-r " + std::to_string(fps) + " "
+                      "-probesize 32 -analyzeduration 0 "
+                      "-i - "
+                      + audioInput +
+                      "-vf \"vflip,format=" + enc.pixFmt + "\" " 
+                      + enc.codecArgs + " " 
+                      + (audioInput.empty() ? "" : "-c:a aac -b:a 192k ") +
+                      "\"" + finalFilename + "\""; 
+
+    ffmpegPipe = popen(cmd.c_str(), "w");
+    if (!ffmpegPipe) {
+        std::cerr << "[REC] No se pudo iniciar FFmpeg." << std::endl;
+#ifndef _WIN32
+        if (!audioFifoPath.empty()) unlink(audioFifoPath.c_str());
+#endif
+        return false;
+    }
+
+    if (!audioFifoPath.empty()) {
+        isAudioRunning = true;
+        audioThread = std::thread(&Recorder::audioLoop, this);
+    }
+
     isWorkerRunning = true;
     workerThread = std::thread(&Recorder::workerLoop, this);
 
-    std::cout << "[REC] Grabando video 4K ASÍNCRONO por hardware (NVIDIA HEVC/H.265) en: " << tempVideoFilename << std::endl;
+    std::cout << "[REC] Grabando video 4K ASÍNCRONO (" << enc.name << ") en: " << finalFilename << std::endl;
+    return true;
 }
 
 Recorder::~Recorder() {
     stop(); 
     if (my_glDeleteBuffers) {
-        my_glDeleteBuffers(2, pbo);
+        for (auto& slot : pboSlots) my_glDeleteBuffers(1, &slot.id);
     }
 }
 
+void Recorder::reclaimDoneSlots() {
+    for (auto& slot : pboSlots) {
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            if (slot.state != PboState::Done) continue;
+        }
+        // FFmpeg ya lo escribió: lo desmapeamos (esto tiene que pasar en el hilo de GL)
+        my_glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.id);
+        my_glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+
+        std::lock_guard<std::mutex> lock(queueMutex);
+        slot.mapped = nullptr;
+        slot.state = PboState::Free;
+    }
+    my_glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+}
+
+void Recorder::queueOldestReadback() {
+    int idx = pendingReadbacks.front();
+    pendingReadbacks.pop_front();
+    PboSlot& slot = pboSlots[idx];
+
+    // Para este momento la copia DMA ya terminó: mapear no debería trabar
+    my_glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.id);
+    const sf::Uint8* ptr = (const sf::Uint8*)my_glMapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY);
+    my_glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        if (!ptr) {
+            slot.state = PboState::Free; // El driver no quiso: perdemos este frame
+            droppedFrames++;
+            return;
+        }
+        // Sin copia: FFmpeg lee directo de la memoria mapeada del PBO
+        slot.mapped = ptr;
+        slot.state = PboState::Mapped;
+        frameQueue.push(idx);
+    }
+    queueCV.notify_one();
+}
+
+void Recorder::flushPendingReadbacks() {
+    while (!pendingReadbacks.empty()) queueOldestReadback();
+}
+
 void Recorder::addFrame(const sf::Texture& texture) {
-    if (!ffmpegPipe || !isRecording) return;
+    if (!isRecording || isFinished) return;
+    // El editor previsualiza a menos resolución: un frame así no entra en el PBO
+    if (texture.getSize() != sf::Vector2u((unsigned int)width, (unsigned int)height)) {
+        std::cerr << "[REC] Frame de " << texture.getSize().x << "x" << texture.getSize().y
+                  << " descartado (se graba a " << width << "x" << height << ")" << std::endl;
+        return;
+    }
+    ProfileScope timer(profiler, ProfileStage::RecorderFrame);
+
+    // Primer frame de verdad: recién ahora se crea el archivo
+    if (!ffmpegPipe && !start()) {
+        isRecording = false;
+        return;
+    }
     currentFrame++;
-    
-    size_t dataSize = width * height * 4;
 
-    // 1. Forzamos a SFML a vincular su textura en la máquina de estados de OpenGL
-    sf::Texture::bind(&texture);
+    reclaimDoneSlots();
+
+    // 1. ¿El próximo PBO del anillo está libre? Si FFmpeg viene atrasado, no.
+    PboSlot& slot = pboSlots[pboCursor];
+    bool mustReclaim = false;
+    {
+        std::unique_lock<std::mutex> lock(queueMutex);
+        if (slot.state != PboState::Free) {
+            if (options.dropFramesWhenBehind) {
+                droppedFrames++;
+                lock.unlock();
+                emitAudioForFrame(false); // El audio sigue al video: sin frame, sin su tramo
+                return;
+            }
+            // Backpressure: esperamos a que FFmpeg suelte este buffer
+            stalledFrames++;
+            slotFreedCV.wait(lock, [&slot] { return slot.state == PboState::Done; });
+            mustReclaim = true;
+        }
+    }
+    if (mustReclaim) reclaimDoneSlots();
 
     // 2. TRANSFERENCIA ASÍNCRONA (VRAM -> PBO)
     // Le ordenamos al controlador DMA de la GPU que empiece a copiar la textura.
     // Esto NO bloquea la CPU, retorna instantáneamente.
-    my_glBindBuffer(GL_PIXEL_PACK_BUFFER, pbo[pboIndex]);
+    sf::Texture::bind(&texture);
+    my_glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.id);
     glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, 0);
+    my_glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    sf::Texture::bind(nullptr);
 
-    // 3. LEER EL FRAME ANTERIOR (PBO -> RAM)
-    if (!firstFrame) {
-        my_glBindBuffer(GL_PIXEL_PACK_BUFFER, pbo[nextPboIndex]);
-        
-        // Mapeamos la memoria del PBO que ya terminó de transferirse
-        GLubyte* ptr = (GLubyte*)my_glMapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY);
-
-        if (ptr) {
-            // Acá sí hacemos la copia a RAM, pero la info ya viajó por el PCIe
-            std::vector<sf::Uint8> buffer(ptr, ptr + dataSize);
-            my_glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
-
-            // Lo mandamos al hilo esclavo de FFmpeg
-            {
-                std::lock_guard<std::mutex> lock(queueMutex);
-                frameQueue.push(std::move(buffer));
-            }
-            queueCV.notify_one();
-        }
-    } else {
-        // Sacrificamos el primerísimo frame visual porque el PBO "next" todavía tiene basura
-        firstFrame = false; 
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        slot.state = PboState::Pending;
     }
+    pendingReadbacks.push_back(pboCursor);
+    pboCursor = (pboCursor + 1) % (int)pboSlots.size();
 
-    // 4. LIMPIEZA
-    my_glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
-    sf::Texture::bind(nullptr);
+    // 3. LOS QUE YA TUVIERON TIEMPO DE LLEGAR A RAM -> A FFMPEG
+    while ((int)pendingReadbacks.size() > readbackLag) queueOldestReadback();
+
+    // 4. El tramo de audio de este frame ya no puede cambiar: sale
+    emitAudioForFrame(true);
+}
+
+void Recorder::emitAudioForFrame(bool keep) {
+    // Los sonidos que lleguen después de este frame arrancan en currentFrame/fps,
+    // así que todo lo anterior está cerrado. Cuenta entera para no acumular deriva.
+    long long frameEnd = currentFrame * (long long)sampleRate / fps;
+    long long count = frameEnd - audioWindowStart;
+    if (count <= 0) return;
+
+    std::vector<sf::Int16> chunk;
+    if (keep) chunk.reserve((size_t)count * 2);
+
+    for (long long i = 0; i < count; ++i) {
+        float sample = 0.0f;
+        if (!audioWindow.empty()) {
+            sample = audioWindow.front() * options.audioGain;
+            audioWindow.pop_front();
+        }
+        if (!keep) continue;
+
+        // Limitador: ataque instantáneo (sin clip), release suave
+        float level = std::abs(sample);
+        limiterEnvelope = std::max(level, limiterEnvelope * limiterRelease);
+        float gain = (limiterEnvelope > 32000.0f) ? 32000.0f / limiterEnvelope : 1.0f;
 
-    // 5. CAMBIO DE ROLES (Ping-Pong)
-    pboIndex = (pboIndex + 1) % 2;
-    nextPboIndex = (pboIndex + 1) % 2;
+        float out = std::clamp(sample * gain, -32768.0f, 32767.0f);
+        sf::Int16 s = static_cast<sf::Int16>(out);
+        chunk.push_back(s);
+        chunk.push_back(s);
+    }
+    audioWindowStart = frameEnd;
+
+    if (!keep || !isAudioRunning) return;
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        audioQueue.push(std::move(chunk));
+    }
+    audioCV.notify_one();
 }
 
-// ... EL RESTO QUEDA IGUAL (workerLoop, stop, addAudioEvent) ...
+void Recorder::audioLoop() {
+#ifndef _WIN32
+    // Bloquea hasta que FFmpeg abra su lado de la FIFO
+    audioFd = open(audioFifoPath.c_str(), O_WRONLY);
+    audioFifoOpened = true;
+    unlink(audioFifoPath.c_str()); // Ya está abierta de los dos lados: no dejamos nada en /tmp
+    if (audioFd < 0) return;
+
+    while (true) {
+        std::vector<sf::Int16> chunk;
+        {
+            std::unique_lock<std::mutex> lock(queueMutex);
+            audioCV.wait(lock, [this] { return !audioQueue.empty() || !isAudioRunning; });
+            if (audioQueue.empty() && !isAudioRunning) break;
+            chunk = std::move(audioQueue.front());
+            audioQueue.pop();
+        }
+
+        const char* data = reinterpret_cast<const char*>(chunk.data());
+        size_t left = chunk.size() * sizeof(sf::Int16);
+        while (left > 0) {
+            ssize_t written = write(audioFd, data, left);
+            if (written <= 0) { left = 0; break; } // FFmpeg se murió: tiramos el resto
+            data += written;
+            left -= (size_t)written;
+        }
+    }
+
+    close(audioFd);
+    audioFd = -1;
+#endif
+}
 
 void Recorder::workerLoop() {
+    size_t dataSize = width * height * 4;
+
     while (true) {
-        std::vector<sf::Uint8> currentFrameData; // <--- AHORA SÍ ESPERAMOS UN VECTOR
+        int idx;
+        const sf::Uint8* data;
         {
             std::unique_lock<std::mutex> lock(queueMutex);
             queueCV.wait(lock, [this] { return !frameQueue.empty() || !isWorkerRunning; });
             
             if (frameQueue.empty() && !isWorkerRunning) break;
 
-            currentFrameData = std::move(frameQueue.front());
+            idx = frameQueue.front();
             frameQueue.pop();
+            data = pboSlots[idx].mapped;
         }
 
-        // Leemos directo de la memoria contigua del vector para escupirlo a FFmpeg
+        // Escupimos a FFmpeg directo desde el PBO mapeado
         if (ffmpegPipe) {
-            fwrite(currentFrameData.data(), 1, width * height * 4, ffmpegPipe); // <--- Usamos .data()
+            fwrite(data, 1, dataSize, ffmpegPipe);
         }
+
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            pboSlots[idx].state = PboState::Done;
+        }
+        slotFreedCV.notify_all();
     }
 }
 
@@ -169,6 +362,9 @@ void Recorder::stop() {
     isFinished = true;
     isRecording = false;
 
+    // Los últimos frames todavía están en PBOs esperando: los mandamos también
+    flushPendingReadbacks();
+
     // --- FRENAR EL HILO LIMPIAMENTE ---
     {
         std::unique_lock<std::mutex> lock(queueMutex);
@@ -179,72 +375,56 @@ void Recorder::stop() {
         std::cout << "[REC] Esperando a que FFmpeg termine de digerir la cola de frames..." << std::endl;
         workerThread.join();
     }
+    reclaimDoneSlots();
 
-    if (ffmpegPipe) {
-        pclose(ffmpegPipe);
-        ffmpegPipe = nullptr;
+    if (droppedFrames > 0 || stalledFrames > 0) {
+        std::cout << "[REC] Frames descartados: " << droppedFrames
+                  << " | Frames en que el render esperó a FFmpeg: " << stalledFrames << std::endl;
     }
 
-    // (El resto del método stop() del Audio Mix y Fusión dejalo igualito a como lo tenés)
-    if (!audioMixBuffer.empty()) {
-        std::cout << "[REC] Procesando audio (Normalizando)..." << std::endl;
-        float maxPeak = 0.0f;
-        for (float s : audioMixBuffer) {
-            if (std::abs(s) > maxPeak) maxPeak = std::abs(s);
-        }
-
-        float gain = 1.0f;
-        if (maxPeak > 32000.0f) {
-            gain = 32000.0f / maxPeak;
-        } else if (maxPeak > 0.0f && maxPeak < 10000.0f) {
-            gain = 25000.0f / maxPeak;
-        }
-
-        std::vector<sf::Int16> finalSamples;
-        finalSamples.reserve(audioMixBuffer.size() * 2);
-
-        for (float sample : audioMixBuffer) {
-            float normalizedSample = sample * gain;
-            if (normalizedSample > 32767.0f) normalizedSample = 32767.0f;
-            if (normalizedSample < -32768.0f) normalizedSample = -32768.0f;
-            sf::Int16 s = static_cast<sf::Int16>(normalizedSample);
-            finalSamples.push_back(s); 
-            finalSamples.push_back(s); 
-        }
-
-        sf::OutputSoundFile audioFile;
-        if (audioFile.openFromFile(tempAudioFilename, 44100, 2)) { 
-            audioFile.write(finalSamples.data(), finalSamples.size());
-            audioFile.close(); 
+    // --- CERRAR EL AUDIO ANTES QUE EL VIDEO ---
+    // FFmpeg no termina hasta ver EOF en las dos entradas
+    if (audioThread.joinable()) {
+#ifndef _WIN32
+        // Si FFmpeg nunca abrió la FIFO, el hilo sigue trabado en open(): lo destrabamos
+        int unblockFd = -1;
+        if (!audioFifoOpened) unblockFd = open(audioFifoPath.c_str(), O_RDONLY | O_NONBLOCK);
+#endif
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            isAudioRunning = false;
         }
+        audioCV.notify_one();
+        audioThread.join();
+#ifndef _WIN32
+        if (unblockFd >= 0) close(unblockFd);
+#endif
     }
 
-    std::cout << "[REC] Iniciando fusion final..." << std::endl;
-    std::string mergeCmd = "ffmpeg -y -loglevel error -i " + tempVideoFilename + " -i " + tempAudioFilename + 
-                           " -c:v copy -c:a aac -b:a 192k -shortest " + finalFilename;
-    int result = system(mergeCmd.c_str());
+    if (ffmpegPipe) {
+        int result = pclose(ffmpegPipe);
+        ffmpegPipe = nullptr;
 
-    if (result == 0) {
-        std::cout << "[REC] EXITO TOTAL: " << finalFilename << std::endl;
-        remove(tempVideoFilename.c_str());
-        remove(tempAudioFilename.c_str());
-    } else {
-        std::cerr << "[REC] Error en la fusion de FFmpeg." << std::endl;
+        // Sin fusión ni temporales: cuando FFmpeg cierra, el archivo ya está listo
+        if (result == 0) std::cout << "[REC] EXITO TOTAL: " << finalFilename << std::endl;
+        else std::cerr << "[REC] FFmpeg termino con error (" << result << ")." << std::endl;
     }
 }
 
 void Recorder::addAudioEvent(const sf::Int16* samples, std::size_t sampleCount, float volume) {
     if (!isRecording) return;
 
-    size_t startIndex = (size_t)((double)currentFrame / fps * sampleRate);
-    size_t requiredSize = startIndex + sampleCount;
+    // Posición relativa a la ventana: lo anterior a audioWindowStart ya salió
+    long long startIndex = currentFrame * (long long)sampleRate / fps;
+    size_t offset = (size_t)std::max(0LL, startIndex - audioWindowStart);
+    size_t requiredSize = offset + sampleCount;
     
-    if (audioMixBuffer.size() < requiredSize) {
-        audioMixBuffer.resize(requiredSize, 0.0f); 
+    if (audioWindow.size() < requiredSize) {
+        audioWindow.resize(requiredSize, 0.0f); 
     }
     
     float volFactor = volume / 100.0f;
     for (size_t i = 0; i < sampleCount; ++i) {
-        audioMixBuffer[startIndex + i] += (float)samples[i] * volFactor;
+        audioWindow[offset + i] += (float)samples[i] * volFactor;
     }
 }
\ No newline at end of file
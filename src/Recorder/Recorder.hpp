@@ -4,6 +4,7 @@
 #include <cstdio>
 #include <vector>
 #include <queue>
+#include <deque>
 #include <thread>
 #include <mutex>
 #include <condition_variable>
@@ -11,10 +12,22 @@
 #include <SFML/Graphics.hpp>
 #include <SFML/OpenGL.hpp> // <--- Magia de OpenGL
 #include <SFML/Audio.hpp> 
+#include "EncoderProfile.hpp"
+#include "../Utils/Profiler.hpp"
+
+// Opciones del pipeline de frames
+struct RecorderOptions {
+    int pboCount = 4;                  // PBOs en vuelo (mínimo 2). Más = más latencia tolerada
+    bool dropFramesWhenBehind = false; // false = el render espera a FFmpeg (video exacto)
+                                       // true = se saltea el frame y se cuenta en droppedFrames
+    EncoderProfile encoder;            // Por defecto NVENC HEVC (ver pickEncoderProfile)
+    float audioGain = 1.0f;            // Ganancia antes del limitador (el viejo "normalizar" era global)
+};
 
 class Recorder {
 public:
-    Recorder(int width, int height, int fps, const std::string& outputFilename);
+    Recorder(int width, int height, int fps, const std::string& outputFilename,
+             const RecorderOptions& options = RecorderOptions());
     ~Recorder();
 
     void addFrame(const sf::Texture& texture);
@@ -22,8 +35,14 @@ public:
     void stop(); 
 
     bool isRecording = false; 
+    Profiler* profiler = nullptr; // addFrame entero, esperas a FFmpeg incluidas
+
+    // Métricas (se imprimen al cortar)
+    long long getDroppedFrames() const { return droppedFrames; }
+    long long getStalledFrames() const { return stalledFrames; }
 
 private:
+    bool start(); // FIFO de audio + FFmpeg + hilos. Lo llama el primer addFrame que graba
     void workerLoop(); 
 
     FILE* ffmpegPipe = nullptr;
@@ -31,25 +50,64 @@ private:
     int height;
     int fps;
     std::string finalFilename;      
-    std::string tempVideoFilename;  
-    std::string tempAudioFilename;  
 
-    std::vector<float> audioMixBuffer; 
     unsigned int sampleRate = 44100;
     long long currentFrame = 0; 
     
     bool isFinished = false; 
 
+    RecorderOptions options;
+
+    // --- PBOs (Pixel Buffer Objects) EN ANILLO ---
+    // Cada frame va al siguiente PBO del anillo. Cuando ya pasaron 'readbackLag' frames
+    // (la copia VRAM->RAM terminó) se mapea y el puntero mapeado va DIRECTO al hilo de
+    // FFmpeg: cero copias y cero allocs por frame. Cuando el hilo termina de escribirlo,
+    // el render lo desmapea (solo el hilo de GL puede) y el PBO vuelve a estar libre.
+    enum class PboState { Free, Pending, Mapped, Done };
+    struct PboSlot {
+        GLuint id = 0;
+        PboState state = PboState::Free;       // Protegido por queueMutex
+        const sf::Uint8* mapped = nullptr;
+    };
+    std::vector<PboSlot> pboSlots;
+    int pboCursor = 0;
+    int readbackLag = 1;
+    std::deque<int> pendingReadbacks; // Solo el hilo de render
+
+    void reclaimDoneSlots(); // Desmapea lo que FFmpeg ya escribió
+    void queueOldestReadback();
+    void flushPendingReadbacks();
+
     // --- MULTITHREADING ---
+    // La cola está acotada sola: nunca hay más frames en vuelo que PBOs
     std::thread workerThread;
     std::mutex queueMutex;
     std::condition_variable queueCV;
-    std::queue<std::vector<sf::Uint8>> frameQueue;
-    std::atomic<bool> isWorkerRunning;
-
-    // --- PBOs (Pixel Buffer Objects) ---
-    GLuint pbo[2];
-    int pboIndex = 0;
-    int nextPboIndex = 1;
-    bool firstFrame = true;
+    std::condition_variable slotFreedCV;
+    std::queue<int> frameQueue; // Índices de pboSlots ya mapeados
+    std::atomic<bool> isWorkerRunning{false};
+
+    // --- AUDIO EN STREAMING ---
+    // Los sonidos se mezclan en una ventana móvil que arranca en el primer sample
+    // que todavía puede cambiar. Cada frame aceptado "cierra" su tramo de audio
+    // (sampleRate/fps samples), lo pasa por un limitador y lo manda a FFmpeg por
+    // una FIFO, en paralelo al video. Nada queda en RAM ni hay fusión al final.
+    std::deque<float> audioWindow;    // Mono, solo lo usa el hilo de render
+    long long audioWindowStart = 0;   // Índice absoluto del primer sample de la ventana
+    float limiterEnvelope = 0.0f;
+    float limiterRelease = 0.0f;      // Coeficiente por sample (~200 ms)
+
+    void emitAudioForFrame(bool keep); // keep = false si el frame de video se descartó
+
+    std::string audioFifoPath;
+    int audioFd = -1;
+    std::thread audioThread;
+    std::condition_variable audioCV;
+    std::queue<std::vector<sf::Int16>> audioQueue; // Estéreo intercalado, protegido por queueMutex
+    std::atomic<bool> isAudioRunning{false};
+    std::atomic<bool> audioFifoOpened{false};
+    void audioLoop();
+
+    std::atomic<long long> droppedFrames{0};
+    std::atomic<long long> stalledFrames{0}; // Frames en que el render tuvo que esperar a FFmpeg
 };
\ No newline at end of file
@@ -0,0 +1,187 @@
+#include "HeadlessRace.hpp"
+#include "Replay.hpp"
+#include <cmath>
+#include <fstream>
+#include <sstream>
+
+const char* racerName(int index) {
+    static const char* names[] = { "Cyan", "Magenta", "Green", "Yellow" };
+    if (index < 0 || index >= 4) return "None";
+    return names[index];
+}
+
+const char* deathCauseName(DeathCause cause) {
+    switch (cause) {
+        case DeathCause::Spike: return "spike";
+        case DeathCause::Crush: return "crush";
+        case DeathCause::Knife: return "knife";
+        default: return "none";
+    }
+}
+
+// El loop de la carrera con el mapa ya cargado (compartido por las dos variantes)
+static void runLoadedRace(PhysicsWorld& physics, const HeadlessConfig& config, RaceResult& result,
+                          ReplayRecorder* replay) {
+    physics.isPaused = false; // loadMap deja todo en pausa para el editor
+    if (config.forceChaos) physics.enableChaos = true; // Con replay lo anota el poll del primer step
+
+    const auto& status = physics.getRacerStatus();
+    const size_t numRacers = status.size();
+    result.racers.resize(numRacers);
+    std::vector<bool> wasAlive(numRacers, true);
+
+    const float dt = config.timeStep;
+    const int maxSteps = (int)std::ceil(config.maxSeconds / dt);
+
+    while (!physics.gameOver && result.steps < maxSteps) {
+        physics.advance(dt, config.velIter, config.posIter);
+        result.steps++;
+
+        float now = result.steps * dt;
+        bool activeRacersLeft = false;
+
+        for (size_t i = 0; i < numRacers; ++i) {
+            if (wasAlive[i] && !status[i].isAlive) {
+                wasAlive[i] = false;
+                result.deaths.push_back({(int)i, now, status[i].deathCause, status[i].killerIndex});
+            }
+            // El tiempo de llegada es cuando TOCA la meta (igual que el criterio del ganador)
+            if (!result.racers[i].finished && (status[i].isFinishing || status[i].hasFinished)) {
+                result.racers[i].finished = true;
+                result.racers[i].finishTime = now;
+            }
+            if (status[i].isAlive && !status[i].hasFinished) activeRacersLeft = true;
+        }
+
+        // Con stopOnFirstWin el motor nunca corta si se mueren todos: cortamos nosotros
+        if (!activeRacersLeft) break;
+    }
+
+    for (size_t i = 0; i < numRacers; ++i) result.racers[i].alive = status[i].isAlive;
+    if (replay) replay->stop(physics);
+
+    result.winnerIndex = physics.winnerIndex;
+    result.finishTime = result.steps * dt;
+    result.timedOut = !physics.gameOver && result.steps >= maxSteps;
+}
+
+RaceResult runHeadlessRace(PhysicsWorld& physics, const std::string& mapFile, const HeadlessConfig& config,
+                           ReplayRecorder* replay) {
+    RaceResult result;
+    result.mapFile = mapFile;
+    result.seed = physics.getSeed();
+
+    // Nadie va a ver chispas ni leer la consola: apagamos todo lo que no sea física
+    physics.visualFx = false;
+    physics.logEvents = false;
+
+    std::ifstream file(mapFile, std::ios::binary);
+    result.loaded = file.is_open();
+    if (!result.loaded) return result;
+
+    std::stringstream mapBytes;
+    mapBytes << file.rdbuf();
+    const std::string bytes = mapBytes.str();
+
+    // Mismo arranque que ReplayPlayer::begin: mundo nuevo + mapa
+    if (isBinaryMap(bytes.data(), bytes.size())) {
+        MapData map;
+        result.loaded = parseMapBinary(bytes.data(), bytes.size(), map);
+        if (!result.loaded) return result;
+
+        // El replay guarda texto: con 9 dígitos el float vuelve exacto y la carrera es la misma
+        if (replay) {
+            replay->begin(physics, writeMapText(map, true), mapFile, config.timeStep, config.velIter, config.posIter);
+        } else {
+            physics.rebuildWorld();
+            physics.loadMapData(map);
+        }
+    } else if (replay) {
+        replay->begin(physics, bytes, mapFile, config.timeStep, config.velIter, config.posIter);
+    } else {
+        physics.rebuildWorld();
+        physics.loadMapFromString(bytes);
+    }
+
+    runLoadedRace(physics, config, result, replay);
+    return result;
+}
+
+RaceResult runHeadlessRace(PhysicsWorld& physics, const MapData& map, const std::string& mapName,
+                           const HeadlessConfig& config) {
+    RaceResult result;
+    result.mapFile = mapName;
+    result.seed = physics.getSeed();
+    result.loaded = true;
+
+    physics.visualFx = false;
+    physics.logEvents = false;
+    physics.rebuildWorld();
+    physics.loadMapData(map);
+
+    runLoadedRace(physics, config, result, nullptr);
+    return result;
+}
+
+static void writeJsonString(std::ostream& out, const std::string& s) {
+    out << '"';
+    for (char c : s) {
+        if (c == '"' || c == '\\') out << '\\';
+        out << c;
+    }
+    out << '"';
+}
+
+void writeRaceJson(std::ostream& out, const RaceResult& r) {
+    out << "{\"map\":";
+    writeJsonString(out, r.mapFile);
+    out << ",\"seed\":" << r.seed
+        << ",\"loaded\":" << (r.loaded ? "true" : "false")
+        << ",\"winner\":" << r.winnerIndex
+        << ",\"winnerName\":\"" << racerName(r.winnerIndex) << "\""
+        << ",\"time\":" << r.finishTime
+        << ",\"steps\":" << r.steps
+        << ",\"timedOut\":" << (r.timedOut ? "true" : "false");
+
+    out << ",\"racers\":[";
+    for (size_t i = 0; i < r.racers.size(); ++i) {
+        const auto& rr = r.racers[i];
+        if (i > 0) out << ",";
+        out << "{\"id\":" << i
+            << ",\"alive\":" << (rr.alive ? "true" : "false")
+            << ",\"finished\":" << (rr.finished ? "true" : "false")
+            << ",\"finishTime\":" << rr.finishTime << "}";
+    }
+    out << "]";
+
+    out << ",\"deaths\":[";
+    for (size_t i = 0; i < r.deaths.size(); ++i) {
+        const auto& d = r.deaths[i];
+        if (i > 0) out << ",";
+        out << "{\"racer\":" << d.racer
+            << ",\"time\":" << d.time
+            << ",\"cause\":\"" << deathCauseName(d.cause) << "\""
+            << ",\"killer\":" << d.killer << "}";
+    }
+    out << "]}";
+}
+
+void writeRaceTableHeader(std::ostream& out) {
+    out << "map\tseed\twinner\ttime\tsteps\ttimedOut\tdeaths\n";
+}
+
+void writeRaceTableRow(std::ostream& out, const RaceResult& r) {
+    out << r.mapFile << "\t" << r.seed << "\t" << racerName(r.winnerIndex) << "\t"
+        << r.finishTime << "\t" << r.steps << "\t" << (r.timedOut ? 1 : 0) << "\t";
+
+    // Log compacto: Green:crush@12.5,Cyan:knife(Magenta)@30.1
+    if (r.deaths.empty()) out << "-";
+    for (size_t i = 0; i < r.deaths.size(); ++i) {
+        const auto& d = r.deaths[i];
+        if (i > 0) out << ",";
+        out << racerName(d.racer) << ":" << deathCauseName(d.cause);
+        if (d.killer != -1) out << "(" << racerName(d.killer) << ")";
+        out << "@" << d.time;
+    }
+    out << "\n";
+}
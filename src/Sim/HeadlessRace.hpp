@@ -0,0 +1,67 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <ostream>
+#include "../Physics/PhysicsWorld.hpp"
+
+class ReplayRecorder;
+
+// --- SIMULACIÓN HEADLESS ---
+// Corre una carrera completa sin ventana, sin ImGui y sin contexto GL.
+// Avanza con PhysicsWorld::advance, la misma secuencia que el editor, el render
+// offline y el replay, así una carrera elegida acá se ve igual cuando después se renderiza.
+
+struct HeadlessConfig {
+    float timeStep = 1.0f / 60.0f;
+    int velIter = 8;
+    int posIter = 3;
+    float maxSeconds = 120.0f; // Corte de seguridad (ej: todos muertos con stopOnFirstWin)
+    bool forceChaos = false;   // Pisa el CONFIG del mapa: sin caos la semilla casi no cambia nada
+};
+
+struct RaceDeath {
+    int racer = -1;
+    float time = 0.0f;
+    DeathCause cause = DeathCause::None;
+    int killer = -1;
+};
+
+struct RacerResult {
+    bool alive = true;
+    bool finished = false;
+    float finishTime = -1.0f; // Momento en que tocó la meta
+};
+
+struct RaceResult {
+    std::string mapFile;
+    uint32_t seed = 0;
+    bool loaded = false;
+    int winnerIndex = -1;
+    float finishTime = 0.0f; // Tiempo simulado hasta el gameOver (o el corte)
+    int steps = 0;
+    bool timedOut = false;
+    std::vector<RacerResult> racers;
+    std::vector<RaceDeath> deaths; // En orden cronológico
+};
+
+const char* racerName(int index);
+const char* deathCauseName(DeathCause cause);
+
+// Carga el mapa en un mundo ya construido y lo corre hasta el gameOver.
+// La semilla es la que tenga el mundo (PhysicsWorld::setSeed antes de llamar).
+// El mundo se rearma de cero antes de cargar, igual que al reproducir un replay:
+// con 'replay' la misma carrera queda grabada y se puede renderizar después.
+RaceResult runHeadlessRace(PhysicsWorld& physics, const std::string& mapFile, const HeadlessConfig& config,
+                           ReplayRecorder* replay = nullptr);
+
+// Igual pero con el mapa ya en memoria (el generador valida candidatos sin pasar por disco)
+RaceResult runHeadlessRace(PhysicsWorld& physics, const MapData& map, const std::string& mapName,
+                           const HeadlessConfig& config);
+
+// Una línea JSON por carrera (fácil de grepear / parsear desde scripts).
+void writeRaceJson(std::ostream& out, const RaceResult& result);
+
+// Tabla separada por tabs: una fila por carrera, con header opcional.
+void writeRaceTableHeader(std::ostream& out);
+void writeRaceTableRow(std::ostream& out, const RaceResult& result);
@@ -0,0 +1,41 @@
+#include "RaceFarm.hpp"
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+void parallelFor(size_t count, unsigned threads, const std::function<void(size_t)>& fn) {
+    if (count == 0) return;
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    threads = (unsigned)std::min<size_t>(threads, count);
+
+    // Cola implícita: cada hilo agarra el siguiente índice libre.
+    // Las carreras duran muy distinto, así que repartir en bloques fijos dejaría núcleos ociosos.
+    std::atomic<size_t> next(0);
+    auto worker = [&]() {
+        for (size_t i = next++; i < count; i = next++) fn(i);
+    };
+
+    std::vector<std::thread> pool;
+    pool.reserve(threads - 1);
+    for (unsigned t = 1; t < threads; ++t) pool.emplace_back(worker);
+    worker(); // El hilo que llama también labura
+    for (auto& th : pool) th.join();
+}
+
+RaceFarm::RaceFarm(unsigned threads)
+    : threadCount(threads == 0 ? std::max(1u, std::thread::hardware_concurrency()) : threads)
+{
+}
+
+std::vector<RaceResult> RaceFarm::run(const std::vector<FarmJob>& jobs, const HeadlessConfig& config) const {
+    std::vector<RaceResult> results(jobs.size());
+
+    parallelFor(jobs.size(), threadCount, [&](size_t i) {
+        // Mundo nuevo por carrera: nada de estado colgado de la anterior
+        PhysicsWorld physics(WorldRenderSize, WorldRenderSize, nullptr);
+        physics.setSeed(jobs[i].seed);
+        results[i] = runHeadlessRace(physics, jobs[i].mapFile, config);
+    });
+
+    return results;
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+#include "HeadlessRace.hpp"
+
+// --- GRANJA DE CARRERAS ---
+// Cada PhysicsWorld tiene su propio b2World, RNG y contact listener,
+// así que N mundos en N hilos no comparten nada. Un trabajo = (mapa, semilla).
+
+struct FarmJob {
+    std::string mapFile;
+    uint32_t seed = 77;
+};
+
+// Reparte [0, count) entre 'threads' hilos (0 = todos los núcleos).
+// Cada índice se procesa exactamente una vez; el orden entre hilos no está garantizado.
+void parallelFor(size_t count, unsigned threads, const std::function<void(size_t)>& fn);
+
+class RaceFarm {
+public:
+    explicit RaceFarm(unsigned threads = 0);
+
+    // Devuelve los resultados en el MISMO orden que los trabajos.
+    std::vector<RaceResult> run(const std::vector<FarmJob>& jobs, const HeadlessConfig& config) const;
+
+    unsigned getThreadCount() const { return threadCount; }
+
+private:
+    unsigned threadCount;
+};
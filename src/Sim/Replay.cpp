@@ -0,0 +1,245 @@
+#include "Replay.hpp"
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+// Mismo orden que EditType: el nombre va en el archivo para que se pueda leer a ojo
+static const char* const editTypeNames[] = {
+    "Settings", "WallAdd", "WallUpdate", "WallRemove", "WallDuplicate", "WallColor", "WallProps",
+    "KnifeAdd", "KnifeRemove", "KnifePos", "WinZone", "RacerSize", "Restitution", "Friction",
+    "FixedRotation", "RacerPos", "RacerVel", "ResetRacers", "SongLoad"
+};
+static const int editTypeCount = (int)(sizeof(editTypeNames) / sizeof(editTypeNames[0]));
+
+// Tope de valores por edición al leer: un count corrupto no puede pedir gigas.
+// La más grande de tamaño fijo es WallProps (22); la canción va aparte (una nota por valor).
+static const size_t MaxFixedEditValues = 32;
+static const size_t MaxSongEditValues = 1 << 20;
+
+static size_t maxEditValues(EditType type) {
+    return type == EditType::SongLoad ? MaxSongEditValues : MaxFixedEditValues;
+}
+
+static bool editTypeFromName(const std::string& name, EditType& type) {
+    for (int i = 0; i < editTypeCount; ++i) {
+        if (name == editTypeNames[i]) { type = (EditType)i; return true; }
+    }
+    return false;
+}
+
+uint64_t hashMapText(const std::string& mapText) {
+    uint64_t hash = 14695981039346656037ull;
+    for (unsigned char c : mapText) {
+        hash ^= c;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+bool saveReplay(const std::string& filename, const ReplayData& r) {
+    std::ofstream file(filename);
+    if (!file.is_open()) return false;
+
+    // 17 dígitos: el double (y el float adentro) vuelve exacto al leerlo
+    file << std::setprecision(17);
+    file << "CHAOSREPLAY 1\n";
+    file << "SEED " << r.seed << "\n";
+    file << "TIMESTEP " << r.timeStep << " " << r.velIter << " " << r.posIter << "\n";
+
+    int lineCount = 0;
+    for (char c : r.mapText) if (c == '\n') lineCount++;
+    file << "MAP " << r.mapHash << " " << lineCount << " " << r.mapName << "\n";
+    file << r.mapText;
+
+    for (const auto& e : r.edits) {
+        file << "EDIT " << e.step << " " << editTypeNames[(int)e.edit.type] << " "
+             << e.edit.handle.index << " " << e.edit.handle.generation << " " << e.edit.values.size();
+        for (double v : e.edit.values) file << " " << v;
+        file << "\n";
+    }
+
+    file << "END " << r.totalSteps << " " << r.winnerIndex << " " << r.checksum << "\n";
+    return (bool)file;
+}
+
+bool loadReplay(const std::string& filename, ReplayData& r) {
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        std::cerr << "[REPLAY] No existe: " << filename << std::endl;
+        return false;
+    }
+
+    r = ReplayData();
+    std::string line;
+    if (!std::getline(file, line) || line != "CHAOSREPLAY 1") {
+        std::cerr << "[REPLAY] No es un replay (o es de otra version): " << filename << std::endl;
+        return false;
+    }
+
+    bool hasMap = false;
+    bool hasEnd = false;
+    while (std::getline(file, line)) {
+        std::stringstream ss(line);
+        std::string type;
+        ss >> type;
+
+        if (type == "SEED") {
+            if (!(ss >> r.seed)) {
+                std::cerr << "[REPLAY] SEED roto: " << filename << std::endl;
+                return false;
+            }
+        }
+        else if (type == "TIMESTEP") {
+            if (!(ss >> r.timeStep >> r.velIter >> r.posIter)) {
+                std::cerr << "[REPLAY] TIMESTEP roto: " << filename << std::endl;
+                return false;
+            }
+        }
+        else if (type == "MAP") {
+            int lineCount = 0;
+            if (!(ss >> r.mapHash >> lineCount) || lineCount < 0) {
+                std::cerr << "[REPLAY] Cabecera de MAP rota: " << filename << std::endl;
+                return false;
+            }
+            std::getline(ss >> std::ws, r.mapName);
+
+            std::string mapLine;
+            for (int i = 0; i < lineCount; ++i) {
+                if (!std::getline(file, mapLine)) {
+                    std::cerr << "[REPLAY] Mapa embebido cortado: " << filename << std::endl;
+                    return false;
+                }
+                r.mapText += mapLine;
+                r.mapText += '\n';
+            }
+            hasMap = true;
+        }
+        else if (type == "EDIT") {
+            ReplayEdit e;
+            std::string typeName;
+            size_t count = 0;
+            ss >> e.step >> typeName >> e.edit.handle.index >> e.edit.handle.generation >> count;
+            // Cada valor ocupa al menos dos caracteres de la línea (" x"): más que eso es basura
+            if (!ss || !editTypeFromName(typeName, e.edit.type)
+                || count > maxEditValues(e.edit.type) || count > line.size() / 2) {
+                std::cerr << "[REPLAY] Edicion trucha, la salteo: " << line.substr(0, 120) << std::endl;
+                continue;
+            }
+            e.edit.values.resize(count);
+            for (size_t i = 0; i < count && ss; ++i) ss >> e.edit.values[i];
+            if (!ss) {
+                std::cerr << "[REPLAY] Edicion cortada, la salteo: " << line.substr(0, 120) << std::endl;
+                continue;
+            }
+            r.edits.push_back(e);
+        }
+        else if (type == "END") {
+            if (!(ss >> r.totalSteps >> r.winnerIndex >> r.checksum)) {
+                std::cerr << "[REPLAY] END roto: " << filename << std::endl;
+                return false;
+            }
+            hasEnd = true;
+        }
+    }
+
+    if (!hasMap || hashMapText(r.mapText) != r.mapHash) {
+        std::cerr << "[REPLAY] El mapa embebido no coincide con su hash: " << filename << std::endl;
+        return false;
+    }
+    if (!hasEnd) {
+        // Sin END no hay contra qué verificar, pero la carrera igual se puede ver
+        std::cerr << "[REPLAY] Replay sin cerrar (sin END): " << filename << std::endl;
+    }
+    return true;
+}
+
+// --- GRABACIÓN ---
+
+void ReplayRecorder::begin(PhysicsWorld& physics, const std::string& mapText, const std::string& mapName,
+                           float timeStep, int velIter, int posIter, const PhysicsSettings* settings) {
+    if (active) physics.setEditListener(nullptr);
+
+    replay = ReplayData();
+    replay.seed = physics.getSeed();
+    replay.mapName = mapName;
+    replay.mapText = mapText;
+    // El archivo guarda el mapa por líneas: sin el \n final no volvería igual (ni su hash)
+    if (!replay.mapText.empty() && replay.mapText.back() != '\n') replay.mapText += '\n';
+    replay.mapHash = hashMapText(replay.mapText);
+    replay.timeStep = timeStep;
+    replay.velIter = velIter;
+    replay.posIter = posIter;
+
+    // Lo que no viaja en el texto del mapa. Los PhysicsSettings no se copian del mundo:
+    // el CONFIG del mapa manda salvo que el llamador pase los suyos.
+    float friction = physics.currentFriction;
+    bool fixedRotation = physics.currentFixedRotation;
+    std::vector<int> songNotes = physics.getSongNotes();
+
+    // Mismo arranque que va a tener ReplayPlayer::begin
+    physics.rebuildWorld();
+    physics.loadMapFromString(replay.mapText);
+
+    startStep = physics.getStepCount();
+    active = true;
+    physics.setEditListener([this, &physics](const PhysicsEdit& edit) {
+        replay.edits.push_back({physics.getStepCount() - startStep, edit});
+    });
+
+    // Con el listener puesto estas llamadas quedan en el journal en el step 0
+    if (settings) physics.applySettings(*settings); // El poll del primer step (o de la próxima edición) las anota
+    if (friction != physics.currentFriction) physics.updateFriction(friction);
+    if (fixedRotation != physics.currentFixedRotation) physics.updateFixedRotation(fixedRotation);
+    physics.setSongNotes(songNotes); // La canción cambia el color del flash: va siempre
+}
+
+void ReplayRecorder::stop(PhysicsWorld& physics) {
+    if (!active) return;
+    physics.setEditListener(nullptr);
+    active = false;
+
+    replay.totalSteps = physics.getStepCount() - startStep;
+    replay.winnerIndex = physics.winnerIndex;
+    replay.checksum = physics.stateChecksum();
+}
+
+// --- REPRODUCCIÓN ---
+
+void ReplayPlayer::begin(PhysicsWorld& physics, const ReplayData& data) {
+    replay = data;
+    nextEdit = 0;
+
+    physics.setEditListener(nullptr);
+    physics.setSeed(replay.seed);
+    physics.rebuildWorld();
+    physics.loadMapFromString(replay.mapText);
+    physics.isPaused = false; // loadMap deja todo en pausa para el editor
+
+    startStep = physics.getStepCount();
+}
+
+void ReplayPlayer::advance(PhysicsWorld& physics) {
+    long long step = stepsPlayed(physics);
+
+    // Una edición anotada en el step N se hizo después de N steps: va antes del step N+1
+    while (nextEdit < replay.edits.size() && replay.edits[nextEdit].step <= step) {
+        physics.applyEdit(replay.edits[nextEdit].edit);
+        nextEdit++;
+    }
+
+    // En la grabación la pausa solo frenaba el reloj: acá no hay reloj que frenar
+    if (!physics.gameOver) physics.isPaused = false;
+    physics.advance(replay.timeStep, replay.velIter, replay.posIter);
+}
+
+bool ReplayPlayer::finished(const PhysicsWorld& physics) const {
+    // totalSteps en 0 = replay sin END: corre hasta el gameOver
+    return physics.gameOver || (replay.totalSteps > 0 && stepsPlayed(physics) >= replay.totalSteps);
+}
+
+bool ReplayPlayer::matchesRecording(const PhysicsWorld& physics) const {
+    return stepsPlayed(physics) == replay.totalSteps
+        && physics.winnerIndex == replay.winnerIndex
+        && physics.stateChecksum() == replay.checksum;
+}
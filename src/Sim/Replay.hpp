@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "../Physics/PhysicsWorld.hpp"
+
+// --- REPLAY DETERMINISTA ---
+// Una carrera es función de: mapa + semilla + ajustes + lo que el editor tocó y cuándo.
+// El replay guarda exactamente eso (el texto del mapa entero, no la ruta) y la
+// reproducción parte de un mundo recién armado, así que sale bit a bit igual:
+// se simula barato en headless, se guardan las buenas y se renderizan después en 4K.
+// Bit a bit = mismo binario y misma plataforma; otro compilador puede redondear distinto.
+
+struct ReplayEdit {
+    long long step = 0; // Steps simulados desde el arranque cuando se hizo la edición
+    PhysicsEdit edit;
+};
+
+struct ReplayData {
+    uint32_t seed = 77;
+    std::string mapName;  // Solo informativo (de dónde salió)
+    std::string mapText;  // Lo que se carga de verdad
+    uint64_t mapHash = 0; // FNV-1a de mapText: si no coincide al leer, el archivo está roto
+
+    float timeStep = 1.0f / 60.0f;
+    int velIter = 8;
+    int posIter = 3;
+
+    std::vector<ReplayEdit> edits; // En orden de step
+
+    // Resultado de la grabación: la reproducción tiene que dar lo mismo
+    long long totalSteps = 0;
+    int winnerIndex = -1;
+    uint64_t checksum = 0;
+};
+
+uint64_t hashMapText(const std::string& mapText);
+
+// Formato de texto (CHAOSREPLAY 1), una línea por edición. false si no se pudo escribir/leer.
+bool saveReplay(const std::string& filename, const ReplayData& replay);
+bool loadReplay(const std::string& filename, ReplayData& replay);
+
+// Engancha el journal de ediciones del PhysicsWorld. begin() reinicia la carrera
+// desde un mundo nuevo con el mapa y a partir de ahí anota todo.
+// 'settings': ajustes que el llamador quiere por encima del CONFIG del mapa (el editor
+// pasa los suyos). Sin ellos la carrera corre con lo que diga el mapa, como en la granja.
+class ReplayRecorder {
+public:
+    void begin(PhysicsWorld& physics, const std::string& mapText, const std::string& mapName,
+               float timeStep = 1.0f / 60.0f, int velIter = 8, int posIter = 3,
+               const PhysicsSettings* settings = nullptr);
+    // Cierra el journal y anota resultado + huella del estado final
+    void stop(PhysicsWorld& physics);
+
+    bool isActive() const { return active; }
+    const ReplayData& data() const { return replay; }
+
+private:
+    ReplayData replay;
+    long long startStep = 0;
+    bool active = false;
+};
+
+// Reproduce un ReplayData: mismo arranque que la grabación y cada edición antes de su step.
+class ReplayPlayer {
+public:
+    void begin(PhysicsWorld& physics, const ReplayData& data);
+    // Un tick (igual que PhysicsWorld::advance) con las ediciones que tocan en este step
+    void advance(PhysicsWorld& physics);
+    bool finished(const PhysicsWorld& physics) const;
+
+    long long stepsPlayed(const PhysicsWorld& physics) const { return physics.getStepCount() - startStep; }
+    // Compara contra lo grabado (steps, ganador y huella). Llamar al terminar.
+    bool matchesRecording(const PhysicsWorld& physics) const;
+
+    const ReplayData& data() const { return replay; }
+
+private:
+    ReplayData replay;
+    size_t nextEdit = 0;
+    long long startStep = 0;
+};
@@ -0,0 +1,38 @@
+#include "SnapshotRing.hpp"
+#include <algorithm>
+
+SnapshotRing::SnapshotRing(size_t capacity, int interval)
+    : slots(std::max<size_t>(1, capacity)), interval(std::max(1, interval))
+{
+}
+
+void SnapshotRing::capture(const PhysicsWorld& physics, bool force) {
+    long long step = physics.getStepCount();
+    if (!force && step % interval != 0) return;
+    if (count > 0 && stepAt(count - 1) == step) return; // Pausado: ya tenemos esta
+
+    size_t slot;
+    if (count < slots.size()) {
+        slot = (head + count) % slots.size();
+        count++;
+    } else {
+        // Lleno: pisamos la más vieja
+        slot = head;
+        head = (head + 1) % slots.size();
+    }
+    physics.captureSnapshot(slots[slot]);
+}
+
+bool SnapshotRing::restore(PhysicsWorld& physics, long long step) {
+    for (size_t i = count; i-- > 0;) {
+        if (stepAt(i) <= step) return restoreIndex(physics, i);
+    }
+    return false;
+}
+
+bool SnapshotRing::restoreIndex(PhysicsWorld& physics, size_t index) {
+    if (index >= count) return false;
+    physics.restoreSnapshot(at(index));
+    count = index + 1;
+    return true;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <vector>
+#include "../Physics/PhysicsWorld.hpp"
+
+// --- RING DE SNAPSHOTS ---
+// Una foto del mundo cada N steps, las últimas 'capacity'. Sirve para saltar a cualquier
+// momento de la carrera (scrub del editor, grabar desde un checkpoint) sin re-simular desde t=0.
+// Las fotos se reusan en el lugar: pasada la primera vuelta no se aloca casi nada.
+
+class SnapshotRing {
+public:
+    explicit SnapshotRing(size_t capacity = 300, int interval = 30);
+
+    // Llamar después de cada tick. Saca foto si el step cae en el intervalo (o siempre con force).
+    void capture(const PhysicsWorld& physics, bool force = false);
+
+    // Vuelve a la foto más nueva que no pase de 'step'. Las posteriores se tiran:
+    // desde ahí la carrera puede ir por otro lado. false si no hay ninguna.
+    bool restore(PhysicsWorld& physics, long long step);
+    bool restoreIndex(PhysicsWorld& physics, size_t index);
+
+    void clear() { head = 0; count = 0; }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    long long stepAt(size_t index) const { return at(index).step; } // 0 = la más vieja
+    int getInterval() const { return interval; }
+
+private:
+    const PhysicsSnapshot& at(size_t index) const { return slots[(head + index) % slots.size()]; }
+
+    std::vector<PhysicsSnapshot> slots;
+    size_t head = 0;  // La más vieja
+    size_t count = 0;
+    int interval;
+};
@@ -0,0 +1,5 @@
+#include "SoundManager.hpp"
+
+void SoundManager::sendToRecorder(const sf::Int16* samples, std::size_t count, float vol) {
+    if (recorderHook) recorderHook(samples, count, vol);
+}
@@ -4,12 +4,10 @@
 #include <vector>
 #include <map>
 #include <cmath>
+#include <functional>
 #include <iostream>
 #include <random>
 
-// Forward declaration
-class Recorder;
-
 class SoundManager {
 public:
     SoundManager() {
@@ -27,10 +25,17 @@ public:
         for(int i=0; i<64; ++i) soundPool.emplace_back();
     }
 
-    void setRecorder(Recorder* rec) {
-        recorder = rec;
+    // Por acá le llegan las notas al Recorder (o a quien grabe el audio).
+    // El núcleo no conoce al Recorder: el editor engancha el hook, los tools lo dejan vacío.
+    using RecorderHook = std::function<void(const sf::Int16* samples, std::size_t count, float volume)>;
+    void setRecorderHook(RecorderHook hook) {
+        recorderHook = std::move(hook);
     }
 
+    // true = no suena por los parlantes, pero el Recorder igual recibe las notas
+    // (el render offline corre mucho más rápido que tiempo real)
+    bool mutePlayback = false;
+
     // Generador de ondas (Senoide suave)
     void generateTone(int id, float frequency) {
         const unsigned SAMPLE_RATE = 44100;
@@ -74,7 +79,7 @@ public:
         if (noteNumber < 0 || noteNumber > 127) return;
         if (midiBuffers.find(noteNumber) == midiBuffers.end()) return;
 
-        sf::Sound* sound = getFreeSound();
+        sf::Sound* sound = mutePlayback ? nullptr : getFreeSound();
         if (sound) {
             sound->setBuffer(midiBuffers[noteNumber]);
             sound->setVolume(volume); 
@@ -84,7 +89,7 @@ public:
             sound->play();
         }
 
-        if (recorder) {
+        if (recorderHook) {
              const sf::SoundBuffer& buf = midiBuffers[noteNumber];
              sendToRecorder(buf.getSamples(), buf.getSampleCount(), volume);
         }
@@ -111,6 +116,6 @@ private:
     // Cambiamos el nombre para ser claros
     std::map<int, sf::SoundBuffer> midiBuffers;
     std::vector<sf::Sound> soundPool;
-    Recorder* recorder = nullptr;
+    RecorderHook recorderHook;
     std::mt19937 rng;
 };
\ No newline at end of file
@@ -0,0 +1,316 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../Physics/PhysicsWorld.hpp"
+#include "../Physics/MapFile.hpp"
+#include "../Physics/ParticlePool.hpp"
+#include "../Sim/HeadlessRace.hpp"
+#include "../Graphics/TrailMesh.hpp"
+#include "../Graphics/CrackRenderer.hpp"
+
+// --- BENCHMARKS (chaos_bench) ---
+// Micro: cada pieza caliente por separado, con tamaños que barren lo que aparece en
+// mapas reales. Macro: una carrera headless entera sobre level_0.
+// Se arma con -DCHAOS_BUILD_BENCH=ON (apagado por default para no pedir red al configurar).
+// La salida es JSON por default (--benchmark_format=console para leerla a ojo);
+// con --benchmark_out=archivo.json queda guardada para comparar contra la anterior.
+// Todo usa semillas fijas: dos corridas miden exactamente el mismo trabajo.
+
+#ifndef CHAOS_LEVELS_DIR
+#define CHAOS_LEVELS_DIR "levels"
+#endif
+
+static constexpr float BenchDt = 1.0f / 60.0f;
+
+// Grilla de paredes chicas que deja libre la franja de largada (y = 12 m)
+static MapData makeGridMap(int wallCount) {
+    MapData map;
+    map.hasConfig = true;
+    // Meta afuera del mundo: nadie gana y el step nunca corta por gameOver
+    map.hasWinZone = true;
+    map.winZonePos[0] = -50.0f;
+    map.winZonePos[1] = -50.0f;
+
+    int side = (int)std::ceil(std::sqrt((float)std::max(1, wallCount)));
+    float cell = 22.0f / side;
+    for (int i = 0; i < wallCount; ++i) {
+        MapWall w;
+        w.x = 1.0f + cell * (i % side + 0.5f);
+        w.y = 1.0f + cell * (i / side + 0.5f);
+        if (std::abs(w.y - 12.0f) < 1.5f) w.y += (w.y < 12.0f) ? -1.5f : 1.5f;
+        w.width = std::min(0.4f, cell * 0.4f);
+        w.height = w.width;
+        w.soundID = i % 8;
+        map.walls.push_back(w);
+    }
+    return map;
+}
+
+static std::unique_ptr<PhysicsWorld> makeWorld() {
+    auto physics = std::make_unique<PhysicsWorld>(WorldRenderSize, WorldRenderSize, nullptr);
+    physics->visualFx = false;
+    physics->logEvents = false;
+    physics->setSeed(1234);
+    return physics;
+}
+
+// --- CONTACT LISTENER ---
+// Mundo Box2D pelado con N racers rebotando entre paredes: el PhysicsWorld tiene 4 fijos.
+// Mide Step + el despacho de BeginContact (sets por etiqueta, eventos de chispas).
+static void BM_ContactDispatch(benchmark::State& state) {
+    const int racers = (int)state.range(0);
+
+    b2World world(b2Vec2(0.0f, 0.0f));
+    ChaosContactListener listener;
+    listener.worldWidth = 24.0f;
+    world.SetContactListener(&listener);
+
+    uint32_t wallIndex = 0;
+    b2BodyDef wallDef;
+    b2Body* border = world.CreateBody(&wallDef);
+    tagBody(border, EntityKind::Wall, wallIndex++);
+    b2Vec2 corners[4] = {{0.0f, 0.0f}, {24.0f, 0.0f}, {24.0f, 24.0f}, {0.0f, 24.0f}};
+    b2ChainShape chain;
+    chain.CreateLoop(corners, 4);
+    border->CreateFixture(&chain, 0.0f);
+
+    for (int gy = 0; gy < 6; ++gy) {
+        for (int gx = 0; gx < 6; ++gx) {
+            b2BodyDef def;
+            def.position.Set(2.0f + gx * 4.0f, 2.0f + gy * 4.0f);
+            b2Body* wall = world.CreateBody(&def);
+            tagBody(wall, EntityKind::Wall, wallIndex++);
+            b2PolygonShape box;
+            box.SetAsBox(0.3f, 0.3f);
+            wall->CreateFixture(&box, 0.0f);
+        }
+    }
+
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> pos(0.5f, 23.5f);
+    std::uniform_real_distribution<float> angle(0.0f, 6.2831853f);
+    for (int i = 0; i < racers; ++i) {
+        b2BodyDef def;
+        def.type = b2_dynamicBody;
+        def.position.Set(pos(rng), pos(rng));
+        float a = angle(rng);
+        def.linearVelocity.Set(std::cos(a) * 8.0f, std::sin(a) * 8.0f);
+        b2Body* body = world.CreateBody(&def);
+        tagBody(body, EntityKind::Racer, (uint32_t)i);
+
+        b2CircleShape circle;
+        circle.m_radius = 0.2f;
+        b2FixtureDef fd;
+        fd.shape = &circle;
+        fd.density = 1.0f;
+        fd.restitution = 1.0f;
+        fd.friction = 0.0f;
+        body->CreateFixture(&fd);
+    }
+
+    int64_t contacts = 0;
+    for (auto _ : state) {
+        world.Step(BenchDt, 8, 3);
+
+        // Lo mismo que consume y vacía PhysicsWorld::step en cada vuelta
+        contacts += (int64_t)(listener.collisionEvents.size() + listener.pendingKills.size() / 2);
+        listener.bodiesToCheck.clear();
+        listener.wallsHit.clear();
+        listener.collisionEvents.clear();
+        listener.pendingKills.clear();
+        listener.pendingPickups.clear();
+    }
+    state.counters["contacts_per_step"] = benchmark::Counter((double)contacts / std::max<int64_t>(1, state.iterations()));
+}
+BENCHMARK(BM_ContactDispatch)->Arg(4)->Arg(16)->Arg(64)->Arg(256);
+
+// --- STEP vs PAREDES ---
+static void BM_PhysicsStep(benchmark::State& state) {
+    const int walls = (int)state.range(0);
+    auto physics = makeWorld();
+    MapData map = makeGridMap(walls);
+    physics->loadMapData(map);
+    physics->isPaused = false;
+
+    for (auto _ : state) {
+        physics->step(BenchDt, 8, 3);
+        if (physics->gameOver) {
+            state.PauseTiming();
+            physics->loadMapData(map);
+            physics->isPaused = false;
+            state.ResumeTiming();
+        }
+    }
+    state.counters["walls"] = walls;
+}
+BENCHMARK(BM_PhysicsStep)->Arg(0)->Arg(16)->Arg(64)->Arg(256)->Arg(1024);
+
+// Todas las paredes animadas a la vez: la mitad crece (stopOnContact contra cualquiera)
+// y la otra mitad se mueve (reverseOnContact). Solo los chequeos pared vs pared, sin Step.
+static void BM_AnimatedWalls(benchmark::State& state) {
+    const int walls = (int)state.range(0);
+    MapData map = makeGridMap(walls);
+    for (size_t i = 0; i < map.walls.size(); ++i) {
+        MapWall& w = map.walls[i];
+        if (i % 2 == 0) {
+            w.isExpandable = true;
+            w.expansionDelay = 0.0f;
+            w.expansionSpeed = 0.0001f; // Casi quietas: el trabajo no cambia entre vueltas
+            w.stopOnContact = true;
+        } else {
+            w.isMoving = true;
+            w.pointA[0] = w.x - 0.5f; w.pointA[1] = w.y;
+            w.pointB[0] = w.x + 0.5f; w.pointB[1] = w.y;
+            w.reverseOnContact = true;
+        }
+    }
+
+    auto physics = makeWorld();
+    physics->loadMapData(map);
+    physics->isPaused = false;
+
+    for (auto _ : state) {
+        physics->updateWallExpansion(BenchDt);
+        physics->updateMovingPlatforms(BenchDt);
+    }
+    state.SetItemsProcessed(state.iterations() * walls);
+}
+BENCHMARK(BM_AnimatedWalls)->Arg(64)->Arg(256)->Arg(1024);
+
+// --- CARGA DE MAPAS ---
+static void BM_ParseMapText(benchmark::State& state) {
+    const std::string text = writeMapText(makeGridMap((int)state.range(0)));
+    for (auto _ : state) {
+        MapData map;
+        benchmark::DoNotOptimize(parseMapText(text, map));
+    }
+    state.SetBytesProcessed(state.iterations() * (int64_t)text.size());
+}
+BENCHMARK(BM_ParseMapText)->Arg(16)->Arg(256)->Arg(4096);
+
+static void BM_ParseMapBinary(benchmark::State& state) {
+    const std::string bytes = writeMapBinary(makeGridMap((int)state.range(0)));
+    for (auto _ : state) {
+        MapData map;
+        benchmark::DoNotOptimize(parseMapBinary(bytes.data(), bytes.size(), map));
+    }
+    state.SetBytesProcessed(state.iterations() * (int64_t)bytes.size());
+}
+BENCHMARK(BM_ParseMapBinary)->Arg(16)->Arg(256)->Arg(4096);
+
+// De texto a cuerpos de Box2D: lo que paga el editor en cada LOAD MAP
+static void BM_LoadMap(benchmark::State& state) {
+    const std::string text = writeMapText(makeGridMap((int)state.range(0)));
+    auto physics = makeWorld();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(physics->loadMapFromString(text));
+    }
+}
+BENCHMARK(BM_LoadMap)->Arg(16)->Arg(256)->Arg(1024);
+
+// --- PARTÍCULAS ---
+static void BM_ParticleUpdate(benchmark::State& state) {
+    const size_t count = (size_t)state.range(0);
+    ParticlePool pool(count);
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> pos(0.0f, WorldRenderSize);
+    std::uniform_real_distribution<float> vel(-300.0f, 300.0f);
+    // Vida enorme: ninguna se muere y cada vuelta integra las mismas N
+    for (size_t i = 0; i < count; ++i) {
+        pool.spawn({pos(rng), pos(rng)}, {vel(rng), vel(rng)}, sf::Color(255, 200, 80), 1.0e9f);
+    }
+
+    for (auto _ : state) {
+        pool.update(BenchDt, 900.0f);
+        benchmark::DoNotOptimize(pool.quads().data());
+    }
+    state.SetItemsProcessed(state.iterations() * (int64_t)pool.size());
+}
+BENCHMARK(BM_ParticleUpdate)->Arg(1000)->Arg(10000);
+
+// --- ESTELAS ---
+// Lo que paga la CPU por frame: un punto nuevo por racer (un quad al ring) con la
+// cola corriéndose. El largo no debería mover el tiempo: es O(1) por racer.
+static void BM_TrailVertices(benchmark::State& state) {
+    const int racers = 4;
+    const size_t points = (size_t)state.range(0);
+    const float overlap = 1.0f * (WorldRenderSize / 24.0f) * 0.08f;
+    std::vector<TrailRing> trails(racers);
+
+    uint32_t frame = 0;
+    for (auto _ : state) {
+        float t = frame++ * 0.15f;
+        for (int r = 0; r < racers; ++r) {
+            TrailRing& trail = trails[r];
+            sf::Vector2f p(1080.0f + std::cos(t + r) * 400.0f, 1080.0f + std::sin(t + r) * 400.0f);
+            benchmark::DoNotOptimize(trail.push(p, overlap));
+            if (trail.size() > points) trail.popTail();
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * racers);
+}
+BENCHMARK(BM_TrailVertices)->Arg(16)->Arg(64)->Arg(256);
+
+// --- GRIETAS ---
+// Sorteo (solo cuando cambia el daño) + expansión a píxeles (cuando cambia el tamaño)
+static void BM_CrackGeneration(benchmark::State& state) {
+    const float scale = WorldRenderSize / 24.0f;
+    const int damage = (int)state.range(0); // Daño máximo: todas las grietas
+    std::vector<sf::Vector2f> lines;
+    sf::VertexArray quads(sf::Quads);
+
+    for (auto _ : state) {
+        buildCrackLines(lines, damage, 1234u);
+        buildCrackQuads(quads, lines, 4.0f * scale, 1.0f * scale, 0.036f * scale);
+        benchmark::DoNotOptimize(quads.getVertexCount());
+    }
+}
+BENCHMARK(BM_CrackGeneration)->Arg(3)->Arg(50)->Arg(200);
+
+// --- MACRO: level_0 HEADLESS ---
+// La carrera entera como la corre ChaosHeadless: rebuild + carga + advance hasta el gameOver
+// o el corte de 60 s simulados. real_time_factor = segundos simulados por segundo real.
+static void BM_HeadlessLevel0(benchmark::State& state) {
+    const std::string mapFile = std::string(CHAOS_LEVELS_DIR) + "/level_0.txt";
+    HeadlessConfig config;
+    config.maxSeconds = 60.0f;
+
+    PhysicsWorld physics(WorldRenderSize, WorldRenderSize, nullptr);
+    int64_t steps = 0;
+    for (auto _ : state) {
+        physics.setSeed(1234);
+        RaceResult result = runHeadlessRace(physics, mapFile, config);
+        if (!result.loaded) {
+            state.SkipWithError(("No se pudo cargar " + mapFile).c_str());
+            break;
+        }
+        steps += result.steps;
+    }
+
+    double simSeconds = steps * (double)config.timeStep;
+    state.counters["steps"] = benchmark::Counter((double)steps, benchmark::Counter::kAvgIterations);
+    state.counters["real_time_factor"] = benchmark::Counter(simSeconds, benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_HeadlessLevel0)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+int main(int argc, char** argv) {
+    // JSON por default; un --benchmark_format posterior lo pisa (gana el último)
+    std::vector<char*> args(argv, argv + argc);
+    char jsonFormat[] = "--benchmark_format=json";
+    args.insert(args.begin() + 1, jsonFormat);
+    int count = (int)args.size();
+
+    benchmark::Initialize(&count, args.data());
+    if (benchmark::ReportUnrecognizedArguments(count, args.data())) return 1;
+
+    benchmark::AddCustomContext("particle_kernel", ParticlePool::kernelName());
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
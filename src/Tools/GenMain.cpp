@@ -0,0 +1,92 @@
+#include <iostream>
+#include <string>
+#include <chrono>
+#include <cstdlib>
+#include <algorithm>
+#include <filesystem>
+
+#include "../Gen/LevelGenerator.hpp"
+
+namespace fs = std::filesystem;
+
+static void printUsage() {
+    std::cerr << "Uso: ChaosGen [opciones]\n"
+              << "  --count N          Niveles aceptados a producir (default 10)\n"
+              << "  --seed S           Primera semilla de generacion (default 1)\n"
+              << "  --out DIR          Carpeta de salida (default levels/gen)\n"
+              << "  --binary           Escribe .cmap en vez de .txt\n"
+              << "  --threads T        Hilos (default: todos los nucleos)\n"
+              << "  --max-attempts N   Tope de candidatos (default 50 por nivel)\n"
+              << "Restricciones:\n"
+              << "  --walls MIN MAX    Paredes internas (default 6 14)\n"
+              << "  --knives N         Maximo de cuchillos (default 2)\n"
+              << "  --spikes P / --expanding P / --moving P / --destructible P  (probabilidad por pared)\n"
+              << "  --chaos            Chaos Mode en el mapa (y valida con varias semillas)\n"
+              << "Validacion:\n"
+              << "  --budget S         Segundos para que alguien llegue a la meta (default 60)\n"
+              << "  --min-time S       Mas rapido que esto es trivial (default 4)\n"
+              << "  --validation-seeds N / --min-wins N  (solo con --chaos)" << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+    GenConstraints constraints;
+    size_t count = 10;
+    uint32_t baseSeed = 1;
+    std::string outDir = "levels/gen";
+    bool binary = false;
+    unsigned threads = 0;
+    size_t maxAttempts = 0;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = (i + 1 < argc);
+
+        if (arg == "--count" && hasValue) count = (size_t)std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--seed" && hasValue) baseSeed = (uint32_t)std::strtoul(argv[++i], nullptr, 10);
+        else if (arg == "--out" && hasValue) outDir = argv[++i];
+        else if (arg == "--binary") binary = true;
+        else if (arg == "--threads" && hasValue) threads = (unsigned)std::max(0, std::atoi(argv[++i]));
+        else if (arg == "--max-attempts" && hasValue) maxAttempts = (size_t)std::max(0, std::atoi(argv[++i]));
+        else if (arg == "--walls" && i + 2 < argc) {
+            constraints.minWalls = std::max(0, std::atoi(argv[++i]));
+            constraints.maxWalls = std::max(constraints.minWalls, std::atoi(argv[++i]));
+        }
+        else if (arg == "--knives" && hasValue) constraints.maxKnives = std::max(0, std::atoi(argv[++i]));
+        else if (arg == "--spikes" && hasValue) constraints.spikeChance = std::strtof(argv[++i], nullptr);
+        else if (arg == "--expanding" && hasValue) constraints.expandingChance = std::strtof(argv[++i], nullptr);
+        else if (arg == "--moving" && hasValue) constraints.movingChance = std::strtof(argv[++i], nullptr);
+        else if (arg == "--destructible" && hasValue) constraints.destructibleChance = std::strtof(argv[++i], nullptr);
+        else if (arg == "--chaos") constraints.enableChaos = true;
+        else if (arg == "--budget" && hasValue) constraints.timeBudget = std::strtof(argv[++i], nullptr);
+        else if (arg == "--min-time" && hasValue) constraints.minFinishTime = std::strtof(argv[++i], nullptr);
+        else if (arg == "--validation-seeds" && hasValue) constraints.validationSeeds = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--min-wins" && hasValue) constraints.minWinningSeeds = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "-h" || arg == "--help") { printUsage(); return 0; }
+        else { std::cerr << "Opcion desconocida: " << arg << std::endl; printUsage(); return 1; }
+    }
+
+    if (!fs::exists(outDir)) fs::create_directories(outDir);
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<GeneratedLevel> levels = generateLevels(count, baseSeed, constraints, threads, maxAttempts);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    int failures = 0;
+    for (const auto& level : levels) {
+        std::string name = "gen_" + std::to_string(level.seed) + (binary ? MapBinaryExtension : ".txt");
+        std::string path = (fs::path(outDir) / name).string();
+        if (!writeMapFile(path, level.map, binary)) {
+            std::cerr << "[GEN] No se pudo escribir: " << path << std::endl;
+            failures++;
+            continue;
+        }
+        std::cout << path << "\t" << level.map.walls.size() << " paredes\t"
+                  << level.stats.wins << "/" << level.stats.races << " ganadas\tmejor " << level.stats.bestTime
+                  << "s\t" << level.stats.deaths << " muertes" << std::endl;
+    }
+
+    std::cerr << "[GEN] " << levels.size() << "/" << count << " niveles en " << seconds << "s ("
+              << (seconds > 0.0 ? levels.size() * 60.0 / seconds : 0.0) << " por minuto)" << std::endl;
+    return (levels.size() == count && failures == 0) ? 0 : 1;
+}
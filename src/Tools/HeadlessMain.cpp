@@ -0,0 +1,182 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdlib>
+#include <algorithm>
+#include <filesystem>
+
+#include "../Physics/PhysicsWorld.hpp"
+#include "../Sim/HeadlessRace.hpp"
+#include "../Sim/RaceFarm.hpp"
+#include "../Sim/Replay.hpp"
+
+namespace fs = std::filesystem;
+
+static void printUsage() {
+    std::cerr << "Uso: ChaosHeadless <mapa.txt> [mapa2.txt ...] [opciones]\n"
+              << "     ChaosHeadless --replay ARCHIVO (reproduce y verifica un replay)\n"
+              << "  --max-seconds N   Corte por carrera (default 120)\n"
+              << "  --seeds N         Corre N semillas por mapa (default 1)\n"
+              << "  --seed-base S     Primera semilla (default 77, la del editor)\n"
+              << "  --threads T       Hilos de la granja (default: todos los nucleos)\n"
+              << "  --chaos           Fuerza Chaos Mode (sin caos la semilla casi no influye)\n"
+              << "  --table           Tabla TSV en vez de JSON por linea\n"
+              << "  --save-replays DIR  Graba un replay por cada carrera que pasa el filtro\n"
+              << "Filtros (solo imprimen las carreras que cumplen):\n"
+              << "  --winner NOMBRE   Cyan | Magenta | Green | Yellow\n"
+              << "  --min-time S / --max-time S\n"
+              << "  --min-crushes N" << std::endl;
+}
+
+struct RaceFilter {
+    std::string winner;
+    float minTime = -1.0f;
+    float maxTime = -1.0f;
+    int minCrushes = 0;
+
+    bool accepts(const RaceResult& r) const {
+        if (!r.loaded) return true; // Los errores se muestran siempre
+        if (!winner.empty() && winner != racerName(r.winnerIndex)) return false;
+        if (minTime >= 0.0f && r.finishTime < minTime) return false;
+        if (maxTime >= 0.0f && r.finishTime > maxTime) return false;
+
+        int crushes = 0;
+        for (const auto& d : r.deaths) if (d.cause == DeathCause::Crush) crushes++;
+        return crushes >= minCrushes;
+    }
+};
+
+// Reproduce el replay sin ventana y compara contra lo que se grabó
+static int verifyReplay(const std::string& filename) {
+    ReplayData data;
+    if (!loadReplay(filename, data)) return 1;
+
+    PhysicsWorld physics(WorldRenderSize, WorldRenderSize, nullptr);
+    physics.visualFx = false;
+    physics.logEvents = false;
+
+    ReplayPlayer player;
+    player.begin(physics, data);
+    while (!player.finished(physics)) player.advance(physics);
+
+    bool ok = player.matchesRecording(physics);
+    std::cout << "[REPLAY] " << filename << ": " << player.stepsPlayed(physics) << "/" << data.totalSteps
+              << " steps, ganador " << racerName(physics.winnerIndex) << " (grabado "
+              << racerName(data.winnerIndex) << "), checksum " << physics.stateChecksum()
+              << (ok ? " -> IDENTICO" : " -> SE DESINCRONIZO") << std::endl;
+    return ok ? 0 : 1;
+}
+
+// Vuelve a correr las carreras elegidas con el journal enganchado y guarda un replay de cada una
+static int saveReplays(const std::vector<RaceResult>& races, const HeadlessConfig& config,
+                       const std::string& directory, unsigned threads) {
+    if (!fs::exists(directory)) fs::create_directories(directory);
+
+    std::vector<int> mismatches(races.size(), 0);
+    parallelFor(races.size(), threads, [&](size_t i) {
+        PhysicsWorld physics(WorldRenderSize, WorldRenderSize, nullptr);
+        physics.setSeed(races[i].seed);
+
+        ReplayRecorder recorder;
+        RaceResult again = runHeadlessRace(physics, races[i].mapFile, config, &recorder);
+
+        // Si la segunda corrida no da lo mismo que la granja, el determinismo está roto:
+        // ese replay no es la carrera que se eligió y no se guarda
+        if (again.steps != races[i].steps || again.winnerIndex != races[i].winnerIndex) {
+            mismatches[i] = 1;
+            return;
+        }
+
+        std::string name = fs::path(races[i].mapFile).stem().string() + "_s" + std::to_string(races[i].seed) + ".chaosreplay";
+        if (!saveReplay((fs::path(directory) / name).string(), recorder.data())) mismatches[i] = 1;
+    });
+
+    int failures = 0;
+    for (size_t i = 0; i < races.size(); ++i) {
+        if (!mismatches[i]) continue;
+        failures++;
+        std::cerr << "[HEADLESS] Replay con problemas: " << races[i].mapFile << " semilla " << races[i].seed << std::endl;
+    }
+    std::cerr << "[HEADLESS] " << (races.size() - failures) << " replays en " << directory << std::endl;
+    return failures;
+}
+
+int main(int argc, char** argv)
+{
+    HeadlessConfig config;
+    RaceFilter filter;
+    std::vector<std::string> maps;
+    int numSeeds = 1;
+    uint32_t seedBase = 77;
+    unsigned threads = 0;
+    bool tableOutput = false;
+    std::string replayFile;
+    std::string replayDirectory;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = (i + 1 < argc);
+
+        if (arg == "--max-seconds" && hasValue) config.maxSeconds = std::strtof(argv[++i], nullptr);
+        else if (arg == "--seeds" && hasValue) numSeeds = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--seed-base" && hasValue) seedBase = (uint32_t)std::strtoul(argv[++i], nullptr, 10);
+        else if (arg == "--threads" && hasValue) threads = (unsigned)std::max(0, std::atoi(argv[++i]));
+        else if (arg == "--chaos") config.forceChaos = true;
+        else if (arg == "--table") tableOutput = true;
+        else if (arg == "--replay" && hasValue) replayFile = argv[++i];
+        else if (arg == "--save-replays" && hasValue) replayDirectory = argv[++i];
+        else if (arg == "--winner" && hasValue) filter.winner = argv[++i];
+        else if (arg == "--min-time" && hasValue) filter.minTime = std::strtof(argv[++i], nullptr);
+        else if (arg == "--max-time" && hasValue) filter.maxTime = std::strtof(argv[++i], nullptr);
+        else if (arg == "--min-crushes" && hasValue) filter.minCrushes = std::atoi(argv[++i]);
+        else if (arg == "-h" || arg == "--help") { printUsage(); return 0; }
+        else if (!arg.empty() && arg[0] == '-') { std::cerr << "Opcion desconocida: " << arg << std::endl; printUsage(); return 1; }
+        else maps.push_back(arg);
+    }
+
+    if (!replayFile.empty()) return verifyReplay(replayFile);
+
+    if (maps.empty()) {
+        printUsage();
+        return 1;
+    }
+
+    std::vector<FarmJob> jobs;
+    for (const auto& map : maps) {
+        for (int s = 0; s < numSeeds; ++s) jobs.push_back({map, seedBase + (uint32_t)s});
+    }
+
+    RaceFarm farm(threads);
+    auto t0 = std::chrono::steady_clock::now();
+    std::vector<RaceResult> results = farm.run(jobs, config);
+    double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    if (tableOutput) writeRaceTableHeader(std::cout);
+
+    int failures = 0;
+    int shown = 0;
+    double simulatedSeconds = 0.0;
+    std::vector<RaceResult> keepers; // Las que pasan el filtro, para --save-replays
+    for (const auto& r : results) {
+        if (!r.loaded) failures++;
+        simulatedSeconds += r.finishTime;
+        if (!filter.accepts(r)) continue;
+
+        shown++;
+        if (r.loaded) keepers.push_back(r);
+        if (tableOutput) writeRaceTableRow(std::cout, r);
+        else { writeRaceJson(std::cout, r); std::cout << "\n"; }
+    }
+    std::cout.flush();
+
+    // Stats de velocidad por stderr para no ensuciar la salida
+    std::cerr << "[HEADLESS] " << results.size() << " carreras (" << shown << " pasan el filtro) en "
+              << wallSeconds << "s con " << farm.getThreadCount() << " hilos, "
+              << simulatedSeconds << "s simulados (x"
+              << (wallSeconds > 0.0 ? simulatedSeconds / wallSeconds : 0.0) << ")" << std::endl;
+
+    if (!replayDirectory.empty()) failures += saveReplays(keepers, config, replayDirectory, farm.getThreadCount());
+
+    return failures > 0 ? 1 : 0;
+}
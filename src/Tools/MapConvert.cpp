@@ -0,0 +1,94 @@
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include <filesystem>
+
+#include "../Physics/MapFile.hpp"
+
+namespace fs = std::filesystem;
+
+// --- CONVERSOR DE MAPAS ---
+// Texto <-> binario (.cmap). La dirección sale del formato de entrada (el magic):
+// un .txt se compila a .cmap y un .cmap se vuelve a pasar a texto para editarlo.
+
+static void printUsage() {
+    std::cerr << "Uso: ChaosMapConvert <mapa> [mapa2 ...] [opciones]\n"
+              << "  -o ARCHIVO   Salida (solo con un mapa). Default: al lado, con la otra extension\n"
+              << "  --check      Relee lo escrito y compara campo por campo contra la entrada" << std::endl;
+}
+
+static bool sameMap(const MapData& a, const MapData& b) {
+    // Texto con 9 dígitos: si coincide, coinciden todos los floats bit a bit
+    return writeMapText(a, true) == writeMapText(b, true);
+}
+
+static bool convert(const std::string& input, std::string output, bool check) {
+    std::ifstream file(input, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "[MAP] No existe: " << input << std::endl;
+        return false;
+    }
+    std::string bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    // La dirección la decide el contenido, no la extensión (un .cmap guardado como .txt existe)
+    bool inputIsBinary = isBinaryMap(bytes.data(), bytes.size());
+    MapData map;
+    bool parsed = inputIsBinary ? parseMapBinary(bytes.data(), bytes.size(), map) : parseMapText(bytes, map);
+    if (!parsed) return false;
+
+    bool toBinary = !inputIsBinary;
+    if (output.empty()) {
+        output = fs::path(input).replace_extension(toBinary ? MapBinaryExtension : ".txt").string();
+        if (fs::path(output) == fs::path(input)) {
+            std::cerr << "[MAP] " << input << " ya tiene la extension de salida: pasale -o" << std::endl;
+            return false;
+        }
+    } else {
+        toBinary = hasBinaryMapExtension(output);
+    }
+
+    if (!writeMapFile(output, map, toBinary)) {
+        std::cerr << "[MAP] No se pudo escribir: " << output << std::endl;
+        return false;
+    }
+
+    if (check) {
+        MapData reread;
+        if (!readMapFile(output, reread) || !sameMap(map, reread)) {
+            std::cerr << "[MAP] " << output << " no vuelve igual que " << input << std::endl;
+            return false;
+        }
+    }
+
+    std::cout << input << " -> " << output << " (" << map.walls.size() << " paredes, "
+              << map.knives.size() << " cuchillos)" << std::endl;
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    std::vector<std::string> inputs;
+    std::string output;
+    bool check = false;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "-o" && i + 1 < argc) output = argv[++i];
+        else if (arg == "--check") check = true;
+        else if (arg == "-h" || arg == "--help") { printUsage(); return 0; }
+        else if (!arg.empty() && arg[0] == '-') { printUsage(); return 1; }
+        else inputs.push_back(arg);
+    }
+
+    if (inputs.empty() || (!output.empty() && inputs.size() > 1)) {
+        printUsage();
+        return 1;
+    }
+
+    int failed = 0;
+    for (const auto& input : inputs) {
+        if (!convert(input, output, check)) failed++;
+    }
+    return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,99 @@
+#include "Profiler.hpp"
+#include <algorithm>
+#include <iostream>
+
+static const char* const stageNames[] = {
+    "physics_step", "wall_expansion", "moving_platforms", "wall_visuals", "particles",
+    "draw_walls", "draw_trails", "draw_particles",
+    "bloom_brightness", "bloom_blur", "bloom_blend",
+    "recorder_frame"
+};
+static_assert(sizeof(stageNames) / sizeof(stageNames[0]) == Profiler::StageCount, "Falta el nombre de un ProfileStage");
+
+float Profiler::Frame::otherMs() const {
+    float sum = 0.0f;
+    for (float ms : stageMs) sum += ms;
+    return std::max(0.0f, totalMs - sum);
+}
+
+Profiler::Profiler(size_t historySize)
+    : history(std::max<size_t>(1, historySize))
+{
+}
+
+const char* Profiler::stageName(ProfileStage stage) {
+    return stageNames[(int)stage];
+}
+
+void Profiler::beginFrame() {
+    current = Frame();
+    inFrame = enabled;
+    if (inFrame) frameStart = std::chrono::steady_clock::now();
+}
+
+void Profiler::endFrame() {
+    // Si lo prendieron a mitad de frame, ese frame no cuenta (le faltaría el principio)
+    if (!inFrame || !enabled) return;
+    inFrame = false;
+
+    current.totalMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - frameStart).count();
+
+    history[head] = current;
+    head = (head + 1) % history.size();
+    count = std::min(count + 1, history.size());
+
+    if (csv.is_open()) {
+        csv << csvFrames++ << "," << current.totalMs;
+        for (float ms : current.stageMs) csv << "," << ms;
+        csv << "," << current.otherMs() << "\n";
+    }
+}
+
+const Profiler::Frame& Profiler::frameAt(size_t i) const {
+    size_t oldest = (head + history.size() - count) % history.size();
+    return history[(oldest + i) % history.size()];
+}
+
+Profiler::Frame Profiler::average() const {
+    Frame avg;
+    if (count == 0) return avg;
+    for (size_t i = 0; i < count; ++i) {
+        const Frame& f = frameAt(i);
+        avg.totalMs += f.totalMs;
+        for (int s = 0; s < StageCount; ++s) avg.stageMs[s] += f.stageMs[s];
+    }
+    avg.totalMs /= count;
+    for (float& ms : avg.stageMs) ms /= count;
+    return avg;
+}
+
+Profiler::Frame Profiler::peak() const {
+    Frame top;
+    for (size_t i = 0; i < count; ++i) {
+        const Frame& f = frameAt(i);
+        top.totalMs = std::max(top.totalMs, f.totalMs);
+        for (int s = 0; s < StageCount; ++s) top.stageMs[s] = std::max(top.stageMs[s], f.stageMs[s]);
+    }
+    return top;
+}
+
+bool Profiler::startCsv(const std::string& filename) {
+    stopCsv();
+    csv.open(filename);
+    if (!csv.is_open()) {
+        std::cerr << "[PROFILER] No se pudo abrir " << filename << std::endl;
+        return false;
+    }
+
+    csvFrames = 0;
+    csv << "frame,total_ms";
+    for (const char* name : stageNames) csv << "," << name << "_ms";
+    csv << ",other_ms\n";
+    return true;
+}
+
+void Profiler::stopCsv() {
+    if (!csv.is_open()) return;
+    csv.close();
+    std::cout << "[PROFILER] CSV cerrado (" << csvFrames << " frames)" << std::endl;
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <chrono>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// --- PROFILER DE FRAME ---
+// Timers con scope en los caminos calientes (física, render, bloom, Recorder).
+// Cada subsistema recibe un Profiler* como el SoundManager: nullptr = no mide nada
+// (headless, granja de carreras), así que en varios hilos no hay nada compartido.
+// Los tiempos son de CPU: el GPU corre asíncrono, lo que tarde de verdad un shader
+// aparece en quien espere el resultado (display, el readback del Recorder).
+
+enum class ProfileStage {
+    PhysicsStep,
+    WallExpansion,
+    MovingPlatforms,
+    WallVisuals,
+    Particles,
+    DrawWalls,
+    DrawTrails,
+    DrawParticles,
+    BloomBrightness,
+    BloomBlur,
+    BloomBlend,
+    RecorderFrame,
+    Count
+};
+
+class Profiler {
+public:
+    static constexpr int StageCount = (int)ProfileStage::Count;
+
+    struct Frame {
+        float totalMs = 0.0f;              // De beginFrame a endFrame
+        float stageMs[StageCount] = {};    // Suma de todos los scopes del frame (ej: varios steps)
+        float otherMs() const;             // Lo que no cae en ningún stage (UI, display, vsync...)
+    };
+
+    explicit Profiler(size_t historySize = 240);
+
+    static const char* stageName(ProfileStage stage);
+
+    bool enabled = false; // Apagado cuesta un if por scope
+
+    void beginFrame();
+    void endFrame(); // Cierra el frame: va al historial y, si hay, al CSV
+    void add(ProfileStage stage, float ms) { current.stageMs[(int)stage] += ms; }
+
+    // Historial rodante (0 = el más viejo)
+    size_t frameCount() const { return count; }
+    size_t capacity() const { return history.size(); }
+    const Frame& frameAt(size_t i) const;
+    Frame average() const;
+    Frame peak() const; // Máximo por stage (no es un frame real)
+
+    // CSV: una fila por frame, en milisegundos
+    bool startCsv(const std::string& filename);
+    void stopCsv();
+    bool isCsvActive() const { return csv.is_open(); }
+    long long getCsvFrames() const { return csvFrames; }
+
+private:
+    std::chrono::steady_clock::time_point frameStart;
+    bool inFrame = false;
+    Frame current;
+
+    std::vector<Frame> history;
+    size_t head = 0; // Donde va el próximo
+    size_t count = 0;
+
+    std::ofstream csv;
+    long long csvFrames = 0;
+};
+
+// Mide desde que se construye hasta que sale del scope
+class ProfileScope {
+public:
+    ProfileScope(Profiler* profiler, ProfileStage stage)
+        : profiler((profiler && profiler->enabled) ? profiler : nullptr), stage(stage)
+    {
+        if (this->profiler) start = std::chrono::steady_clock::now();
+    }
+
+    ~ProfileScope() {
+        if (!profiler) return;
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        profiler->add(stage, std::chrono::duration<float, std::milli>(elapsed).count());
+    }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    Profiler* profiler;
+    ProfileStage stage;
+    std::chrono::steady_clock::time_point start;
+};
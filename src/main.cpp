@@ -6,132 +6,307 @@
 #include <iostream>
 #include <filesystem>
 #include <string>
-#include <deque>
+#include <chrono>
+#include <cmath>
 #include <cstdlib>
 
 #include "Physics/PhysicsWorld.hpp"
 #include "Recorder/Recorder.hpp"
 #include "Sound/SoundManager.hpp" 
+#include "Graphics/SceneRenderer.hpp"
+#include "Sim/Replay.hpp"
+#include "Sim/SnapshotRing.hpp"
+#include "Utils/Profiler.hpp"
 
 namespace fs = std::filesystem;
 
-struct Trail {
-    std::deque<sf::Vector2f> points;
-    sf::Color color;
-};
+// --- MÁQUINA DE ESTADOS PARA LA UI ESTILO UNITY ---
+enum class EntityType { None, Global, WinZone, Racers, Wall, Knife };
+
+const unsigned int RENDER_WIDTH = (unsigned int)WorldRenderSize;
+const unsigned int RENDER_HEIGHT = (unsigned int)WorldRenderSize;
+const float DISPLAY_SIZE = 900.0f;
+// El editor renderiza al tamaño del viewport; a resolución completa solo mientras graba
+const float PREVIEW_SCALE = DISPLAY_SIZE / RENDER_WIDTH;
+const unsigned int FPS = 60;
+const std::string VIDEO_DIRECTORY = "../output/video.mp4";
+const float VICTORY_DELAY = 0.5f; 
+
+static void printUsage() {
+    std::cerr << "Uso: ChaosEngine [--offline [opciones]]\n"
+              << "Sin argumentos abre el editor. Con --offline renderiza una carrera a video\n"
+              << "sin ventana ni ImGui, tan rápido como den la GPU y FFmpeg:\n"
+              << "  --map ARCHIVO     Mapa a correr (default ../levels/level_01.txt)\n"
+              << "  --song ARCHIVO    Canción para las paredes musicales\n"
+              << "  --replay ARCHIVO  Renderiza un replay (.chaosreplay) bit a bit en vez de --map/--seed\n"
+              << "  --seed S          Semilla (default 77, la del editor; misma que ChaosHeadless)\n"
+              << "  --chaos           Fuerza Chaos Mode\n"
+              << "  --max-seconds N   Corte si nadie gana (default 120)\n"
+              << "  --out ARCHIVO     Video de salida (default " << VIDEO_DIRECTORY << ")\n"
+              << "  --no-bloom        Sin post-proceso de neón\n"
+              << "  --profile-csv ARCHIVO  Tiempos por frame y por etapa (ms) a CSV" << std::endl;
+}
 
-struct AmbientParticle {
-    sf::Vector2f basePos;
-    float yPos;
-    float speedY;
-    float phaseOffset;
-    float phaseSpeed;
-    float amplitude;
-    float size;
-    sf::Color color;
+struct OfflineOptions {
+    std::string mapFile = "../levels/level_01.txt";
+    std::string songFile;
+    std::string replayFile;
+    std::string outputFile = VIDEO_DIRECTORY;
+    uint32_t seed = 77;
+    bool forceChaos = false;
+    float maxSeconds = 120.0f;
+    bool bloom = true;
+    std::string profileCsv;
 };
 
-const char* brightnessFrag = R"(
-    uniform sampler2D source;
-    uniform float threshold;
-    void main() {
-        vec4 color = texture2D(source, gl_TexCoord[0].xy);
-        
-        // NORMALIZACIÓN DE NEÓN:
-        // Usamos el canal más alto del pixel en lugar de la luminancia del ojo humano.
-        // Así un Azul puro (0,0,1) y un Verde puro (0,1,0) tienen un brillo = 1.0.
-        float maxBrightness = max(color.r, max(color.g, color.b));
-        
-        if (maxBrightness > threshold) {
-            gl_FragColor = color;
-        } else {
-            gl_FragColor = vec4(0.0, 0.0, 0.0, 1.0);
-        }
+// --- PANEL DEL PROFILER ---
+// Barras apiladas por frame (una por etapa + "otros") contra el presupuesto de 60 fps,
+// y una tabla con promedio y pico de cada etapa sobre la ventana rodante.
+static ImU32 profileStageColor(int stage) {
+    if (stage == Profiler::StageCount) return IM_COL32(90, 90, 90, 255); // Otros
+    return ImColor::HSV(stage / (float)Profiler::StageCount, 0.65f, 0.9f);
+}
+
+static void drawProfilerPanel(Profiler& profiler, bool* open, char* csvFile, size_t csvFileSize) {
+    ImGui::SetNextWindowSize(ImVec2(560, 480), ImGuiCond_FirstUseEver);
+    if (!ImGui::Begin("Profiler", open)) {
+        ImGui::End();
+        return;
     }
-)";
-
-// Desenfoque Gaussiano Separable (Muchísimo más rápido que el bidimensional)
-const char* blurFrag = R"(
-    uniform sampler2D source;
-    uniform vec2 dir; // Dirección del desenfoque (horizontal o vertical)
-    void main() {
-        vec2 uv = gl_TexCoord[0].xy;
-        vec4 color = vec4(0.0);
-        vec2 off1 = vec2(1.3846153846) * dir;
-        vec2 off2 = vec2(3.2307692308) * dir;
-        
-        color += texture2D(source, uv) * 0.2270270270;
-        color += texture2D(source, uv + off1) * 0.3162162162;
-        color += texture2D(source, uv - off1) * 0.3162162162;
-        color += texture2D(source, uv + off2) * 0.0702702703;
-        color += texture2D(source, uv - off2) * 0.0702702703;
-        
-        gl_FragColor = color;
+
+    const float budgetMs = 1000.0f / FPS;
+    const Profiler::Frame avg = profiler.average();
+    const Profiler::Frame top = profiler.peak();
+    ImGui::Text("Frame: %.2f ms prom / %.2f ms pico (presupuesto %.1f ms)", avg.totalMs, top.totalMs, budgetMs);
+    ImGui::TextDisabled("Tiempos de CPU: el GPU es asincrono y lo suyo cae en quien lo espere");
+
+    // --- GRÁFICO RODANTE ---
+    ImDrawList* drawList = ImGui::GetWindowDrawList();
+    ImVec2 origin = ImGui::GetCursorScreenPos();
+    float chartW = ImGui::GetContentRegionAvail().x;
+    float chartH = 160.0f;
+    ImGui::InvisibleButton("##ProfilerChart", ImVec2(chartW, chartH));
+    drawList->AddRectFilled(origin, ImVec2(origin.x + chartW, origin.y + chartH), IM_COL32(20, 20, 20, 255));
+
+    const float scaleMs = std::max(budgetMs * 2.0f, top.totalMs);
+    const float pxPerMs = chartH / scaleMs;
+    const float barW = chartW / (float)profiler.capacity();
+    const float bottom = origin.y + chartH;
+
+    for (size_t i = 0; i < profiler.frameCount(); ++i) {
+        const Profiler::Frame& f = profiler.frameAt(i);
+        float x0 = origin.x + i * barW;
+        float y = bottom;
+        for (int s = 0; s <= Profiler::StageCount; ++s) {
+            float ms = (s == Profiler::StageCount) ? f.otherMs() : f.stageMs[s];
+            float h = ms * pxPerMs;
+            if (h < 0.5f) continue;
+            drawList->AddRectFilled(ImVec2(x0, y - h), ImVec2(x0 + std::max(barW - 1.0f, 1.0f), y), profileStageColor(s));
+            y -= h;
+        }
     }
-)";
-
-const char* blendFrag = R"(
-    uniform sampler2D baseTexture;
-    uniform sampler2D bloomTexture;
-    uniform float multiplier;
-    void main() {
-        vec4 base = texture2D(baseTexture, gl_TexCoord[0].xy);
-        vec4 bloom = texture2D(bloomTexture, gl_TexCoord[0].xy);
-        // Fusión Aditiva: Luz + Luz
-        gl_FragColor = base + (bloom * multiplier);
+
+    float budgetY = bottom - budgetMs * pxPerMs;
+    drawList->AddLine(ImVec2(origin.x, budgetY), ImVec2(origin.x + chartW, budgetY), IM_COL32(255, 60, 60, 255));
+
+    // Tooltip con el desglose del frame que está bajo el mouse
+    if (ImGui::IsItemHovered() && profiler.frameCount() > 0) {
+        size_t i = (size_t)((ImGui::GetIO().MousePos.x - origin.x) / barW);
+        if (i < profiler.frameCount()) {
+            const Profiler::Frame& f = profiler.frameAt(i);
+            ImGui::BeginTooltip();
+            ImGui::Text("Frame: %.2f ms", f.totalMs);
+            for (int s = 0; s < Profiler::StageCount; ++s) {
+                if (f.stageMs[s] > 0.0f) ImGui::Text("%-18s %.3f ms", Profiler::stageName((ProfileStage)s), f.stageMs[s]);
+            }
+            ImGui::Text("%-18s %.3f ms", "otros", f.otherMs());
+            ImGui::EndTooltip();
+        }
     }
-)";
-
-// 1. Arriba de todo, cambiá la grilla para que responda a la resolución
-sf::Texture createGridTexture(int width, int height) {
-    sf::RenderTexture rt;
-    rt.create(width, height);
-    rt.clear(sf::Color::Transparent); // <--- MAGIA ACÁ: Fondo transparente
-    sf::RectangleShape line;
-    line.setFillColor(sf::Color(10, 10, 10)); 
-    
-    float lineThick = (width / 1080.0f) * 2.0f;
-    int stepSize = width / 18; 
-    
-    line.setSize(sf::Vector2f(lineThick, (float)height));
-    for (int x = 0; x < width; x += stepSize) { 
-        line.setPosition((float)x, 0.0f); rt.draw(line);
+
+    // --- TABLA POR ETAPA ---
+    if (ImGui::BeginTable("##ProfilerStages", 3, ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingStretchProp)) {
+        ImGui::TableSetupColumn("Etapa");
+        ImGui::TableSetupColumn("Prom (ms)");
+        ImGui::TableSetupColumn("Pico (ms)");
+        ImGui::TableHeadersRow();
+        for (int s = 0; s <= Profiler::StageCount; ++s) {
+            bool other = (s == Profiler::StageCount);
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::ColorButton("##c", ImColor(profileStageColor(s)), ImGuiColorEditFlags_NoTooltip, ImVec2(10, 10));
+            ImGui::SameLine();
+            ImGui::TextUnformatted(other ? "otros" : Profiler::stageName((ProfileStage)s));
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", other ? avg.otherMs() : avg.stageMs[s]);
+            ImGui::TableNextColumn();
+            if (!other) ImGui::Text("%.3f", top.stageMs[s]);
+        }
+        ImGui::EndTable();
     }
-    line.setSize(sf::Vector2f((float)width, lineThick));
-    for (int y = 0; y < height; y += stepSize) {
-        line.setPosition(0.0f, (float)y); rt.draw(line);
+
+    // --- CSV ---
+    ImGui::Separator();
+    ImGui::SetNextItemWidth(-110);
+    ImGui::InputText("##ProfileCsv", csvFile, csvFileSize);
+    ImGui::SameLine();
+    if (profiler.isCsvActive()) {
+        if (ImGui::Button("STOP CSV", ImVec2(-1, 0))) profiler.stopCsv();
+        ImGui::Text("Grabando CSV: %lld frames", profiler.getCsvFrames());
+    } else if (ImGui::Button("START CSV", ImVec2(-1, 0))) {
+        profiler.startCsv(csvFile);
     }
-    rt.display();
-    return rt.getTexture();
-}
 
-sf::Color lerpColor(const sf::Color& a, const sf::Color& b, float t) {
-    if (t < 0.0f) t = 0.0f;
-    if (t > 1.0f) t = 1.0f;
-    return sf::Color(
-        (sf::Uint8)(a.r + (b.r - a.r) * t),
-        (sf::Uint8)(a.g + (b.g - a.g) * t),
-        (sf::Uint8)(a.b + (b.b - a.b) * t),
-        (sf::Uint8)(a.a + (b.a - a.a) * t)
-    );
+    ImGui::End();
 }
 
-void SoundManager::sendToRecorder(const sf::Int16* samples, std::size_t count, float vol) {
-    if (recorder) {
-        recorder->addAudioEvent(samples, count, vol);
+// --- RENDER OFFLINE ---
+// El modo grabación del editor igual queda atado a setFramerateLimit + vsync: una carrera
+// de 60 s tarda 60 s como mínimo. Acá no hay ventana ni ImGui: se simula, se dibuja al
+// RenderTexture de la escena y se manda a FFmpeg, sin esperar a nadie más que al encoder.
+// Mismo orden de llamadas que el modo grabación (1 frame = 1 step), así sale el mismo video.
+static int runOfflineRender(const OfflineOptions& opts) {
+    SoundManager soundManager;
+    soundManager.mutePlayback = true; // A toda velocidad por los parlantes sería un ruido bárbaro
+
+    PhysicsWorld physics(RENDER_WIDTH, RENDER_HEIGHT, &soundManager);
+    physics.setParticleSize((RENDER_WIDTH / 1080.0f) * 4.0f);
+
+    Profiler profiler; // Solo mide con --profile-csv
+    if (!opts.profileCsv.empty()) profiler.enabled = profiler.startCsv(opts.profileCsv);
+    physics.setProfiler(&profiler);
+
+    // Con replay el mapa, la semilla y los ajustes salen del archivo
+    const bool replaying = !opts.replayFile.empty();
+    ReplayData replayData;
+    ReplayPlayer player;
+    if (replaying) {
+        if (!loadReplay(opts.replayFile, replayData)) return 1;
+        player.begin(physics, replayData);
+        // La canción no toca la física: se puede cambiar sin romper el replay
+        if (!opts.songFile.empty()) physics.loadSong(opts.songFile);
+    } else {
+        physics.setSeed(opts.seed);
+        if (!physics.loadMap(opts.mapFile)) {
+            std::cerr << "[OFFLINE] No se pudo cargar el mapa: " << opts.mapFile << std::endl;
+            return 1;
+        }
+        if (!opts.songFile.empty()) physics.loadSong(opts.songFile);
+        if (opts.forceChaos) physics.enableChaos = true;
+        physics.isPaused = false; // loadMap deja todo en pausa para el editor
     }
-}
 
-// --- MÁQUINA DE ESTADOS PARA LA UI ESTILO UNITY ---
-enum class EntityType { None, Global, WinZone, Racers, Wall, Knife };
+    SceneRenderer scene(RENDER_WIDTH, RENDER_HEIGHT);
+    if (!scene.init()) return -1;
+    scene.enableBloom = opts.bloom;
+    scene.profiler = &profiler;
+
+    fs::path outputDir = fs::path(opts.outputFile).parent_path();
+    if (!outputDir.empty() && !fs::exists(outputDir)) fs::create_directories(outputDir);
+
+    RecorderOptions recorderOptions;
+    recorderOptions.encoder = pickEncoderProfile("../config/encoders.txt");
+    Recorder recorder(RENDER_WIDTH, RENDER_HEIGHT, FPS, opts.outputFile, recorderOptions);
+    recorder.isRecording = true;
+    recorder.profiler = &profiler;
+    soundManager.setRecorderHook([&recorder](const sf::Int16* samples, std::size_t count, float vol) {
+        recorder.addAudioEvent(samples, count, vol);
+    });
 
-int main()
+    const float timeStep = 1.0f / 60.0f;
+    const int32 velIter = 8;
+    const int32 posIter = 3;
+    int maxFrames = (int)std::ceil(opts.maxSeconds / timeStep);
+    if (replaying && replayData.totalSteps > 0) {
+        // El replay ya sabe cuánto dura: que el corte no lo deje por la mitad
+        maxFrames = std::max(maxFrames, (int)replayData.totalSteps + (int)std::ceil(VICTORY_DELAY / timeStep) + 1);
+    }
+
+    float globalTime = 0.0f;
+    float victoryTimer = 0.0f;
+    int frames = 0;
+    auto t0 = std::chrono::steady_clock::now();
+
+    if (replaying) std::cout << "[OFFLINE] Renderizando replay " << opts.replayFile << " (" << replayData.mapName << ", semilla " << replayData.seed << ")..." << std::endl;
+    else std::cout << "[OFFLINE] Renderizando " << opts.mapFile << " (semilla " << opts.seed << ")..." << std::endl;
+
+    while (frames < maxFrames) {
+        profiler.beginFrame();
+        physics.updateWallVisuals(timeStep);
+        physics.updateParticles(timeStep);
+        globalTime += timeStep;
+
+        if (replaying) {
+            // Replay sin ganador (cortado por tiempo al grabar): termina donde terminó la grabación
+            if (!physics.gameOver && player.finished(physics)) break;
+            player.advance(physics);
+        } else {
+            physics.advance(timeStep, velIter, posIter);
+        }
+        scene.updateTrails(physics);
+
+        // Igual que el editor: después del gameOver dejamos correr VICTORY_DELAY y cortamos
+        if (physics.gameOver) {
+            victoryTimer += timeStep;
+            if (victoryTimer >= VICTORY_DELAY) break;
+        }
+
+        scene.updateDust(timeStep);
+        recorder.addFrame(scene.render(physics, globalTime));
+        profiler.endFrame();
+        frames++;
+
+        if (frames % (FPS * 10) == 0) {
+            double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+            std::cout << "[OFFLINE] " << frames / FPS << "s de video en " << elapsed << "s ("
+                      << (frames / elapsed) << " fps)" << std::endl;
+        }
+    }
+
+    if (replaying) {
+        std::cout << "[OFFLINE] Replay " << (player.matchesRecording(physics) ? "identico a la grabacion" : "DESINCRONIZADO (otro binario o replay roto)")
+                  << ": ganador " << physics.winnerIndex << " en " << player.stepsPlayed(physics) << " steps" << std::endl;
+    } else if (!physics.gameOver) {
+        std::cerr << "[OFFLINE] Nadie gano en " << opts.maxSeconds << "s: corto igual." << std::endl;
+    }
+
+    recorder.stop();
+    if (profiler.isCsvActive()) {
+        Profiler::Frame avg = profiler.average(); // Los últimos frames: el final de la carrera
+        std::cout << "[PROFILER] " << opts.profileCsv << ": frame prom " << avg.totalMs << " ms" << std::endl;
+        profiler.stopCsv();
+    }
+
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    std::cout << "[OFFLINE] " << frames << " frames en " << elapsed << "s ("
+              << (elapsed > 0.0 ? frames / elapsed : 0.0) << " fps)" << std::endl;
+    return 0;
+}
+
+int main(int argc, char** argv)
 {
-    const unsigned int RENDER_WIDTH = 2160;
-    const unsigned int RENDER_HEIGHT = 2160;
-    const float DISPLAY_SIZE = 900.0f;
-    const unsigned int FPS = 60;
-    const std::string VIDEO_DIRECTORY = "../output/video.mp4";
+    bool offline = false;
+    OfflineOptions offlineOptions;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = (i + 1 < argc);
+
+        if (arg == "--offline") offline = true;
+        else if (arg == "--map" && hasValue) offlineOptions.mapFile = argv[++i];
+        else if (arg == "--song" && hasValue) offlineOptions.songFile = argv[++i];
+        else if (arg == "--replay" && hasValue) offlineOptions.replayFile = argv[++i];
+        else if (arg == "--seed" && hasValue) offlineOptions.seed = (uint32_t)std::strtoul(argv[++i], nullptr, 10);
+        else if (arg == "--chaos") offlineOptions.forceChaos = true;
+        else if (arg == "--max-seconds" && hasValue) offlineOptions.maxSeconds = std::strtof(argv[++i], nullptr);
+        else if (arg == "--out" && hasValue) offlineOptions.outputFile = argv[++i];
+        else if (arg == "--no-bloom") offlineOptions.bloom = false;
+        else if (arg == "--profile-csv" && hasValue) offlineOptions.profileCsv = argv[++i];
+        else if (arg == "-h" || arg == "--help") { printUsage(); return 0; }
+        else { std::cerr << "Opcion desconocida: " << arg << std::endl; printUsage(); return 1; }
+    }
+
+    if (offline) return runOfflineRender(offlineOptions);
 
     sf::VideoMode desktopMode = sf::VideoMode::getDesktopMode();
     sf::RenderWindow window(desktopMode, "ChaosEngine - Neon Lab", sf::Style::Fullscreen);
@@ -153,63 +328,38 @@ int main()
     style.Colors[ImGuiCol_ButtonHovered] = ImVec4(0.35f, 0.35f, 0.35f, 1.0f);
     style.Colors[ImGuiCol_ButtonActive] = ImVec4(0.45f, 0.45f, 0.45f, 1.0f);
 
-    sf::RenderTexture gameBuffer;
-    if (!gameBuffer.create(RENDER_WIDTH, RENDER_HEIGHT)) {
-        std::cerr << "Pah, te quedaste sin VRAM bo. Falló el RenderTexture." << std::endl;
-        return -1;
-    }
-
-    // --- SETUP DE BLOOM ---
-    if (!sf::Shader::isAvailable()) {
-        std::cerr << "Pah, tu GPU no banca shaders. Olvidate del neón." << std::endl;
-        return -1;
-    }
-
-    sf::Font uiFont; uiFont.loadFromFile("../fonts/jetbrains_mono.ttf");
-
-    sf::Texture knifeTex;
-    // Si tenés una carpeta assets, meté el PNG ahí con el nombre "knife.png"
-    bool hasKnifeTex = knifeTex.loadFromFile("../assets/knife.png");
-    if (hasKnifeTex) {
-        knifeTex.setSmooth(true);
-        std::cout << ">>> Asset de cuchillo (499x499) cargado joya." << std::endl;
-    } else {
-        std::cout << ">>> No se encontro knife.png, usando hoja por defecto." << std::endl;
-    }
-
-    sf::Shader brightnessShader, blurShader, blendShader;
-    brightnessShader.loadFromMemory(brightnessFrag, sf::Shader::Fragment);
-    blurShader.loadFromMemory(blurFrag, sf::Shader::Fragment);
-    blendShader.loadFromMemory(blendFrag, sf::Shader::Fragment);
-
-    // Achicamos a la mitad para el cálculo del brillo. ¡Magia negra para optimizar!
-    unsigned int BLOOM_W = RENDER_WIDTH / 2;
-    unsigned int BLOOM_H = RENDER_HEIGHT / 2;
-    
-    sf::RenderTexture brightnessBuffer, blurBuffer1, blurBuffer2, finalBuffer;
-    brightnessBuffer.create(BLOOM_W, BLOOM_H);
-    blurBuffer1.create(BLOOM_W, BLOOM_H);
-    blurBuffer2.create(BLOOM_W, BLOOM_H);
-    finalBuffer.create(RENDER_WIDTH, RENDER_HEIGHT); // Este es el 4K final que grabamos
-
-    // Variables de control para ImGui
-    bool enableBloom = true;
-    float bloomThreshold = 0.9f; // A partir de qué brillo empieza a generar glow
-    float bloomMultiplier = 0.5f; // Intensidad del neón
-    int blurIterations = 3; // Cuántas pasadas de blur (más = glow más grande)
+    SceneRenderer scene(RENDER_WIDTH, RENDER_HEIGHT);
+    if (!scene.init()) return -1;
+    bool fullResPreview = false; // Para revisar detalle fino sin ponerse a grabar
 
     SoundManager soundManager; 
     PhysicsWorld physics(RENDER_WIDTH, RENDER_HEIGHT, &soundManager);
     physics.isPaused = true; 
+    // Tamaño de la partícula escalado a la resolución bruta (2160p)
+    physics.setParticleSize((RENDER_WIDTH / 1080.0f) * 4.0f);
+    std::cout << "[FX] Kernel de particulas: " << ParticlePool::kernelName() << std::endl;
     const auto& bodies = physics.getDynamicBodies();
 
     fs::path videoPath(VIDEO_DIRECTORY);
     fs::path outputDir = videoPath.parent_path();
     if (!fs::exists(outputDir)) fs::create_directories(outputDir);
 
-    Recorder recorder(RENDER_WIDTH, RENDER_HEIGHT, FPS, VIDEO_DIRECTORY);
+    // El encoder sale de config/encoders.txt (o CHAOS_ENCODER); "auto" prueba cuál anda en esta máquina
+    RecorderOptions recorderOptions;
+    recorderOptions.encoder = pickEncoderProfile("../config/encoders.txt");
+    Recorder recorder(RENDER_WIDTH, RENDER_HEIGHT, FPS, VIDEO_DIRECTORY, recorderOptions);
     recorder.isRecording = false; 
-    soundManager.setRecorder(&recorder);
+    soundManager.setRecorderHook([&recorder](const sf::Int16* samples, std::size_t count, float vol) {
+        recorder.addAudioEvent(samples, count, vol);
+    });
+
+    // Apagado hasta que se abra el panel: apagado no mide nada
+    Profiler profiler;
+    physics.setProfiler(&profiler);
+    scene.profiler = &profiler;
+    recorder.profiler = &profiler;
+    bool showProfiler = false;
+    static char profileCsvFile[128] = "../output/profile.csv";
 
     const float timeStep = 1.0f / 60.0f;
     int32 velIter = 8;
@@ -220,66 +370,45 @@ int main()
     float accumulator = 0.0f;
     float globalTime = 0.0f;
 
-    float victoryTimer = 0.0f;       
-    bool victorySequenceStarted = false; 
-    const float VICTORY_DELAY = 0.5f; 
+    float victoryTimer = 0.0f;
+    bool victorySequenceStarted = false;
 
     const char* racerNames[] = { "Cyan", "Magenta", "Green", "Yellow" };
-    sf::Color racerColors[] = {
-        sf::Color(0, 255, 255),   
-        sf::Color(255, 0, 255),   
-        sf::Color(57, 255, 20),   
-        sf::Color(255, 215, 0)    
-    };
     ImVec4 guiColors[] = {
-        ImVec4(0, 1, 1, 1),   
-        ImVec4(1, 0, 1, 1),   
-        ImVec4(0.2f, 1, 0.1f, 1),   
-        ImVec4(1, 0.8f, 0, 1)    
+        ImVec4(0, 1, 1, 1),
+        ImVec4(1, 0, 1, 1),
+        ImVec4(0.2f, 1, 0.1f, 1),
+        ImVec4(1, 0.8f, 0, 1)
     };
 
-    sf::Texture gridTexture = createGridTexture(RENDER_WIDTH, RENDER_HEIGHT);
-    sf::Sprite background(gridTexture);
-
-    std::vector<Trail> trails(4);
-    for(int i=0; i<4; ++i) trails[i].color = racerColors[i];
-
     static char mapFilename[128] = "../levels/level_01.txt";
     static char songFile[128] = "song.txt";
+    static char replayFilename[128] = "../output/race.chaosreplay";
+
+    // Línea de tiempo: una foto cada medio segundo, los últimos 2.5 minutos de carrera
+    SnapshotRing timeline(300, 30);
+    timeline.capture(physics, true);
+    int seekIndex = 0;
+
+    // Journal de la carrera: semilla + mapa + todo lo que se toque mientras corre
+    ReplayRecorder replayRecorder;
+    auto stopAndSaveReplay = [&]() {
+        if (!replayRecorder.isActive()) return;
+        replayRecorder.stop(physics);
+        if (saveReplay(replayFilename, replayRecorder.data())) {
+            std::cout << "[REPLAY] Guardado: " << replayFilename << " (" << replayRecorder.data().totalSteps << " steps, "
+                      << replayRecorder.data().edits.size() << " ediciones)" << std::endl;
+        } else {
+            std::cerr << "[REPLAY] No se pudo escribir " << replayFilename << std::endl;
+        }
+    };
 
     // Variables de estado de la Interfaz
     EntityType selectedType = EntityType::None;
-    int selectedIndex = -1;
-
-    // --- SETUP DE POLVO ATMOSFÉRICO ---
-    // --- SETUP DE POLVO ATMOSFÉRICO REFINADO ---
-    std::vector<AmbientParticle> ambientDust;
-    const int NUM_DUST = 70; // Bajamos la cantidad
-    for (int i = 0; i < NUM_DUST; ++i) {
-        AmbientParticle p;
-        p.basePos.x = (float)(std::rand() % RENDER_WIDTH);
-        p.yPos = (float)(std::rand() % RENDER_HEIGHT);
-        
-        // Más velocidad vertical: de 20 a 60 px/s (antes era 5-30)
-        p.speedY = -((float)(std::rand() % 40) + 20.0f); 
-        
-        p.phaseOffset = (float)(std::rand() % 628) / 100.0f;
-        
-        // Vaivén más rápido: frecuencia de oscilación aumentada
-        p.phaseSpeed = ((float)(std::rand() % 25) + 15.0f) / 10.0f; 
-        
-        // Amplitud mucho mayor: recorren más espacio horizontal (30 a 110 px)
-        p.amplitude = (float)(std::rand() % 80) + 30.0f; 
-        
-        p.size = (float)(std::rand() % 3) + 2.0f;
-        
-        // Mantenemos un alpha bajísimo para que sea un detalle sutil
-        sf::Uint8 alpha = 15 + (std::rand() % 25); 
-        p.color = sf::Color(180, 230, 255, alpha); 
-        ambientDust.push_back(p);
-    }
+    SlotHandle selectedHandle; // Pared o cuchillo seleccionado: no se corre si se borra otro
 
     while (window.isOpen()) {
+        profiler.beginFrame();
 
         sf::Event event;
         while (window.pollEvent(event)) {
@@ -307,16 +436,14 @@ int main()
         if (!physics.isPaused) {
             if (recorder.isRecording) {
                 // MODO GRABACIÓN: 1 Frame de Video = 1 Step de Física. (Chau acumulador)
-                physics.step(timeStep, velIter, posIter);
-                physics.updateWallExpansion(timeStep);
-                physics.updateMovingPlatforms(timeStep);
+                physics.advance(timeStep, velIter, posIter);
+                timeline.capture(physics);
             } else {
                 // MODO TIEMPO REAL: Usamos el acumulador para compensar tironcitos normales
                 accumulator += dtSec;
                 while (accumulator >= timeStep) {
-                    physics.step(timeStep, velIter, posIter);
-                    physics.updateWallExpansion(timeStep);
-                    physics.updateMovingPlatforms(timeStep);
+                    physics.advance(timeStep, velIter, posIter);
+                    timeline.capture(physics);
                     accumulator -= timeStep;
                 }
             }
@@ -324,24 +451,13 @@ int main()
             accumulator = 0.0f;
         }
 
-if (!physics.isPaused) {
-            for (size_t i = 0; i < bodies.size(); ++i) {
-                if (i >= trails.size()) break;
-                b2Vec2 pos = bodies[i]->GetPosition();
-                sf::Vector2f p(pos.x * physics.SCALE, pos.y * physics.SCALE);
-                trails[i].points.push_front(p);
-                float speed = bodies[i]->GetLinearVelocity().Length();
-                
-                // >>> ESTELAS MÁS CORTAS ACÁ <<<
-                size_t maxPoints = (size_t)(speed * 1.5f) + 5; 
-                if (trails[i].points.size() > maxPoints) trails[i].points.pop_back();
-            }
-        }
+        if (!physics.isPaused) scene.updateTrails(physics);
 
         if (physics.gameOver) {
             if (!victorySequenceStarted) {
                 std::cout << ">>> VICTORY DETECTED: Racer " << physics.winnerIndex << ". Finishing recording..." << std::endl;
                 victorySequenceStarted = true;
+                stopAndSaveReplay(); // La carrera terminó: el replay se cierra acá, no cuando se cierra la ventana
             }
             victoryTimer += dtSec;
             if (victoryTimer >= VICTORY_DELAY) {
@@ -388,9 +504,11 @@ if (!physics.isPaused) {
         ImGui::SetCursorPosY(15);
         if (ImGui::Button("RESET RACE", ImVec2(100, 30))) {
             physics.resetRacers();
-            for(auto& t : trails) t.points.clear();
+            scene.clearTrails();
             victoryTimer = 0.0f; 
             victorySequenceStarted = false; 
+            timeline.clear(); // Carrera nueva: las fotos de la anterior no sirven
+            timeline.capture(physics, true);
         }
 
         ImGui::SameLine();
@@ -402,6 +520,10 @@ if (!physics.isPaused) {
             physics.loadSong(songFile);
         }
 
+        ImGui::SameLine();
+        ImGui::SetCursorPosY(20);
+        ImGui::Checkbox("PROFILER", &showProfiler);
+
         ImGui::End();
 
         // 2. HIERARCHY (Panel Izquierdo)
@@ -416,35 +538,41 @@ if (!physics.isPaused) {
 
         ImGui::Separator();
             ImGui::TextColored(ImVec4(1, 0.0f, 1, 1), "POST-PROCESSING");
-            ImGui::Checkbox("Enable Neon Bloom", &enableBloom);
-            if (enableBloom) {
+            ImGui::Checkbox("Enable Neon Bloom", &scene.enableBloom);
+            if (scene.enableBloom) {
                 ImGui::Indent();
-                ImGui::DragFloat("Threshold", &bloomThreshold, 0.05f, 0.0f, 1.0f);
-                ImGui::DragFloat("Intensity", &bloomMultiplier, 0.05f, 0.0f, 5.0f);
-                ImGui::SliderInt("Glow Spread", &blurIterations, 1, 8);
+                ImGui::DragFloat("Threshold", &scene.bloomThreshold, 0.05f, 0.0f, 1.0f);
+                ImGui::DragFloat("Intensity", &scene.bloomMultiplier, 0.05f, 0.0f, 5.0f);
+                ImGui::SliderInt("Glow Spread", &scene.bloomLevels, 1, SceneRenderer::BloomMaxLevels);
                 ImGui::Unindent();
             }
+            ImGui::Checkbox("Full-Res Preview", &fullResPreview);
+            int dustCount = (int)scene.getDustCount();
+            if (ImGui::SliderInt("Dust Motes", &dustCount, 0, 20000)) scene.setDustCount((size_t)dustCount);
 
         ImGui::Separator();
         ImGui::TextColored(ImVec4(1, 0.5f, 0, 1), "WALLS");
         ImGui::SameLine(ImGui::GetWindowWidth() - 35);
         if (ImGui::Button("+", ImVec2(25, 20))) {
-            physics.addCustomWall(12.0f, 20.0f, 10.0f, 1.0f, 1);
+            selectedHandle = physics.addCustomWall(12.0f, 20.0f, 10.0f, 1.0f, 1);
             selectedType = EntityType::Wall;
-            selectedIndex = (int)physics.getCustomWalls().size() - 1;
         }
 
+        // En orden de inserción: borrar una pared no reacomoda la lista (ni los números)
         const auto& walls = physics.getCustomWalls();
-        for (int i = 0; i < (int)walls.size(); ++i) {
+        std::vector<uint32_t> wallOrder = walls.insertionOrder();
+        for (int i = 0; i < (int)wallOrder.size(); ++i) {
+            const CustomWall& wall = walls[wallOrder[i]];
             std::string label = "Wall " + std::to_string(i);
-            if (walls[i].soundID > 0) label += " [S]"; // ♪ Indica que tiene sonido asignado
-            if (walls[i].isExpandable) label += " [E]";
-            if (walls[i].isMoving) label += " [M]";
-            if (walls[i].shapeType == 1) label += " [Spike]";
+            if (wall.soundID > 0) label += " [S]"; // ♪ Indica que tiene sonido asignado
+            if (wall.isExpandable) label += " [E]";
+            if (wall.isMoving) label += " [M]";
+            if (wall.shapeType == 1) label += " [Spike]";
 
-            if (ImGui::Selectable(label.c_str(), selectedType == EntityType::Wall && selectedIndex == i)) {
+            WallHandle handle = walls.handleAt(wallOrder[i]);
+            if (ImGui::Selectable(label.c_str(), selectedType == EntityType::Wall && selectedHandle == handle)) {
                 selectedType = EntityType::Wall;
-                selectedIndex = i;
+                selectedHandle = handle;
             }
         }
 
@@ -452,17 +580,18 @@ if (!physics.isPaused) {
         ImGui::TextColored(ImVec4(1, 0.2f, 0.2f, 1), "WEAPONS");
         ImGui::SameLine(ImGui::GetWindowWidth() - 35);
         if (ImGui::Button("+##Knife", ImVec2(25, 20))) {
-            physics.addKnife(12.0f, 12.0f); // Spawnea en el medio
+            selectedHandle = physics.addKnife(12.0f, 12.0f); // Spawnea en el medio
             selectedType = EntityType::Knife;
-            selectedIndex = (int)physics.getKnives().size() - 1;
         }
 
         const auto& knives = physics.getKnives();
-        for (int i = 0; i < (int)knives.size(); ++i) {
+        std::vector<uint32_t> knifeOrder = knives.insertionOrder();
+        for (int i = 0; i < (int)knifeOrder.size(); ++i) {
             std::string label = "Knife " + std::to_string(i);
-            if (ImGui::Selectable(label.c_str(), selectedType == EntityType::Knife && selectedIndex == i)) {
+            KnifeHandle handle = knives.handleAt(knifeOrder[i]);
+            if (ImGui::Selectable(label.c_str(), selectedType == EntityType::Knife && selectedHandle == handle)) {
                 selectedType = EntityType::Knife;
-                selectedIndex = i;
+                selectedHandle = handle;
             }
         }
         
@@ -473,8 +602,8 @@ if (!physics.isPaused) {
         ImGui::SetNextWindowSize(ImVec2(panelWidth, desktopMode.height), ImGuiCond_Always);
         ImGui::Begin("Inspector", nullptr, ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoResize);
 
-        int wallToDelete = -1;
-        int wallToDuplicate = -1;
+        WallHandle wallToDelete;
+        WallHandle wallToDuplicate;
 
         if (selectedType == EntityType::None) {
             ImGui::TextDisabled("Select an object\nin the Hierarchy.");
@@ -485,8 +614,11 @@ if (!physics.isPaused) {
             ImGui::InputText("##Filename", mapFilename, IM_ARRAYSIZE(mapFilename));
             if (ImGui::Button("SAVE MAP", ImVec2(-1, 30))) physics.saveMap(mapFilename);
             if (ImGui::Button("LOAD MAP", ImVec2(-1, 30))) {
+                stopAndSaveReplay(); // Otro mapa = otra carrera
                 physics.loadMap(mapFilename);
-                for(auto& t : trails) t.points.clear();
+                scene.clearTrails();
+                timeline.clear();
+                timeline.capture(physics, true);
                 selectedType = EntityType::None; // Reset selection safety
             }
 
@@ -505,6 +637,54 @@ if (!physics.isPaused) {
                 ImGui::SliderFloat("Boost", &physics.chaosBoost, 1.0f, 3.0f);
                 ImGui::Unindent();
             }
+
+            ImGui::Separator();
+            ImGui::TextColored(ImVec4(0.3f, 0.8f, 1.0f, 1), "REPLAY");
+            ImGui::SetNextItemWidth(-1);
+            ImGui::InputText("##ReplayFile", replayFilename, IM_ARRAYSIZE(replayFilename));
+            if (!replayRecorder.isActive()) {
+                if (ImGui::Button("REC REPLAY (restarts race)", ImVec2(-1, 30))) {
+                    // Rearma el mundo desde el mapa actual: la carrera grabada arranca de cero
+                    // (con los ajustes del panel, que pueden no estar en el CONFIG del mapa)
+                    PhysicsSettings editorSettings = physics.getSettings();
+                    replayRecorder.begin(physics, physics.saveMapToString(), mapFilename, timeStep, velIter, posIter,
+                                         &editorSettings);
+                    scene.clearTrails();
+                    timeline.clear();
+                    timeline.capture(physics, true);
+                    victoryTimer = 0.0f;
+                    victorySequenceStarted = false;
+                    selectedType = EntityType::Global; // Los handles viejos ya no existen
+                }
+            } else {
+                ImGui::TextColored(ImVec4(1, 0.3f, 0.3f, 1), "Recording: %zu edits", replayRecorder.data().edits.size());
+                if (ImGui::Button("STOP & SAVE REPLAY", ImVec2(-1, 30))) stopAndSaveReplay();
+            }
+
+            ImGui::Separator();
+            ImGui::TextColored(ImVec4(0.8f, 0.8f, 0.3f, 1), "TIMELINE");
+            if (replayRecorder.isActive()) {
+                // Volver atrás rompería el journal: primero se corta el replay
+                ImGui::TextDisabled("Stop the replay recording to seek.");
+            } else if (!timeline.empty()) {
+                seekIndex = std::min(seekIndex, (int)timeline.size() - 1);
+                float seekSeconds = (timeline.stepAt(seekIndex) - timeline.stepAt(0)) * timeStep;
+                float endSeconds = (timeline.stepAt(timeline.size() - 1) - timeline.stepAt(0)) * timeStep;
+                ImGui::SetNextItemWidth(-1);
+                ImGui::SliderInt("##Seek", &seekIndex, 0, (int)timeline.size() - 1, "");
+                ImGui::Text("%.1fs / %.1fs (%zu checkpoints)", seekSeconds, endSeconds, timeline.size());
+
+                bool seek = ImGui::Button("GO TO CHECKPOINT", ImVec2(-1, 30));
+                bool recordFromHere = ImGui::Button("REC FROM CHECKPOINT", ImVec2(-1, 30));
+                if ((seek || recordFromHere) && timeline.restoreIndex(physics, (size_t)seekIndex)) {
+                    scene.clearTrails();
+                    victoryTimer = 0.0f;
+                    victorySequenceStarted = physics.gameOver;
+                    accumulator = 0.0f;
+                    physics.isPaused = !recordFromHere || physics.gameOver;
+                    if (recordFromHere) recorder.isRecording = true;
+                }
+            }
         }
         else if (selectedType == EntityType::WinZone) {
             ImGui::TextColored(ImVec4(1, 0.8f, 0, 1), "WIN ZONE CONFIG");
@@ -516,14 +696,14 @@ if (!physics.isPaused) {
             ImGui::Checkbox("Enable Neon Pulse (Glow)", &physics.winZoneGlow);
         }
         else if (selectedType == EntityType::Knife) {
-            if (selectedIndex >= 0 && selectedIndex < physics.getKnives().size()) {
-                auto& k = physics.getKnives()[selectedIndex];
+            if (KnifeItem* knife = physics.getKnives().get(selectedHandle)) {
+                auto& k = *knife;
                 
-                ImGui::TextColored(ImVec4(1, 0.2f, 0.2f, 1), "KNIFE %d", selectedIndex);
+                ImGui::TextColored(ImVec4(1, 0.2f, 0.2f, 1), "KNIFE %d", physics.getKnives().insertionIndexOf(selectedHandle));
                 
                 float pos[2] = { k.initialPos.x, k.initialPos.y };
                 if (ImGui::DragFloat2("Position", pos, 0.1f)) {
-                    physics.updateKnifePos(selectedIndex, pos[0], pos[1]);
+                    physics.updateKnifePos(selectedHandle, pos[0], pos[1]);
                 }
                 
                 if (k.isPickedUp) {
@@ -538,7 +718,7 @@ if (!physics.isPaused) {
                 ImGui::PushStyleColor(ImGuiCol_Button, (ImVec4)ImColor::HSV(0.0f, 0.6f, 0.6f));
                 ImGui::PushStyleColor(ImGuiCol_ButtonHovered, (ImVec4)ImColor::HSV(0.0f, 0.7f, 0.7f));
                 if (ImGui::Button("DELETE KNIFE", ImVec2(-1, 30))) {
-                    physics.removeKnife(selectedIndex);
+                    physics.removeKnife(selectedHandle);
                     selectedType = EntityType::None;
                 }
                 ImGui::PopStyleColor(2);
@@ -566,19 +746,25 @@ if (!physics.isPaused) {
                 std::string headerName = (i < 4) ? std::string(racerNames[i]) : "Racer " + std::to_string(i);
                 if (ImGui::CollapsingHeader(headerName.c_str())) {
                     b2Vec2 pos = b->GetPosition(); float p[2] = { pos.x, pos.y };
-                    if (ImGui::DragFloat2("Pos", p, 0.1f)) { b->SetTransform(b2Vec2(p[0], p[1]), b->GetAngle()); b->SetAwake(true); }
+                    if (ImGui::DragFloat2("Pos", p, 0.1f)) physics.setRacerPosition((int)i, p[0], p[1]);
                     b2Vec2 vel = b->GetLinearVelocity(); float v[2] = { vel.x, vel.y };
-                    if (ImGui::DragFloat2("Vel", v, 0.1f)) { b->SetLinearVelocity(b2Vec2(v[0], v[1])); b->SetAwake(true); }
+                    if (ImGui::DragFloat2("Vel", v, 0.1f)) physics.setRacerVelocity((int)i, v[0], v[1]);
                 }
                 ImGui::PopStyleColor();
                 ImGui::PopID();
             }
         }
         else if (selectedType == EntityType::Wall) {
-            if (selectedIndex >= 0 && selectedIndex < physics.getCustomWalls().size()) {
-                CustomWall& w = physics.getCustomWalls()[selectedIndex];
+            if (CustomWall* wall = physics.getWall(selectedHandle)) {
+                CustomWall& w = *wall;
+                auto& allWalls = physics.getCustomWalls();
+
+                // El inspector edita una copia; si cambió algo se aplica de una con setWallProps
+                // (así la edición queda en el journal del replay y no se toca la pared por atrás)
+                WallProps props = physics.getWallProps(selectedHandle);
+                const WallProps propsBefore = props;
                 
-                ImGui::TextColored(ImVec4(1, 0.5f, 0, 1), "WALL %d", selectedIndex);
+                ImGui::TextColored(ImVec4(1, 0.5f, 0, 1), "WALL %d", allWalls.insertionIndexOf(selectedHandle));
                 
                 float pos[2] = { w.body->GetPosition().x, w.body->GetPosition().y };
                 float size[2] = { w.width, w.height };
@@ -591,32 +777,32 @@ if (!physics.isPaused) {
 
                 ImGui::Separator();
                 ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "DESTRUCTION SYSTEM");
-                if (ImGui::Checkbox("Is Destructible", &w.isDestructible)) {
-                    if (w.isDestructible) w.currentHits = w.maxHits;
+                if (ImGui::Checkbox("Is Destructible", &props.isDestructible)) {
+                    if (props.isDestructible) props.currentHits = props.maxHits;
                 }
 
-                if (w.isDestructible) {
+                if (props.isDestructible) {
                     ImGui::Indent();
-                    int oldMax = w.maxHits;
-                    if (ImGui::SliderInt("Max Hits", &w.maxHits, 1, 200)) {
+                    int oldMax = props.maxHits;
+                    if (ImGui::SliderInt("Max Hits", &props.maxHits, 1, 200)) {
                         // FIX LÓGICO: Si alteramos el máximo, ajustamos la vida actual en caliente.
-                        if (w.currentHits == oldMax) w.currentHits = w.maxHits; 
-                        else if (w.currentHits > w.maxHits) w.currentHits = w.maxHits;
+                        if (props.currentHits == oldMax) props.currentHits = props.maxHits; 
+                        else if (props.currentHits > props.maxHits) props.currentHits = props.maxHits;
                     }
                     
                     // Slider explícito de vida para control total
-                    ImGui::SliderInt("Current Hits", &w.currentHits, 1, w.maxHits);
+                    ImGui::SliderInt("Current Hits", &props.currentHits, 1, props.maxHits);
                     
                     // --- NUEVO: TOGGLE TEXTO / LEDS ---
-                    ImGui::Checkbox("Use Text for HP (Instead of LEDs)", &w.useTextForHP);
+                    ImGui::Checkbox("Use Text for HP (Instead of LEDs)", &props.useTextForHP);
 
-                    float healthPct = (float)w.currentHits / (float)w.maxHits;
-                    std::string hpOverlay = std::to_string(w.currentHits) + " / " + std::to_string(w.maxHits);
+                    float healthPct = (float)props.currentHits / (float)props.maxHits;
+                    std::string hpOverlay = std::to_string(props.currentHits) + " / " + std::to_string(props.maxHits);
                     ImGui::ProgressBar(healthPct, ImVec2(-1, 0), hpOverlay.c_str());
                     ImGui::Unindent();
                 }
                 
-                if (changed) physics.updateCustomWall(selectedIndex, pos[0], pos[1], size[0], size[1], snd, w.shapeType, w.rotation);
+                if (changed) physics.updateCustomWall(selectedHandle, pos[0], pos[1], size[0], size[1], snd, w.shapeType, w.rotation);
 
                 ImGui::Separator();
                 ImGui::Text("Geometry");
@@ -625,7 +811,7 @@ if (!physics.isPaused) {
                 bool geoChanged = false;
 
                 if (ImGui::RadioButton("Box", sType == 0)) { sType = 0; geoChanged = true; } ImGui::SameLine();
-                if (ImGui::RadioButton("Spike", sType == 1)) { sType = 1; geoChanged = true; w.isDeadly = true; }
+                if (ImGui::RadioButton("Spike", sType == 1)) { sType = 1; geoChanged = true; props.isDeadly = true; }
 
                 if (ImGui::SliderFloat("Rotation", &rotDeg, 0.0f, 360.0f, "%.0f deg")) geoChanged = true;
                 
@@ -636,7 +822,7 @@ if (!physics.isPaused) {
 
                 if (geoChanged || changed) { 
                     float rotRad = rotDeg * 3.14159f / 180.0f;
-                    physics.updateCustomWall(selectedIndex, pos[0], pos[1], size[0], size[1], snd, sType, rotRad);
+                    physics.updateCustomWall(selectedHandle, pos[0], pos[1], size[0], size[1], snd, sType, rotRad);
                 }
 
                 ImGui::Separator();
@@ -651,670 +837,119 @@ if (!physics.isPaused) {
                 const char* colorNames[] = { "Cyan", "Magenta", "Lime", "Orange", "Purple", "Red", "Gold", "Blue", "Pink" };
                 ImGui::SetNextItemWidth(-1);
                 if (ImGui::Combo("##Color", &currentColorIdx, colorNames, IM_ARRAYSIZE(colorNames))) {
-                    physics.updateWallColor(selectedIndex, currentColorIdx);
+                    physics.updateWallColor(selectedHandle, currentColorIdx);
                 }
 
                 ImGui::Separator();
                 ImGui::TextColored(ImVec4(1.0f, 0.0f, 0.0f, 1.0f), "DANGER ZONE"); 
-                if (ImGui::Checkbox("IS DEADLY (Spike)", &w.isDeadly)) {
-                    if (w.isDeadly) physics.updateWallColor(selectedIndex, 5); 
+                if (ImGui::Checkbox("IS DEADLY (Spike)", &props.isDeadly)) {
+                    if (props.isDeadly) physics.updateWallColor(selectedHandle, 5); 
                 }
 
                 ImGui::Separator();
                 if (ImGui::CollapsingHeader("Expansion Properties")) {
-                    ImGui::Checkbox("Is Expandable", &w.isExpandable);
-                    if (w.isExpandable) {
+                    ImGui::Checkbox("Is Expandable", &props.isExpandable);
+                    if (props.isExpandable) {
                         ImGui::Indent();
-                        ImGui::DragFloat("Start Delay", &w.expansionDelay, 0.1f, 0.0f, 60.0f);
-                        ImGui::DragFloat("Speed", &w.expansionSpeed, 0.05f, 0.01f, 10.0f);
-                        ImGui::RadioButton("X", &w.expansionAxis, 0); ImGui::SameLine();
-                        ImGui::RadioButton("Y", &w.expansionAxis, 1); ImGui::SameLine();
-                        ImGui::RadioButton("XY", &w.expansionAxis, 2);
-                        ImGui::Checkbox("Stop on Contact", &w.stopOnContact);
-                        if (w.stopOnContact) ImGui::InputInt("Target Wall", &w.stopTargetIdx);
-                        ImGui::DragFloat("Max Size", &w.maxSize, 0.5f, 0.0f, 100.0f);
+                        ImGui::DragFloat("Start Delay", &props.expansionDelay, 0.1f, 0.0f, 60.0f);
+                        ImGui::DragFloat("Speed", &props.expansionSpeed, 0.05f, 0.01f, 10.0f);
+                        ImGui::RadioButton("X", &props.expansionAxis, 0); ImGui::SameLine();
+                        ImGui::RadioButton("Y", &props.expansionAxis, 1); ImGui::SameLine();
+                        ImGui::RadioButton("XY", &props.expansionAxis, 2);
+                        ImGui::Checkbox("Stop on Contact", &props.stopOnContact);
+                        if (props.stopOnContact) {
+                            // En pantalla va el número de la jerarquía; adentro guardamos el handle
+                            int targetIdx = allWalls.insertionIndexOf(props.stopTarget);
+                            if (ImGui::InputInt("Target Wall", &targetIdx)) {
+                                props.stopTarget = (targetIdx >= 0 && targetIdx < (int)allWalls.size())
+                                    ? allWalls.handleAt(allWalls.insertionOrder()[targetIdx]) : WallHandle();
+                            }
+                        }
+                        ImGui::DragFloat("Max Size", &props.maxSize, 0.5f, 0.0f, 100.0f);
                         ImGui::Unindent();
                     }
                 }
 
                 if (ImGui::CollapsingHeader("Kinematic Movement")) {
-                    if (ImGui::Checkbox("Is Moving Platform", &w.isMoving)) {
-                        if (w.isMoving) {
-                            w.pointA = w.body->GetPosition();
-                            w.pointB = w.pointA + b2Vec2(5.0f, 0.0f);
-                            w.body->SetType(b2_kinematicBody);
-                        } else {
-                            w.body->SetType(b2_staticBody);
-                            w.body->SetLinearVelocity(b2Vec2(0.0f, 0.0f)); 
+                    if (ImGui::Checkbox("Is Moving Platform", &props.isMoving)) {
+                        // El cambio de tipo del b2Body lo hace setWallProps
+                        if (props.isMoving) {
+                            props.pointA = w.body->GetPosition();
+                            props.pointB = props.pointA + b2Vec2(5.0f, 0.0f);
                         }
                     }
 
-                    if (w.isMoving) {
+                    if (props.isMoving) {
                         ImGui::Indent();
-                        float pA[2] = { w.pointA.x, w.pointA.y };
-                        if (ImGui::DragFloat2("Point A", pA, 0.1f)) w.pointA.Set(pA[0], pA[1]);
+                        float pA[2] = { props.pointA.x, props.pointA.y };
+                        if (ImGui::DragFloat2("Point A", pA, 0.1f)) props.pointA.Set(pA[0], pA[1]);
                         
-                        float pB[2] = { w.pointB.x, w.pointB.y };
-                        if (ImGui::DragFloat2("Point B", pB, 0.1f)) w.pointB.Set(pB[0], pB[1]);
+                        float pB[2] = { props.pointB.x, props.pointB.y };
+                        if (ImGui::DragFloat2("Point B", pB, 0.1f)) props.pointB.Set(pB[0], pB[1]);
                         
-                        ImGui::DragFloat("Speed", &w.moveSpeed, 0.1f, 0.1f, 50.0f);
+                        ImGui::DragFloat("Speed", &props.moveSpeed, 0.1f, 0.1f, 50.0f);
                         
-                        if (ImGui::Button("Set A = Current", ImVec2(-1, 0))) w.pointA = w.body->GetPosition();
-                        if (ImGui::Button("Set B = Current", ImVec2(-1, 0))) w.pointB = w.body->GetPosition();
-
-                        ImGui::Checkbox("Reverse on Wall", &w.reverseOnContact);
-                        if (w.reverseOnContact) {
-                            ImGui::Checkbox("Free Bounce", &w.freeBounce);
-                            if (w.isFreeBouncing && ImGui::Button("Reset Route")) {
-                                w.isFreeBouncing = false;
-                                w.body->SetLinearVelocity(b2Vec2(0.0f, 0.0f)); 
-                            }
+                        if (ImGui::Button("Set A = Current", ImVec2(-1, 0))) props.pointA = w.body->GetPosition();
+                        if (ImGui::Button("Set B = Current", ImVec2(-1, 0))) props.pointB = w.body->GetPosition();
+
+                        ImGui::Checkbox("Reverse on Wall", &props.reverseOnContact);
+                        if (props.reverseOnContact) {
+                            ImGui::Checkbox("Free Bounce", &props.freeBounce);
+                            if (props.isFreeBouncing && ImGui::Button("Reset Route")) props.isFreeBouncing = false;
                         }
                         ImGui::Unindent();
                     }
                 }
 
+                if (props != propsBefore) physics.setWallProps(selectedHandle, props);
+
                 ImGui::Separator();
                 ImGui::Spacing();
-                if (ImGui::Button("DUPLICATE", ImVec2(-1, 30))) wallToDuplicate = selectedIndex;
+                if (ImGui::Button("DUPLICATE", ImVec2(-1, 30))) wallToDuplicate = selectedHandle;
                 ImGui::PushStyleColor(ImGuiCol_Button, (ImVec4)ImColor::HSV(0.0f, 0.6f, 0.6f));
                 ImGui::PushStyleColor(ImGuiCol_ButtonHovered, (ImVec4)ImColor::HSV(0.0f, 0.7f, 0.7f));
                 ImGui::PushStyleColor(ImGuiCol_ButtonActive, (ImVec4)ImColor::HSV(0.0f, 0.8f, 0.8f));
-                if (ImGui::Button("DELETE", ImVec2(-1, 30))) wallToDelete = selectedIndex;
+                if (ImGui::Button("DELETE", ImVec2(-1, 30))) wallToDelete = selectedHandle;
                 ImGui::PopStyleColor(3);
 
             } else {
-                selectedType = EntityType::None; // Safe fallback si se borró y quedó desfasado el índice
+                selectedType = EntityType::None; // Safe fallback si la pared ya no existe (ej: se rompió)
             }
         }
 
         ImGui::End();
 
+        if (showProfiler) drawProfilerPanel(profiler, &showProfiler, profileCsvFile, sizeof(profileCsvFile));
+        // Cerrar el panel apaga los timers (y corta el CSV si quedó grabando)
+        profiler.enabled = showProfiler;
+        if (!showProfiler && profiler.isCsvActive()) profiler.stopCsv();
+
         // Procesamiento de comandos de la UI (Borrar / Duplicar)
-        if (wallToDelete != -1) {
+        if (wallToDelete.isValid()) {
             physics.removeCustomWall(wallToDelete);
             selectedType = EntityType::None; // Deseleccionamos por seguridad
         }
-        if (wallToDuplicate != -1) {
-            physics.duplicateCustomWall(wallToDuplicate);
+        if (wallToDuplicate.isValid()) {
+            selectedHandle = physics.duplicateCustomWall(wallToDuplicate); // Seleccionamos el clon nuevo
             selectedType = EntityType::Wall;
-            selectedIndex = (int)physics.getCustomWalls().size() - 1; // Seleccionamos el clon nuevo
         }
 
         // ==============================================
         // --- DRAW: RENDERIZADO AL BUFFER GIGANTE ---
         // ==============================================
-    // 1. Limpiar con el color de vacío
-        gameBuffer.clear(sf::Color(30, 30, 30)); 
+        // Polvo atmosférico: se mueve si corre la física o si estamos grabando
+        if (!physics.isPaused || recorder.isRecording) scene.updateDust(dtSec);
 
-        // 2. Dibujar Polvo Atmosférico con movimiento energético
-        sf::VertexArray dustVA(sf::Quads, ambientDust.size() * 4);
-        for(size_t i = 0; i < ambientDust.size(); ++i) {
-            auto& p = ambientDust[i];
-            
-            if (!physics.isPaused || recorder.isRecording) {
-                p.yPos += p.speedY * dtSec;
-                if (p.yPos < -50.0f) { 
-                    p.yPos = RENDER_HEIGHT + 50.0f;
-                    p.basePos.x = (float)(std::rand() % RENDER_WIDTH); 
-                }
-            }
-            
-            // Cálculo del vaivén horizontal
-            float currentX = p.basePos.x + std::sin(globalTime * p.phaseSpeed + p.phaseOffset) * p.amplitude;
-            float s = p.size;
-            
-            dustVA[i*4 + 0].position = sf::Vector2f(currentX - s, p.yPos - s);
-            dustVA[i*4 + 1].position = sf::Vector2f(currentX + s, p.yPos - s);
-            dustVA[i*4 + 2].position = sf::Vector2f(currentX + s, p.yPos + s);
-            dustVA[i*4 + 3].position = sf::Vector2f(currentX - s, p.yPos + s);
-            
-            dustVA[i*4 + 0].color = p.color;
-            dustVA[i*4 + 1].color = p.color;
-            dustVA[i*4 + 2].color = p.color;
-            dustVA[i*4 + 3].color = p.color;
-        }
-
-        sf::RenderStates dustStates;
-        dustStates.blendMode = sf::BlendAdd; // Para que el bloom las "atrape" un poquito
-        gameBuffer.draw(dustVA, dustStates);
-
-        // 3. Dibujar la grilla encima
-        gameBuffer.draw(background);
-
-        const auto& customWalls = physics.getCustomWalls();
-        for (const auto& wall : customWalls) {
-            b2Vec2 pos = wall.body->GetPosition();
-            float wPx = wall.width * physics.SCALE;
-            float hPx = wall.height * physics.SCALE;
-            
-            sf::Shape* shapeToDraw = nullptr;
-            sf::RectangleShape rectShape;
-            sf::ConvexShape triShape;
-
-            if (wall.shapeType == 1) {
-                triShape.setPointCount(3);
-                triShape.setPoint(0, sf::Vector2f(0.0f, -hPx / 2.0f));       
-                triShape.setPoint(1, sf::Vector2f(wPx / 2.0f, hPx / 2.0f));  
-                triShape.setPoint(2, sf::Vector2f(-wPx / 2.0f, hPx / 2.0f)); 
-                
-                triShape.setPosition(pos.x * physics.SCALE, pos.y * physics.SCALE);
-                triShape.setRotation(wall.body->GetAngle() * 180.0f / 3.14159f);
-                
-                shapeToDraw = &triShape;
-            } else {
-                rectShape.setSize(sf::Vector2f(wPx, hPx));
-                rectShape.setOrigin(wPx / 2.0f, hPx / 2.0f);
-                rectShape.setPosition(pos.x * physics.SCALE, pos.y * physics.SCALE);
-                rectShape.setRotation(wall.body->GetAngle() * 180.0f / 3.14159f);
-                
-                shapeToDraw = &rectShape;
-            }
-
-            sf::Color currentFill = lerpColor(wall.baseFillColor, wall.flashColor, wall.flashTimer);
-            sf::Color currentOutline = lerpColor(wall.neonColor, sf::Color::White, wall.flashTimer * 0.5f);
-
-            if (wall.isDeadly) {
-                float dangerPulse = (std::sin(globalTime * 10.0f) + 1.0f) * 0.5f; 
-                currentFill = sf::Color(100 + (dangerPulse * 50), 0, 0, 255); 
-                currentOutline = sf::Color::Red;
-            }
-
-            shapeToDraw->setFillColor(currentFill); 
-            shapeToDraw->setOutlineColor(currentOutline);
-            
-            float baseThickness = 0.08f * physics.SCALE; 
-            float thickness = baseThickness + (wall.flashTimer * baseThickness);
-            shapeToDraw->setOutlineThickness(-thickness);
-
-            gameBuffer.draw(*shapeToDraw); 
-
-            // --- RENDERIZADO DE DAÑO Y VIDA ---
-            // --- RENDERIZADO DE DAÑO Y VIDA ---
-            if (wall.isDestructible) {
-                float halfW = wPx / 2.0f;
-                float halfH = hPx / 2.0f;
-
-        // 1. GRIETAS CONTINUAS Y ESPARCIDAS
-        if (wall.currentHits < wall.maxHits) {
-        int damageLevel = wall.maxHits - wall.currentHits;
-        
-        // Si la pared tiene 200 de vida, limitamos las grietas para no tapar todo el color
-        int numCracks = std::min(damageLevel, 200); 
-        
-        std::srand((unsigned int)(reinterpret_cast<std::uintptr_t>(wall.body) & 0xFFFFFFFF));
-        
-        auto drawCrackSegment = [&](float x1, float y1, float x2, float y2) {
-            float dx = x2 - x1;
-            float dy = y2 - y1;
-            float length = std::sqrt(dx*dx + dy*dy);
-            if (length < 0.5f) return; // Filtro para evitar "basuritas"
-            
-            float crackAngle = std::atan2(dy, dx) * 180.0f / 3.14159f;
-            // Grosor fino y constante (unos 2-3 px reales en pantalla)
-            float crackThickness = std::max(4.0f, 0.036f * physics.SCALE); 
-            
-            sf::RectangleShape crackRect(sf::Vector2f(length, crackThickness));
-            crackRect.setOrigin(0.0f, crackThickness / 2.0f);
-            crackRect.setFillColor(sf::Color(10, 10, 10, 220)); 
-
-            sf::Transform t;
-            t.translate(pos.x * physics.SCALE, pos.y * physics.SCALE);
-            t.rotate(wall.body->GetAngle() * 180.0f / 3.14159f);
-
-            crackRect.setPosition(t.transformPoint(x1, y1));
-            crackRect.setRotation((wall.body->GetAngle() * 180.0f / 3.14159f) + crackAngle);
-            
-            gameBuffer.draw(crackRect);
-        };
-
-        for (int k = 0; k < numCracks; k++) {
-            // AHORA SÍ: nacen distribuidas aleatoriamente por TODA la pared
-            float currentX = (std::rand() % (int)wPx) - halfW;
-            float currentY = (std::rand() % (int)hPx) - halfH;
-            
-            // Dirección general hacia donde viaja la grieta
-            float baseAngle = (std::rand() % 360) * 3.14159f / 180.0f;
-            
-            // Hacemos que la grieta avance en 2 a 4 tramos unidos
-            int segments = 2 + (std::rand() % 3); 
-            for (int s = 0; s < segments; s++) {
-                // Zigzag suave (aprox +/- 45 grados de desviación)
-                float angle = baseAngle + ((std::rand() % 100) - 50) * 0.015f; 
-                
-                // MAGIA ACÁ: Usamos el MAX, no el MIN. Así pueden correr a lo largo de las paredes anchas.
-                float maxDim = std::max(wPx, hPx);
-                float segLen = maxDim * (0.05f + (std::rand() % 100) * 0.002f); // Largo de cada tramo
-                
-                float nextX = currentX + std::cos(angle) * segLen;
-                float nextY = currentY + std::sin(angle) * segLen;
-
-                // Clavamos a los bordes exactos para que no asomen fuera de la luz
-                nextX = std::clamp(nextX, -halfW, halfW);
-                nextY = std::clamp(nextY, -halfH, halfH);
-
-                drawCrackSegment(currentX, currentY, nextX, nextY);
-
-                // Avanzamos el punto para enganchar el siguiente tramo
-                currentX = nextX;
-                currentY = nextY;
-            }
-        }
-        std::srand(std::time(nullptr)); 
-    }
-
-    // 2. INDICADORES: TEXTO O LEDS
-    if (wall.useTextForHP) {
-        sf::Text hitText;
-        hitText.setFont(uiFont); 
-        hitText.setString(std::to_string(wall.currentHits));
-        
-        // ESCALA A PRUEBA DE BALAS: Máximo el 60% del lado más chico
-        float minDim = std::min(wPx, hPx);
-        unsigned int calcSize = (unsigned int)(minDim * 0.6f);
-        if (calcSize < 12) calcSize = 12; // Mínimo de seguridad
-        hitText.setCharacterSize(calcSize); 
-        
-        hitText.setFillColor(sf::Color(255, 255, 255, 140)); 
-        
-        sf::FloatRect textRect = hitText.getLocalBounds();
-        hitText.setOrigin(textRect.left + textRect.width / 2.0f, textRect.top + textRect.height / 2.0f);
-        
-        hitText.setPosition(pos.x * physics.SCALE, pos.y * physics.SCALE);
-        
-        // Si es un pilar vertical, rotamos el número para que encaje mejor
-        float extraRotation = (hPx > wPx * 1.5f) ? 90.0f : 0.0f;
-        hitText.setRotation(wall.body->GetAngle() * 180.0f / 3.14159f + extraRotation);
-        
-        gameBuffer.draw(hitText);
-        
-    } else {
-        // --- MODO LEDS PROCEDURALES ---
-        float ledBaseSize = 0.30f * physics.SCALE; 
-        float spacing = 0.12f * physics.SCALE;
-        
-        bool vertical = (wPx < hPx);
-        float mainLength = vertical ? hPx : wPx;
-        
-        float totalWidth = (wall.maxHits * ledBaseSize) + ((wall.maxHits - 1) * spacing);
-        
-        float scaleDown = 1.0f;
-        if (totalWidth > mainLength * 0.85f) {
-            scaleDown = (mainLength * 0.85f) / totalWidth;
-        }
-        
-        float ledSize = ledBaseSize * scaleDown;
-        float currentSpacing = spacing * scaleDown;
-        float adjustedTotalWidth = (wall.maxHits * ledSize) + ((wall.maxHits - 1) * currentSpacing);
-
-        float startX = vertical ? 0.0f : (-adjustedTotalWidth / 2.0f + ledSize / 2.0f);
-        float startY = vertical ? (-adjustedTotalWidth / 2.0f + ledSize / 2.0f) : 0.0f;
-
-        sf::Transform t;
-        t.translate(pos.x * physics.SCALE, pos.y * physics.SCALE);
-        t.rotate(wall.body->GetAngle() * 180.0f / 3.14159f);
-
-        for (int k = 0; k < wall.maxHits; k++) {
-            sf::RectangleShape led(sf::Vector2f(ledSize, ledSize));
-            led.setOrigin(ledSize / 2.0f, ledSize / 2.0f);
-            
-            float lx = vertical ? startX : (startX + k * (ledSize + currentSpacing));
-            float ly = vertical ? (startY + k * (ledSize + currentSpacing)) : startY;
-
-            led.setPosition(t.transformPoint(lx, ly));
-            led.setRotation(wall.body->GetAngle() * 180.0f / 3.14159f);
-
-            if (k < wall.currentHits) {
-                led.setFillColor(sf::Color(100, 255, 100, 220)); 
-            } else {
-                led.setFillColor(sf::Color(255, 50, 50, 100)); 
-            }
-            gameBuffer.draw(led);
-        }
-    }
-}
-
-        // --- DIBUJO DE CUCHILLOS ---
-        for (const auto& knife : physics.getKnives()) {
-            
-            sf::Vector2f drawPos;
-            float drawRot;
-            float kScale = 1.5f * physics.SCALE; // Tamaño visual base (1 metro en el juego)
-
-            if (!knife.isPickedUp) {
-                // Si está tirado, está en su posición. 
-                // Rotación en 0 (no da vueltas solo) a menos que vos se la setees.
-                drawPos = sf::Vector2f(knife.body->GetPosition().x * physics.SCALE, knife.body->GetPosition().y * physics.SCALE);
-                drawRot = knife.body->GetAngle() * 180.0f / 3.14159f; 
-            } else {
-                // Si alguien lo tiene, lo pegamos al costado/frente del racer
-                int oIdx = knife.ownerIndex;
-                if (oIdx >= 0 && oIdx < bodies.size()) {
-                    b2Body* ownerBody = bodies[oIdx];
-                    b2Vec2 oPos = ownerBody->GetPosition();
-                    float oAngle = ownerBody->GetAngle();
-
-                    // Offset matemático para que parezca que lo lleva en la "mano"
-                    float rSize = physics.currentRacerSize / 2.0f; 
-                    b2Vec2 offset(cos(oAngle) * (rSize + 0.3f), sin(oAngle) * (rSize + 0.3f));
-                    
-                    drawPos = sf::Vector2f((oPos.x + offset.x) * physics.SCALE, (oPos.y + offset.y) * physics.SCALE);
-                    drawRot = oAngle * 180.0f / 3.14159f; // Apunta a donde va el racer
-                } else {
-                    continue; // Por seguridad
-                }
-            }
-
-            // DIBUJO: Asset vs Fallback
-            if (hasKnifeTex) {
-                sf::Sprite s(knifeTex);
-                // Ponemos el origen en el centro del 499x499
-                s.setOrigin(knifeTex.getSize().x / 2.0f, knifeTex.getSize().y / 2.0f);
-                
-                // Escala mágica: Si la imagen es de 499px, queremos que mida kScale (ej: 30px)
-                float scaleFactor = kScale / knifeTex.getSize().x;
-                s.setScale(-scaleFactor, scaleFactor);
-                
-                s.setPosition(drawPos);
-                s.setRotation(drawRot);
-                gameBuffer.draw(s);
-            } else {
-                // Fallback: Tu hoja roja
-                sf::ConvexShape tri;
-                tri.setPointCount(3);
-                float triSize = kScale * 0.6f; 
-                tri.setPoint(0, sf::Vector2f(0.0f, -triSize));
-                tri.setPoint(1, sf::Vector2f(triSize/2.0f, triSize/2.0f));
-                tri.setPoint(2, sf::Vector2f(-triSize/2.0f, triSize/2.0f));
-                
-                tri.setPosition(drawPos);
-                // Le sumamos 90 grados para que la punta del triángulo mire hacia donde viaja
-                tri.setRotation(drawRot + 90.0f); 
-                tri.setFillColor(sf::Color(220, 220, 220));
-                tri.setOutlineColor(sf::Color::Red);
-                tri.setOutlineThickness(2.0f);
-                
-                gameBuffer.draw(tri);
-            }
-        }
-
-            b2Body* zone = physics.getWinZoneBody();
-            if (zone) {
-                b2Vec2 pos = zone->GetPosition();
-                sf::RectangleShape zoneRect;
-                float w = physics.winZoneSize[0] * physics.SCALE;
-                float h = physics.winZoneSize[1] * physics.SCALE;
-                
-                // --- NUEVA LÓGICA DE GLOW GUARDABLE ---
-                float alpha = 100.0f; // Alpha estático por defecto
-                if (physics.winZoneGlow) {
-                    float pulse = (std::sin(globalTime * 1.5f) + 1.0f) * 0.5f; 
-                    alpha = 50.0f + pulse * 100.0f; // Pulso activo
-                }
-                
-                zoneRect.setSize(sf::Vector2f(w, h));
-                zoneRect.setOrigin(w/2.0f, h/2.0f);
-                zoneRect.setPosition(pos.x * physics.SCALE, pos.y * physics.SCALE);
-                zoneRect.setFillColor(sf::Color(255, 215, 0, (sf::Uint8)alpha)); 
-                zoneRect.setOutlineColor(sf::Color::Yellow);
-                zoneRect.setOutlineThickness(0.1f * physics.SCALE); 
-                gameBuffer.draw(zoneRect);
-            }
-        }
-
-        const auto& statuses = physics.getRacerStatus();
-        float tombSize = 0.8f * physics.SCALE;  // 1.0 metros en escala visual
-        float crossThick = 0.15f * physics.SCALE; // Grosor de la cruz
-        float outlineThick = 0.08f * physics.SCALE;
-
-        for (size_t i = 0; i < statuses.size(); ++i) {
-            const auto& status = statuses[i];
-
-            if (!status.isAlive) {
-                float px = status.deathPos.x * physics.SCALE;
-                float py = status.deathPos.y * physics.SCALE;
-
-                sf::Color deathColor = (i < 4) ? racerColors[i] : sf::Color::White;
-
-                sf::RectangleShape grave;
-                grave.setSize(sf::Vector2f(tombSize, tombSize));
-                grave.setOrigin(tombSize / 2.0f, tombSize / 2.0f);
-                grave.setPosition(px, py);
-                grave.setFillColor(sf::Color(20, 20, 20, 240)); 
-                grave.setOutlineColor(deathColor);              
-                grave.setOutlineThickness(outlineThick);
-                gameBuffer.draw(grave); 
-
-            
-                float crossLen = tombSize * 0.8f;      
-
-                sf::RectangleShape bar1(sf::Vector2f(crossLen, crossThick));
-                sf::RectangleShape bar2(sf::Vector2f(crossLen, crossThick));
-
-                bar1.setOrigin(crossLen / 2.0f, crossThick / 2.0f);
-                bar2.setOrigin(crossLen / 2.0f, crossThick / 2.0f);
-
-                bar1.setPosition(px, py);
-                bar2.setPosition(px, py);
-
-                bar1.setRotation(45.0f);
-                bar2.setRotation(-45.0f);
-
-                bar1.setFillColor(deathColor); 
-                bar2.setFillColor(deathColor);
-
-                gameBuffer.draw(bar1); 
-                gameBuffer.draw(bar2);
-            }
-        }
-
-        for (size_t i = 0; i < trails.size(); ++i) {
-            const auto& pts = trails[i].points;
-            if (pts.size() < 2) continue; 
-
-            // Usamos Quads en lugar de TriangleStrip para evitar "tajos" en curvas cerradas
-            sf::VertexArray glowVA(sf::Quads);
-            sf::VertexArray coreVA(sf::Quads);
-            
-            // Ancho constante, clavado al tamaño del racer
-            float baseWidth = physics.currentRacerSize * physics.SCALE; 
-
-for (size_t j = 1; j < pts.size(); ++j) {
-                sf::Vector2f p1 = pts[j-1];
-                sf::Vector2f p2 = pts[j];
-
-                sf::Vector2f dir = p2 - p1;
-                float len = std::sqrt(dir.x*dir.x + dir.y*dir.y);
-                if (len < 0.001f) continue;
-
-                sf::Vector2f normal(-dir.y/len, dir.x/len);
-
-                // Cálculo de vida (0.0 a 1.0) para ir apagando la luz
-                float lifePct1 = 1.0f - ((float)(j-1) / (float)pts.size());
-                float lifePct2 = 1.0f - ((float)j / (float)pts.size());
-
-                // Anchos afinándose hacia la punta
-                float widthPct1 = std::pow(lifePct1, 0.6f);
-                float widthPct2 = std::pow(lifePct2, 0.6f);
-
-                sf::Color baseColor = trails[i].color;
-
-                // --- MAGIA TERMODINÁMICA ---
-                // Lambda para calcular el color según la "edad" de la estela
-                auto getThermoColor = [&](float life, float alphaMult) -> sf::Color {
-                    sf::Color c;
-                    if (life >= 0.8f) { 
-                        // 0% a 20% de edad: Blanco incandescente (apenas apagado para no quemar)
-                        c = sf::Color(245, 245, 245);
-                    } else if (life >= 0.3f) { 
-                        // 20% a 70% de edad: Transición Blanco -> Color Base
-                        float t = (life - 0.3f) / 0.5f; 
-                        c = lerpColor(baseColor, sf::Color(245, 245, 245), t);
-                    } else { 
-                        // 70% a 100% de edad: Transición Color Base -> Transparente
-                        float t = life / 0.3f; 
-                        sf::Color transparent(0, 0, 0, 0); 
-                        c = lerpColor(transparent, baseColor, t);
-                    }
-                    
-                    // Ajustamos la opacidad para controlar el brillo en el BlendAdd
-                    c.a = (sf::Uint8)(c.a * alphaMult);
-                    return c;
-                };
-
-                // Aplicamos la termodinámica con un poquito menos de nafta
-                // Core: 0.85f (antes 1.0), Glow: 0.35f (antes 0.45)
-                sf::Color coreColor1 = getThermoColor(lifePct1, 0.85f);
-                sf::Color coreColor2 = getThermoColor(lifePct2, 0.85f);
-                
-                sf::Color glowColor1 = getThermoColor(lifePct1, 0.35f);
-                sf::Color glowColor2 = getThermoColor(lifePct2, 0.35f);
-
-                // Calculamos los anchos dinámicos (que terminen en punta)
-                float coreW1 = (baseWidth * 0.3f) * widthPct1;
-                float coreW2 = (baseWidth * 0.3f) * widthPct2;
-                
-                float glowWidth = baseWidth * 1.6f;
-                float glowW1 = (glowWidth * 0.4f) * widthPct1;
-                float glowW2 = (glowWidth * 0.4f) * widthPct2;
-
-                // SOLAPAMIENTO SUTIL (Overlap)
-                sf::Vector2f overlap = (dir / len) * (baseWidth * 0.08f);
-                sf::Vector2f p1_ext = p1 - overlap;
-                sf::Vector2f p2_ext = p2 + overlap;
-
-                // Vértices del Core (Afinándose hacia atrás)
-                coreVA.append(sf::Vertex(p1_ext + normal * coreW1, coreColor1));
-                coreVA.append(sf::Vertex(p1_ext - normal * coreW1, coreColor1));
-                coreVA.append(sf::Vertex(p2_ext - normal * coreW2, coreColor2));
-                coreVA.append(sf::Vertex(p2_ext + normal * coreW2, coreColor2));
-
-                // Vértices del Glow (Afinándose hacia atrás)
-                glowVA.append(sf::Vertex(p1_ext + normal * glowW1, glowColor1));
-                glowVA.append(sf::Vertex(p1_ext - normal * glowW1, glowColor1));
-                glowVA.append(sf::Vertex(p2_ext - normal * glowW2, glowColor2));
-                glowVA.append(sf::Vertex(p2_ext + normal * glowW2, glowColor2));
-            }
-
-            // MAGIA ACÁ: Fusión Aditiva (BlendAdd). 
-            // En vez de tapar lo que hay abajo, suma luz. El shader de Bloom se hace un festín.
-            sf::RenderStates states;
-            states.blendMode = sf::BlendAdd;
-            
-            gameBuffer.draw(glowVA, states);
-            gameBuffer.draw(coreVA, states);
-        }
-
-        const auto& currentStatuses = physics.getRacerStatus(); 
-
-        for (size_t i = 0; i < bodies.size(); ++i) {
-            if (i < currentStatuses.size() && !currentStatuses[i].isAlive) continue;
-            b2Body* body = bodies[i];
-            b2Vec2 pos = body->GetPosition();
-            float angle = body->GetAngle();
-            float drawSize = physics.currentRacerSize * physics.SCALE;
-            sf::RectangleShape rect;
-            rect.setSize(sf::Vector2f(drawSize, drawSize));
-            rect.setOrigin(drawSize / 2.0f, drawSize / 2.0f);
-            rect.setPosition(pos.x * physics.SCALE, pos.y * physics.SCALE);
-            rect.setRotation(angle * 180.0f / 3.14159f);
-            if (i < 4) rect.setOutlineColor(racerColors[i]);
-            else rect.setOutlineColor(sf::Color::White);
-            rect.setFillColor(sf::Color::White);
-            rect.setOutlineThickness(-0.1f * physics.SCALE);
-            gameBuffer.draw(rect); 
-        }
-
-        // --- DRAW PARTÍCULAS ---
-        const auto& particles = physics.getParticles();
-        if (!particles.empty()) {
-            // Usamos Quads, necesitamos 4 vértices por partícula
-            sf::VertexArray va(sf::Quads, particles.size() * 4);
-            
-            // Tamaño de la partícula escalado a la resolución bruta (2160p)
-            float pSize = (RENDER_WIDTH / 1080.0f) * 4.0f; 
-            
-            for (size_t i = 0; i < particles.size(); ++i) {
-                const auto& p = particles[i];
-                sf::Color c = p.color;
-                
-                // Hacemos que se desvanezcan en el canal Alpha según su vida
-                c.a = (sf::Uint8)(255.0f * (p.life / p.maxLife));
-                
-                // Construimos el cuadradito
-                va[i*4 + 0].position = p.position + sf::Vector2f(-pSize, -pSize);
-                va[i*4 + 1].position = p.position + sf::Vector2f(pSize, -pSize);
-                va[i*4 + 2].position = p.position + sf::Vector2f(pSize, pSize);
-                va[i*4 + 3].position = p.position + sf::Vector2f(-pSize, pSize);
-                
-                va[i*4 + 0].color = c;
-                va[i*4 + 1].color = c;
-                va[i*4 + 2].color = c;
-                va[i*4 + 3].color = c;
-            }
-            gameBuffer.draw(va);
-        }
-
-        gameBuffer.display();
-
-        // 1. Declaramos el sprite acá arriba para que exista en todo este bloque
-        sf::Sprite renderSprite;
-
-        if (enableBloom) {
-            // 1. EXTRAER BRILLO 
-            brightnessShader.setUniform("source", sf::Shader::CurrentTexture);
-            brightnessShader.setUniform("threshold", bloomThreshold);
-            brightnessBuffer.clear(sf::Color::Black);
-            sf::Sprite brightSprite(gameBuffer.getTexture());
-            brightSprite.setScale(0.5f, 0.5f); 
-            brightnessBuffer.draw(brightSprite, &brightnessShader);
-            brightnessBuffer.display();
-
-            // 2. DESENFOQUE GAUSSIANO 
-            // FIX: Puntero a constante porque getTexture() devuelve const
-            const sf::Texture* currentSource = &brightnessBuffer.getTexture();
-            
-            for (int i = 0; i < blurIterations; ++i) {
-                // Pasada Horizontal
-                blurShader.setUniform("source", sf::Shader::CurrentTexture);
-                blurShader.setUniform("dir", sf::Vector2f(1.0f / BLOOM_W, 0.0f));
-                blurBuffer1.clear(sf::Color::Transparent);
-                blurBuffer1.draw(sf::Sprite(*currentSource), &blurShader);
-                blurBuffer1.display();
-
-                // Pasada Vertical
-                blurShader.setUniform("source", sf::Shader::CurrentTexture);
-                blurShader.setUniform("dir", sf::Vector2f(0.0f, 1.0f / BLOOM_H));
-                blurBuffer2.clear(sf::Color::Transparent);
-                blurBuffer2.draw(sf::Sprite(blurBuffer1.getTexture()), &blurShader);
-                blurBuffer2.display();
-                
-                // FIX: La reasignación ahora funciona perfecto porque el puntero es const
-                currentSource = &blurBuffer2.getTexture();
-            }
-
-            // 3. FUSIÓN ADITIVA 
-            blendShader.setUniform("baseTexture", sf::Shader::CurrentTexture);
-            blendShader.setUniform("bloomTexture", *currentSource);
-            blendShader.setUniform("multiplier", bloomMultiplier);
-            
-            finalBuffer.clear();
-            sf::Sprite finalBaseSprite(gameBuffer.getTexture());
-            finalBuffer.draw(finalBaseSprite, &blendShader);
-            finalBuffer.display();
-
-            recorder.addFrame(finalBuffer.getTexture());
-            renderSprite.setTexture(finalBuffer.getTexture()); // Asignamos textura
-        } else {
-            recorder.addFrame(gameBuffer.getTexture());
-            renderSprite.setTexture(gameBuffer.getTexture()); // Asignamos textura
-        }
+        scene.setRenderScale((recorder.isRecording || fullResPreview) ? 1.0f : PREVIEW_SCALE);
+        const sf::Texture& frame = scene.render(physics, globalTime);
+        recorder.addFrame(frame);
+        sf::Sprite renderSprite(frame);
 
         window.clear(sf::Color(20, 20, 20)); 
 
         // 2. Ahora el resto del código que ya tenías para centrar el viewport
         // se aplica sobre el renderSprite que ya tiene su textura correcta.
-        float scale = DISPLAY_SIZE / (float)RENDER_WIDTH; 
+        float scale = DISPLAY_SIZE / (float)frame.getSize().x; 
         renderSprite.setScale(scale, scale);
         
         float offsetX = (desktopMode.width - DISPLAY_SIZE) / 2.0f;
@@ -1334,6 +969,7 @@ for (size_t j = 1; j < pts.size(); ++j) {
 
         ImGui::SFML::Render(window);
         window.display();
+        profiler.endFrame();
     }
 
     ImGui::SFML::Shutdown();